@@ -0,0 +1,2575 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+// A mock Level Zero driver for testing without a GPU.  It is loaded by the
+// Level Zero loader like any other driver, for example:
+//
+//   ZE_ENABLE_ALT_DRIVERS=/path/to/libze_mock.so ./lzinfo
+//
+// Devices, queues, events and memory are emulated on the host.  Memory
+// copies and fills really happen, but kernels do not execute: they only
+// occupy their engine for a modeled duration.  See Config for the latency
+// model and the environment variables that control it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#include "ze_api.h"
+#include "ze_ddi.h"
+
+#include "mock_driver.h"
+
+namespace mock {
+
+static uint64_t getEnvironment(
+    const char* name,
+    uint64_t defaultValue )
+{
+    const char* value = getenv(name);
+    return value ? strtoull(value, nullptr, 0) : defaultValue;
+}
+
+static double getEnvironment(
+    const char* name,
+    double defaultValue )
+{
+    const char* value = getenv(name);
+    return value ? strtod(value, nullptr) : defaultValue;
+}
+
+Config Config::fromEnvironment()
+{
+    Config config;
+    config.devices = (uint32_t)getEnvironment("LZ_MOCK_DEVICES", (uint64_t)config.devices);
+    config.computeEngines = (uint32_t)getEnvironment("LZ_MOCK_COMPUTE_ENGINES", (uint64_t)config.computeEngines);
+    config.copyEngines = (uint32_t)getEnvironment("LZ_MOCK_COPY_ENGINES", (uint64_t)config.copyEngines);
+    config.launchNs = getEnvironment("LZ_MOCK_LAUNCH_NS", config.launchNs);
+    config.kernelNs = getEnvironment("LZ_MOCK_KERNEL_NS", config.kernelNs);
+    config.groupNs = getEnvironment("LZ_MOCK_GROUP_NS", config.groupNs);
+    config.copyNs = getEnvironment("LZ_MOCK_COPY_NS", config.copyNs);
+    config.copyGBps = getEnvironment("LZ_MOCK_COPY_GBPS", config.copyGBps);
+    config.memoryBytes = getEnvironment("LZ_MOCK_MEMORY_MB", config.memoryBytes >> 20) << 20;
+
+    config.devices = std::max(config.devices, 1u);
+    config.computeEngines = std::max(config.computeEngines, 1u);
+    if (config.copyGBps <= 0.0) {
+        config.copyGBps = Config().copyGBps;
+    }
+    return config;
+}
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void waitUntil(
+    uint64_t deadline )
+{
+    for (;;) {
+        uint64_t current = now();
+        if (current >= deadline) {
+            break;
+        }
+        uint64_t remaining = deadline - current;
+        if (remaining > 200000) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - 100000));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Waits on a condition variable with a Level Zero timeout, where very large
+// timeouts such as UINT64_MAX mean "wait forever".
+template <typename Predicate>
+static bool waitFor(
+    std::condition_variable& cv,
+    std::unique_lock<std::mutex>& lock,
+    uint64_t timeoutNs,
+    Predicate predicate )
+{
+    if (timeoutNs >= (UINT64_MAX >> 2)) {
+        cv.wait(lock, predicate);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::nanoseconds(timeoutNs), predicate);
+}
+
+void Signal::set()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        signaled_ = true;
+    }
+    cv_.notify_all();
+}
+
+void Signal::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    signaled_ = false;
+}
+
+bool Signal::query()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return signaled_;
+}
+
+bool Signal::wait(
+    uint64_t timeoutNs )
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return waitFor(cv_, lock, timeoutNs, [&]{ return signaled_; });
+}
+
+ze_kernel_timestamp_result_t Event::getTimestamp()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timestamp;
+}
+
+void Event::complete(
+    uint64_t startTicks,
+    uint64_t endTicks )
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool->timestamps) {
+            // Kernel timestamps have 32 valid bits, like many real devices.
+            timestamp.global.kernelStart = startTicks & 0xFFFFFFFF;
+            timestamp.global.kernelEnd = endTicks & 0xFFFFFFFF;
+            timestamp.context = timestamp.global;
+        }
+        signaled_ = true;
+    }
+    cv_.notify_all();
+}
+
+Engine::Engine(
+    Device* device ) :
+    device_(device),
+    thread_(&Engine::run, this) {}
+
+Engine::~Engine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+uint64_t Engine::submit(
+    std::vector<Command> commands,
+    Fence* fence )
+{
+    Batch batch;
+    batch.commands = std::move(commands);
+    batch.fence = fence;
+    batch.readyNs = now() + device_->driver->config.launchNs;
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = batch.id = ++submitted_;
+        queue_.push_back(std::move(batch));
+    }
+    cv_.notify_all();
+    return id;
+}
+
+bool Engine::synchronize(
+    uint64_t id,
+    uint64_t timeoutNs )
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return waitFor(cv_, lock, timeoutNs, [&]{ return completed_ >= id; });
+}
+
+bool Engine::waitForEvent(
+    Event* event )
+{
+    // Wait in slices so that destroying the engine does not hang on an
+    // event that will never be signaled.
+    while (!event->wait(1000000)) {
+        if (stop_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Engine::run()
+{
+    const Driver* driver = device_->driver;
+    for (;;) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]{ return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        uint64_t readyNs = batch.readyNs;
+        for (auto& command : batch.commands) {
+            for (auto event : command.waits) {
+                if (!waitForEvent(event)) {
+                    return;
+                }
+            }
+
+            uint64_t startNs = std::max(now(), readyNs);
+            waitUntil(startNs);
+            if (command.work) {
+                command.work();
+            }
+            uint64_t endNs = startNs + command.modeledNs;
+            waitUntil(endNs);
+            readyNs = endNs;
+
+            if (command.signal) {
+                command.signal->complete(driver->ticks(startNs), driver->ticks(endNs));
+            }
+        }
+
+        if (batch.fence) {
+            batch.fence->set();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_ = batch.id;
+        }
+        cv_.notify_all();
+    }
+}
+
+std::shared_ptr<Engine> Device::getEngine(
+    uint32_t ordinal,
+    uint32_t index )
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& weak = engines_[std::make_pair(ordinal, index)];
+    auto engine = weak.lock();
+    if (!engine) {
+        engine = std::make_shared<Engine>(this);
+        weak = engine;
+    }
+    return engine;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+static Driver& getDriver()
+{
+    static Driver driver;
+    return driver;
+}
+
+static std::once_flag initOnce;
+static std::atomic<bool> initialized{false};
+
+static void initialize()
+{
+    Driver& driver = getDriver();
+    driver.config = Config::fromEnvironment();
+    driver.epochNs = now();
+
+    for (uint32_t i = 0; i < driver.config.devices; i++) {
+        std::unique_ptr<Device> device(new Device());
+        device->driver = &driver;
+        device->index = i;
+        device->queueGroups.push_back(QueueGroup{
+            ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE | ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY,
+            driver.config.computeEngines });
+        if (driver.config.copyEngines) {
+            device->queueGroups.push_back(QueueGroup{
+                ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY,
+                driver.config.copyEngines });
+        }
+        driver.devices.push_back(std::move(device));
+    }
+
+    initialized = true;
+}
+
+template <typename T, typename H>
+static T* toObject(
+    H handle )
+{
+    return reinterpret_cast<T*>(handle);
+}
+
+template <typename H, typename T>
+static H toHandle(
+    T* object )
+{
+    return reinterpret_cast<H>(object);
+}
+
+// Implements the two-call idiom for counted queries: returns the number of
+// outputs the caller asked for, or zero if it only asked for the count.
+static uint32_t countOutputs(
+    uint32_t* pCount,
+    bool hasOutputs,
+    uint32_t available )
+{
+    if (*pCount == 0 || !hasOutputs) {
+        *pCount = available;
+        return 0;
+    }
+    *pCount = std::min(*pCount, available);
+    return *pCount;
+}
+
+// Clears an output structure, keeping its stype and pNext.
+template <typename T>
+static void clearOutput(
+    T* p )
+{
+    auto stype = p->stype;
+    auto pNext = p->pNext;
+    *p = T{};
+    p->stype = stype;
+    p->pNext = pNext;
+}
+
+static uint64_t copyDuration(
+    const Config& config,
+    size_t bytes )
+{
+    return config.copyNs + (uint64_t)(bytes / config.copyGBps);
+}
+
+static void copy3D(
+    uint8_t* dst,
+    size_t dstPitch,
+    size_t dstSlicePitch,
+    const uint8_t* src,
+    size_t srcPitch,
+    size_t srcSlicePitch,
+    size_t rowBytes,
+    uint32_t rows,
+    uint32_t slices )
+{
+    for (uint32_t z = 0; z < slices; z++) {
+        for (uint32_t y = 0; y < rows; y++) {
+            memcpy(
+                dst + z * dstSlicePitch + y * dstPitch,
+                src + z * srcSlicePitch + y * srcPitch,
+                rowBytes);
+        }
+    }
+}
+
+static void* alignedAlloc(
+    size_t size,
+    size_t alignment )
+{
+#if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+static void alignedFree(
+    void* ptr )
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// Returns the allocation containing ptr, or nullptr.  The driver mutex must
+// be held.
+static const Allocation* findAllocation(
+    Driver* driver,
+    const void* ptr,
+    uintptr_t* base )
+{
+    auto it = driver->allocations.upper_bound((uintptr_t)ptr);
+    if (it == driver->allocations.begin()) {
+        return nullptr;
+    }
+    --it;
+    if ((uintptr_t)ptr >= it->first + it->second.size) {
+        return nullptr;
+    }
+    *base = it->first;
+    return &it->second;
+}
+
+static ze_result_t allocate(
+    ze_context_handle_t hContext,
+    size_t size,
+    size_t alignment,
+    ze_memory_type_t type,
+    ze_device_handle_t hDevice,
+    void** pptr )
+{
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (size == 0) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_SIZE;
+    }
+    if (alignment & (alignment - 1)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_ALIGNMENT;
+    }
+
+    Driver* driver = toObject<Context>(hContext)->driver;
+    Device* device = toObject<Device>(hDevice);
+
+    std::lock_guard<std::mutex> lock(driver->mutex);
+    if (device && device->memoryUsed + size > driver->config.memoryBytes) {
+        return ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    void* ptr = alignedAlloc(size, std::max<size_t>(alignment, 64));
+    if (ptr == nullptr) {
+        return ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    if (device) {
+        device->memoryUsed += size;
+    }
+    driver->allocations[(uintptr_t)ptr] = Allocation{ size, type, device, driver->nextAllocationId++ };
+    *pptr = ptr;
+    return ZE_RESULT_SUCCESS;
+}
+
+// Records a command in a command list, or submits it to the engine if the
+// command list is immediate.
+static ze_result_t append(
+    ze_command_list_handle_t hCommandList,
+    Command command,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (numWaitEvents && phWaitEvents == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_SIZE;
+    }
+
+    auto list = toObject<CommandList>(hCommandList);
+    for (uint32_t i = 0; i < numWaitEvents; i++) {
+        command.waits.push_back(toObject<Event>(phWaitEvents[i]));
+    }
+    command.signal = toObject<Event>(hSignalEvent);
+
+    if (list->engine) {
+        std::vector<Command> commands;
+        commands.push_back(std::move(command));
+        list->lastSubmitted = list->engine->submit(std::move(commands), nullptr);
+        if (list->synchronous) {
+            list->engine->synchronize(list->lastSubmitted, UINT64_MAX);
+        }
+    } else {
+        list->commands.push_back(std::move(command));
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static uint32_t getBytesPerPixel(
+    ze_image_format_layout_t layout )
+{
+    switch (layout) {
+    case ZE_IMAGE_FORMAT_LAYOUT_8:
+        return 1;
+    case ZE_IMAGE_FORMAT_LAYOUT_16:
+    case ZE_IMAGE_FORMAT_LAYOUT_8_8:
+    case ZE_IMAGE_FORMAT_LAYOUT_5_6_5:
+    case ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1:
+    case ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4:
+        return 2;
+    case ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16:
+    case ZE_IMAGE_FORMAT_LAYOUT_32_32:
+        return 8;
+    case ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+static ze_image_region_t getImageRegion(
+    const Image* image,
+    const ze_image_region_t* pRegion )
+{
+    if (pRegion) {
+        return *pRegion;
+    }
+    ze_image_region_t region = {};
+    region.width = image->width;
+    region.height = image->height;
+    region.depth = image->depth;
+    return region;
+}
+
+static uint8_t* getImagePointer(
+    Image* image,
+    const ze_image_region_t& region )
+{
+    size_t pitch = (size_t)image->width * image->bytesPerPixel;
+    size_t slicePitch = pitch * image->height;
+    return image->data.data() +
+        region.originZ * slicePitch +
+        region.originY * pitch +
+        region.originX * image->bytesPerPixel;
+}
+
+// Entry-point names from the OpEntryPoint instructions of a SPIR-V module.
+static std::vector<std::string> getEntryPoints(
+    const uint8_t* data,
+    size_t size )
+{
+    std::vector<std::string> names;
+    if (data == nullptr || size < 20 || size % 4) {
+        return names;
+    }
+
+    std::vector<uint32_t> words(size / 4);
+    memcpy(words.data(), data, size);
+    if (words[0] != 0x07230203) {
+        return names;
+    }
+
+    for (size_t i = 5; i < words.size(); ) {
+        uint32_t wordCount = words[i] >> 16;
+        uint32_t opcode = words[i] & 0xFFFF;
+        if (wordCount == 0 || i + wordCount > words.size()) {
+            break;
+        }
+        if (opcode == 15 && wordCount > 3) {    // OpEntryPoint
+            const char* name = reinterpret_cast<const char*>(&words[i + 3]);
+            names.emplace_back(name, strnlen(name, (wordCount - 3) * 4));
+        }
+        i += wordCount;
+    }
+    return names;
+}
+
+static uint32_t largestDivisor(
+    uint32_t n,
+    uint32_t limit )
+{
+    for (uint32_t d = std::min(n, limit); d > 1; d--) {
+        if (n % d == 0) {
+            return d;
+        }
+    }
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Global and driver
+
+static ze_result_t ZE_APICALL zeInit(
+    ze_init_flags_t flags )
+{
+    if (flags != 0 && (flags & ZE_INIT_FLAG_GPU_ONLY) == 0) {
+        return ZE_RESULT_ERROR_UNINITIALIZED;
+    }
+    std::call_once(initOnce, initialize);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDriverGet(
+    uint32_t* pCount,
+    ze_driver_handle_t* phDrivers )
+{
+    if (!initialized) {
+        return ZE_RESULT_ERROR_UNINITIALIZED;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (countOutputs(pCount, phDrivers != nullptr, 1)) {
+        phDrivers[0] = toHandle<ze_driver_handle_t>(&getDriver());
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+#if defined(ZE_API_VERSION_CURRENT_M) && ZE_API_VERSION_CURRENT_M >= ZE_MAKE_VERSION( 1, 10 )
+static ze_result_t ZE_APICALL zeInitDrivers(
+    uint32_t* pCount,
+    ze_driver_handle_t* phDrivers,
+    ze_init_driver_type_desc_t* desc )
+{
+    if (pCount == nullptr || desc == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if ((desc->flags & ZE_INIT_DRIVER_TYPE_FLAG_GPU) == 0) {
+        *pCount = 0;
+        return ZE_RESULT_SUCCESS;
+    }
+    std::call_once(initOnce, initialize);
+    return mock::zeDriverGet(pCount, phDrivers);
+}
+#endif
+
+static ze_result_t ZE_APICALL zeDriverGetApiVersion(
+    ze_driver_handle_t hDriver,
+    ze_api_version_t* version )
+{
+    if (hDriver == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (version == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    *version = ZE_API_VERSION_CURRENT;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDriverGetProperties(
+    ze_driver_handle_t hDriver,
+    ze_driver_properties_t* pDriverProperties )
+{
+    if (hDriver == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pDriverProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pDriverProperties);
+    memcpy(pDriverProperties->uuid.id, "lzmockdriver", 12);
+    pDriverProperties->driverVersion = 1;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDriverGetExtensionProperties(
+    ze_driver_handle_t hDriver,
+    uint32_t* pCount,
+    ze_driver_extension_properties_t* pExtensionProperties )
+{
+    (void)pExtensionProperties;
+    if (hDriver == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    *pCount = 0;
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Device
+
+static ze_result_t ZE_APICALL zeDeviceGet(
+    ze_driver_handle_t hDriver,
+    uint32_t* pCount,
+    ze_device_handle_t* phDevices )
+{
+    if (hDriver == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto driver = toObject<Driver>(hDriver);
+    uint32_t count = countOutputs(pCount, phDevices != nullptr, (uint32_t)driver->devices.size());
+    for (uint32_t i = 0; i < count; i++) {
+        phDevices[i] = toHandle<ze_device_handle_t>(driver->devices[i].get());
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetSubDevices(
+    ze_device_handle_t hDevice,
+    uint32_t* pCount,
+    ze_device_handle_t* phSubdevices )
+{
+    (void)phSubdevices;
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    *pCount = 0;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetProperties(
+    ze_device_handle_t hDevice,
+    ze_device_properties_t* pDeviceProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pDeviceProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    clearOutput(pDeviceProperties);
+    pDeviceProperties->type = ZE_DEVICE_TYPE_GPU;
+    pDeviceProperties->vendorId = 0xFFFF;
+    pDeviceProperties->deviceId = device->index;
+    pDeviceProperties->coreClockRate = 1000;
+    pDeviceProperties->maxMemAllocSize = device->driver->config.memoryBytes;
+    pDeviceProperties->maxHardwareContexts = 64;
+    pDeviceProperties->numThreadsPerEU = 8;
+    pDeviceProperties->physicalEUSimdWidth = 8;
+    pDeviceProperties->numEUsPerSubslice = 8;
+    pDeviceProperties->numSubslicesPerSlice = 4;
+    pDeviceProperties->numSlices = 1;
+    // Device ticks are nanoseconds: the base structure reports the period in
+    // nanoseconds, the 1.2 structure the frequency in cycles per second.
+    pDeviceProperties->timerResolution =
+        pDeviceProperties->stype == ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES_1_2 ? 1000000000 : 1;
+    pDeviceProperties->timestampValidBits = 64;
+    pDeviceProperties->kernelTimestampValidBits = 32;
+    memcpy(pDeviceProperties->uuid.id, "lzmockdevice", 12);
+    pDeviceProperties->uuid.id[ZE_MAX_DEVICE_UUID_SIZE - 1] = (uint8_t)device->index;
+    snprintf(pDeviceProperties->name, ZE_MAX_DEVICE_NAME, "Mock Device %u", device->index);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetComputeProperties(
+    ze_device_handle_t hDevice,
+    ze_device_compute_properties_t* pComputeProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pComputeProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pComputeProperties);
+    pComputeProperties->maxTotalGroupSize = 1024;
+    pComputeProperties->maxGroupSizeX = 1024;
+    pComputeProperties->maxGroupSizeY = 1024;
+    pComputeProperties->maxGroupSizeZ = 1024;
+    pComputeProperties->maxGroupCountX = 0xFFFFFFFF;
+    pComputeProperties->maxGroupCountY = 0xFFFFFFFF;
+    pComputeProperties->maxGroupCountZ = 0xFFFFFFFF;
+    pComputeProperties->maxSharedLocalMemory = 64 * 1024;
+    pComputeProperties->numSubGroupSizes = 3;
+    pComputeProperties->subGroupSizes[0] = 8;
+    pComputeProperties->subGroupSizes[1] = 16;
+    pComputeProperties->subGroupSizes[2] = 32;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetModuleProperties(
+    ze_device_handle_t hDevice,
+    ze_device_module_properties_t* pModuleProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pModuleProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pModuleProperties);
+    pModuleProperties->spirvVersionSupported = ZE_MAKE_VERSION( 1, 2 );
+    pModuleProperties->fp32flags =
+        ZE_DEVICE_FP_FLAG_DENORM |
+        ZE_DEVICE_FP_FLAG_INF_NAN |
+        ZE_DEVICE_FP_FLAG_ROUND_TO_NEAREST |
+        ZE_DEVICE_FP_FLAG_FMA;
+    pModuleProperties->maxArgumentsSize = 2048;
+    pModuleProperties->printfBufferSize = 4 * 1024 * 1024;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetCommandQueueGroupProperties(
+    ze_device_handle_t hDevice,
+    uint32_t* pCount,
+    ze_command_queue_group_properties_t* pCommandQueueGroupProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    uint32_t count = countOutputs(pCount, pCommandQueueGroupProperties != nullptr, (uint32_t)device->queueGroups.size());
+    for (uint32_t i = 0; i < count; i++) {
+        auto props = &pCommandQueueGroupProperties[i];
+        clearOutput(props);
+        props->flags = device->queueGroups[i].flags;
+        props->maxMemoryFillPatternSize = 128;
+        props->numQueues = device->queueGroups[i].numQueues;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetMemoryProperties(
+    ze_device_handle_t hDevice,
+    uint32_t* pCount,
+    ze_device_memory_properties_t* pMemProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    if (countOutputs(pCount, pMemProperties != nullptr, 1)) {
+        clearOutput(pMemProperties);
+        pMemProperties->maxClockRate = 1000;
+        pMemProperties->maxBusWidth = 64;
+        pMemProperties->totalSize = device->driver->config.memoryBytes;
+        pMemProperties->name = "Mock Memory";
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetMemoryAccessProperties(
+    ze_device_handle_t hDevice,
+    ze_device_memory_access_properties_t* pMemAccessProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pMemAccessProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const ze_memory_access_cap_flags_t caps =
+        ZE_MEMORY_ACCESS_CAP_FLAG_RW |
+        ZE_MEMORY_ACCESS_CAP_FLAG_ATOMIC |
+        ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT |
+        ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT_ATOMIC;
+    clearOutput(pMemAccessProperties);
+    pMemAccessProperties->hostAllocCapabilities = caps;
+    pMemAccessProperties->deviceAllocCapabilities = caps;
+    pMemAccessProperties->sharedSingleDeviceAllocCapabilities = caps;
+    pMemAccessProperties->sharedCrossDeviceAllocCapabilities = caps;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetCacheProperties(
+    ze_device_handle_t hDevice,
+    uint32_t* pCount,
+    ze_device_cache_properties_t* pCacheProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (countOutputs(pCount, pCacheProperties != nullptr, 1)) {
+        clearOutput(pCacheProperties);
+        pCacheProperties->cacheSize = 4 * 1024 * 1024;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetImageProperties(
+    ze_device_handle_t hDevice,
+    ze_device_image_properties_t* pImageProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pImageProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pImageProperties);
+    pImageProperties->maxImageDims1D = 16384;
+    pImageProperties->maxImageDims2D = 16384;
+    pImageProperties->maxImageDims3D = 2048;
+    pImageProperties->maxImageBufferSize = 1ull << 30;
+    pImageProperties->maxImageArraySlices = 2048;
+    pImageProperties->maxSamplers = 16;
+    pImageProperties->maxReadImageArgs = 128;
+    pImageProperties->maxWriteImageArgs = 128;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetExternalMemoryProperties(
+    ze_device_handle_t hDevice,
+    ze_device_external_memory_properties_t* pExternalMemoryProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pExternalMemoryProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pExternalMemoryProperties);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetP2PProperties(
+    ze_device_handle_t hDevice,
+    ze_device_handle_t hPeerDevice,
+    ze_device_p2p_properties_t* pP2PProperties )
+{
+    if (hDevice == nullptr || hPeerDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pP2PProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pP2PProperties);
+    pP2PProperties->flags = ZE_DEVICE_P2P_PROPERTY_FLAG_ACCESS | ZE_DEVICE_P2P_PROPERTY_FLAG_ATOMICS;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceCanAccessPeer(
+    ze_device_handle_t hDevice,
+    ze_device_handle_t hPeerDevice,
+    ze_bool_t* value )
+{
+    if (hDevice == nullptr || hPeerDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (value == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    *value = 1;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetStatus(
+    ze_device_handle_t hDevice )
+{
+    return hDevice ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+}
+
+static ze_result_t ZE_APICALL zeDeviceGetGlobalTimestamps(
+    ze_device_handle_t hDevice,
+    uint64_t* hostTimestamp,
+    uint64_t* deviceTimestamp )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (hostTimestamp == nullptr || deviceTimestamp == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    uint64_t t = now();
+    *hostTimestamp = t;
+    *deviceTimestamp = toObject<Device>(hDevice)->driver->ticks(t);
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Context
+
+static ze_result_t ZE_APICALL zeContextCreate(
+    ze_driver_handle_t hDriver,
+    const ze_context_desc_t* desc,
+    ze_context_handle_t* phContext )
+{
+    if (hDriver == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto context = new Context();
+    context->driver = toObject<Driver>(hDriver);
+    *phContext = toHandle<ze_context_handle_t>(context);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeContextDestroy(
+    ze_context_handle_t hContext )
+{
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Context>(hContext);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeContextGetStatus(
+    ze_context_handle_t hContext )
+{
+    return hContext ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+}
+
+static ze_result_t ZE_APICALL zeContextSystemBarrier(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeContextMakeMemoryResident(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    void* ptr,
+    size_t size )
+{
+    (void)size;
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (ptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Command queue
+
+static ze_result_t ZE_APICALL zeCommandQueueCreate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_command_queue_desc_t* desc,
+    ze_command_queue_handle_t* phCommandQueue )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phCommandQueue == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    if (desc->ordinal >= device->queueGroups.size() ||
+        desc->index >= device->queueGroups[desc->ordinal].numQueues) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    auto queue = new CommandQueue();
+    queue->device = device;
+    queue->engine = device->getEngine(desc->ordinal, desc->index);
+    queue->synchronous = desc->mode == ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
+    *phCommandQueue = toHandle<ze_command_queue_handle_t>(queue);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandQueueDestroy(
+    ze_command_queue_handle_t hCommandQueue )
+{
+    if (hCommandQueue == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<CommandQueue>(hCommandQueue);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandQueueExecuteCommandLists(
+    ze_command_queue_handle_t hCommandQueue,
+    uint32_t numCommandLists,
+    ze_command_list_handle_t* phCommandLists,
+    ze_fence_handle_t hFence )
+{
+    if (hCommandQueue == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (phCommandLists == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (numCommandLists == 0) {
+        return ZE_RESULT_ERROR_INVALID_SIZE;
+    }
+
+    auto queue = toObject<CommandQueue>(hCommandQueue);
+    std::vector<Command> commands;
+    for (uint32_t i = 0; i < numCommandLists; i++) {
+        auto list = toObject<CommandList>(phCommandLists[i]);
+        if (list == nullptr || list->engine) {
+            return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+        }
+        commands.insert(commands.end(), list->commands.begin(), list->commands.end());
+    }
+
+    queue->lastSubmitted = queue->engine->submit(std::move(commands), toObject<Fence>(hFence));
+    if (queue->synchronous) {
+        queue->engine->synchronize(queue->lastSubmitted, UINT64_MAX);
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandQueueSynchronize(
+    ze_command_queue_handle_t hCommandQueue,
+    uint64_t timeout )
+{
+    if (hCommandQueue == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    auto queue = toObject<CommandQueue>(hCommandQueue);
+    return queue->engine->synchronize(queue->lastSubmitted, timeout) ?
+        ZE_RESULT_SUCCESS : ZE_RESULT_NOT_READY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Command list
+
+static ze_result_t ZE_APICALL zeCommandListCreate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_command_list_desc_t* desc,
+    ze_command_list_handle_t* phCommandList )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    if (desc->commandQueueGroupOrdinal >= device->queueGroups.size()) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    auto list = new CommandList();
+    list->device = device;
+    list->ordinal = desc->commandQueueGroupOrdinal;
+    *phCommandList = toHandle<ze_command_list_handle_t>(list);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandListCreateImmediate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_command_queue_desc_t* altdesc,
+    ze_command_list_handle_t* phCommandList )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (altdesc == nullptr || phCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto device = toObject<Device>(hDevice);
+    if (altdesc->ordinal >= device->queueGroups.size() ||
+        altdesc->index >= device->queueGroups[altdesc->ordinal].numQueues) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    auto list = new CommandList();
+    list->device = device;
+    list->ordinal = altdesc->ordinal;
+    list->engine = device->getEngine(altdesc->ordinal, altdesc->index);
+    list->synchronous = altdesc->mode == ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
+    *phCommandList = toHandle<ze_command_list_handle_t>(list);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandListDestroy(
+    ze_command_list_handle_t hCommandList )
+{
+    if (hCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<CommandList>(hCommandList);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandListClose(
+    ze_command_list_handle_t hCommandList )
+{
+    return hCommandList ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+}
+
+static ze_result_t ZE_APICALL zeCommandListReset(
+    ze_command_list_handle_t hCommandList )
+{
+    if (hCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    auto list = toObject<CommandList>(hCommandList);
+    if (list->engine) {
+        list->engine->synchronize(list->lastSubmitted, UINT64_MAX);
+    }
+    list->commands.clear();
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendWriteGlobalTimestamp(
+    ze_command_list_handle_t hCommandList,
+    uint64_t* dstptr,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (dstptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const Driver* driver = &getDriver();
+    Command command;
+    command.work = [=]{ *dstptr = driver->ticks(now()); };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendBarrier(
+    ze_command_list_handle_t hCommandList,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    // Engines execute in order, so a barrier only waits and signals.
+    return append(hCommandList, Command(), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemoryRangesBarrier(
+    ze_command_list_handle_t hCommandList,
+    uint32_t numRanges,
+    const size_t* pRangeSizes,
+    const void** pRanges,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    (void)numRanges;
+    (void)pRangeSizes;
+    (void)pRanges;
+    return append(hCommandList, Command(), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemoryCopy(
+    ze_command_list_handle_t hCommandList,
+    void* dstptr,
+    const void* srcptr,
+    size_t size,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (dstptr == nullptr || srcptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    Command command;
+    command.modeledNs = copyDuration(getDriver().config, size);
+    command.work = [=]{ memmove(dstptr, srcptr, size); };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemoryFill(
+    ze_command_list_handle_t hCommandList,
+    void* ptr,
+    const void* pattern,
+    size_t pattern_size,
+    size_t size,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (ptr == nullptr || pattern == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (pattern_size == 0) {
+        return ZE_RESULT_ERROR_INVALID_SIZE;
+    }
+    std::vector<uint8_t> bytes(
+        static_cast<const uint8_t*>(pattern),
+        static_cast<const uint8_t*>(pattern) + pattern_size);
+    Command command;
+    command.modeledNs = copyDuration(getDriver().config, size);
+    command.work = [=]{
+        uint8_t* dst = static_cast<uint8_t*>(ptr);
+        for (size_t offset = 0; offset < size; offset += pattern_size) {
+            memcpy(dst + offset, bytes.data(), std::min(pattern_size, size - offset));
+        }
+    };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemoryCopyRegion(
+    ze_command_list_handle_t hCommandList,
+    void* dstptr,
+    const ze_copy_region_t* dstRegion,
+    uint32_t dstPitch,
+    uint32_t dstSlicePitch,
+    const void* srcptr,
+    const ze_copy_region_t* srcRegion,
+    uint32_t srcPitch,
+    uint32_t srcSlicePitch,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (dstptr == nullptr || dstRegion == nullptr ||
+        srcptr == nullptr || srcRegion == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(dstptr) +
+        (size_t)dstRegion->originZ * dstSlicePitch +
+        (size_t)dstRegion->originY * dstPitch +
+        dstRegion->originX;
+    const uint8_t* src = static_cast<const uint8_t*>(srcptr) +
+        (size_t)srcRegion->originZ * srcSlicePitch +
+        (size_t)srcRegion->originY * srcPitch +
+        srcRegion->originX;
+    uint32_t width = srcRegion->width;
+    uint32_t height = std::max(srcRegion->height, 1u);
+    uint32_t depth = std::max(srcRegion->depth, 1u);
+
+    Command command;
+    command.modeledNs = copyDuration(getDriver().config, (size_t)width * height * depth);
+    command.work = [=]{
+        copy3D(dst, dstPitch, dstSlicePitch, src, srcPitch, srcSlicePitch, width, height, depth);
+    };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t appendImageCopy(
+    ze_command_list_handle_t hCommandList,
+    Image* dstImage,
+    uint8_t* dstptr,
+    const ze_image_region_t& dstRegion,
+    Image* srcImage,
+    const uint8_t* srcptr,
+    const ze_image_region_t& srcRegion,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    // Memory is tightly packed: its pitches come from the image region.
+    Image* image = srcImage ? srcImage : dstImage;
+    size_t rowBytes = (size_t)srcRegion.width * image->bytesPerPixel;
+    uint32_t height = std::max(srcRegion.height, 1u);
+    uint32_t depth = std::max(srcRegion.depth, 1u);
+
+    size_t dstPitch = dstImage ? (size_t)dstImage->width * image->bytesPerPixel : rowBytes;
+    size_t dstSlicePitch = dstImage ? dstPitch * dstImage->height : rowBytes * height;
+    size_t srcPitch = srcImage ? (size_t)srcImage->width * image->bytesPerPixel : rowBytes;
+    size_t srcSlicePitch = srcImage ? srcPitch * srcImage->height : rowBytes * height;
+    uint8_t* dst = dstImage ? getImagePointer(dstImage, dstRegion) : dstptr;
+    const uint8_t* src = srcImage ? getImagePointer(srcImage, srcRegion) : srcptr;
+
+    Command command;
+    command.modeledNs = copyDuration(getDriver().config, rowBytes * height * depth);
+    command.work = [=]{
+        copy3D(dst, dstPitch, dstSlicePitch, src, srcPitch, srcSlicePitch, rowBytes, height, depth);
+    };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendImageCopy(
+    ze_command_list_handle_t hCommandList,
+    ze_image_handle_t hDstImage,
+    ze_image_handle_t hSrcImage,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hDstImage == nullptr || hSrcImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    auto dstImage = toObject<Image>(hDstImage);
+    auto srcImage = toObject<Image>(hSrcImage);
+    if (dstImage->data.size() != srcImage->data.size()) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    ze_image_region_t region = getImageRegion(srcImage, nullptr);
+    return appendImageCopy(hCommandList,
+        dstImage, nullptr, region,
+        srcImage, nullptr, region,
+        hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendImageCopyRegion(
+    ze_command_list_handle_t hCommandList,
+    ze_image_handle_t hDstImage,
+    ze_image_handle_t hSrcImage,
+    const ze_image_region_t* pDstRegion,
+    const ze_image_region_t* pSrcRegion,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hDstImage == nullptr || hSrcImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    auto dstImage = toObject<Image>(hDstImage);
+    auto srcImage = toObject<Image>(hSrcImage);
+    return appendImageCopy(hCommandList,
+        dstImage, nullptr, getImageRegion(dstImage, pDstRegion),
+        srcImage, nullptr, getImageRegion(srcImage, pSrcRegion),
+        hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendImageCopyToMemory(
+    ze_command_list_handle_t hCommandList,
+    void* dstptr,
+    ze_image_handle_t hSrcImage,
+    const ze_image_region_t* pSrcRegion,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hSrcImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (dstptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto srcImage = toObject<Image>(hSrcImage);
+    ze_image_region_t region = getImageRegion(srcImage, pSrcRegion);
+    return appendImageCopy(hCommandList,
+        nullptr, static_cast<uint8_t*>(dstptr), region,
+        srcImage, nullptr, region,
+        hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendImageCopyFromMemory(
+    ze_command_list_handle_t hCommandList,
+    ze_image_handle_t hDstImage,
+    const void* srcptr,
+    const ze_image_region_t* pDstRegion,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hDstImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (srcptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto dstImage = toObject<Image>(hDstImage);
+    ze_image_region_t region = getImageRegion(dstImage, pDstRegion);
+    return appendImageCopy(hCommandList,
+        dstImage, nullptr, region,
+        nullptr, static_cast<const uint8_t*>(srcptr), region,
+        hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemoryPrefetch(
+    ze_command_list_handle_t hCommandList,
+    const void* ptr,
+    size_t size )
+{
+    (void)size;
+    if (hCommandList == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return ptr ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendMemAdvise(
+    ze_command_list_handle_t hCommandList,
+    ze_device_handle_t hDevice,
+    const void* ptr,
+    size_t size,
+    ze_memory_advice_t advice )
+{
+    (void)size;
+    (void)advice;
+    if (hCommandList == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return ptr ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendSignalEvent(
+    ze_command_list_handle_t hCommandList,
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return append(hCommandList, Command(), hEvent, 0, nullptr);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendWaitOnEvents(
+    ze_command_list_handle_t hCommandList,
+    uint32_t numEvents,
+    ze_event_handle_t* phEvents )
+{
+    return append(hCommandList, Command(), nullptr, numEvents, phEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendEventReset(
+    ze_command_list_handle_t hCommandList,
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    auto event = toObject<Event>(hEvent);
+    Command command;
+    command.work = [=]{ event->reset(); };
+    return append(hCommandList, std::move(command), nullptr, 0, nullptr);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendQueryKernelTimestamps(
+    ze_command_list_handle_t hCommandList,
+    uint32_t numEvents,
+    ze_event_handle_t* phEvents,
+    void* dstptr,
+    const size_t* pOffsets,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (phEvents == nullptr || dstptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    std::vector<Event*> events;
+    std::vector<size_t> offsets;
+    for (uint32_t i = 0; i < numEvents; i++) {
+        events.push_back(toObject<Event>(phEvents[i]));
+        offsets.push_back(pOffsets ? pOffsets[i] : i * sizeof(ze_kernel_timestamp_result_t));
+    }
+    Command command;
+    command.work = [=]{
+        for (size_t i = 0; i < events.size(); i++) {
+            ze_kernel_timestamp_result_t timestamp = events[i]->getTimestamp();
+            memcpy(static_cast<uint8_t*>(dstptr) + offsets[i], &timestamp, sizeof(timestamp));
+        }
+    };
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+static ze_result_t ZE_APICALL zeCommandListAppendLaunchKernel(
+    ze_command_list_handle_t hCommandList,
+    ze_kernel_handle_t hKernel,
+    const ze_group_count_t* pLaunchFuncArgs,
+    ze_event_handle_t hSignalEvent,
+    uint32_t numWaitEvents,
+    ze_event_handle_t* phWaitEvents )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pLaunchFuncArgs == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const Config& config = getDriver().config;
+    uint64_t groups =
+        (uint64_t)pLaunchFuncArgs->groupCountX *
+        pLaunchFuncArgs->groupCountY *
+        pLaunchFuncArgs->groupCountZ;
+    Command command;
+    command.modeledNs = config.kernelNs + groups * config.groupNs;
+    return append(hCommandList, std::move(command), hSignalEvent, numWaitEvents, phWaitEvents);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fence
+
+static ze_result_t ZE_APICALL zeFenceCreate(
+    ze_command_queue_handle_t hCommandQueue,
+    const ze_fence_desc_t* desc,
+    ze_fence_handle_t* phFence )
+{
+    if (hCommandQueue == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phFence == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto fence = new Fence();
+    if (desc->flags & ZE_FENCE_FLAG_SIGNALED) {
+        fence->set();
+    }
+    *phFence = toHandle<ze_fence_handle_t>(fence);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeFenceDestroy(
+    ze_fence_handle_t hFence )
+{
+    if (hFence == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Fence>(hFence);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeFenceHostSynchronize(
+    ze_fence_handle_t hFence,
+    uint64_t timeout )
+{
+    if (hFence == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return toObject<Fence>(hFence)->wait(timeout) ? ZE_RESULT_SUCCESS : ZE_RESULT_NOT_READY;
+}
+
+static ze_result_t ZE_APICALL zeFenceQueryStatus(
+    ze_fence_handle_t hFence )
+{
+    if (hFence == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return toObject<Fence>(hFence)->query() ? ZE_RESULT_SUCCESS : ZE_RESULT_NOT_READY;
+}
+
+static ze_result_t ZE_APICALL zeFenceReset(
+    ze_fence_handle_t hFence )
+{
+    if (hFence == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    toObject<Fence>(hFence)->reset();
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Event pool and event
+
+static ze_result_t ZE_APICALL zeEventPoolCreate(
+    ze_context_handle_t hContext,
+    const ze_event_pool_desc_t* desc,
+    uint32_t numDevices,
+    ze_device_handle_t* phDevices,
+    ze_event_pool_handle_t* phEventPool )
+{
+    (void)numDevices;
+    (void)phDevices;
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phEventPool == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (desc->count == 0) {
+        return ZE_RESULT_ERROR_INVALID_SIZE;
+    }
+    auto pool = new EventPool();
+    pool->driver = toObject<Context>(hContext)->driver;
+    pool->timestamps = (desc->flags & ZE_EVENT_POOL_FLAG_KERNEL_TIMESTAMP) != 0;
+    *phEventPool = toHandle<ze_event_pool_handle_t>(pool);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventPoolDestroy(
+    ze_event_pool_handle_t hEventPool )
+{
+    if (hEventPool == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<EventPool>(hEventPool);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventCreate(
+    ze_event_pool_handle_t hEventPool,
+    const ze_event_desc_t* desc,
+    ze_event_handle_t* phEvent )
+{
+    if (hEventPool == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto event = new Event();
+    event->pool = toObject<EventPool>(hEventPool);
+    *phEvent = toHandle<ze_event_handle_t>(event);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventDestroy(
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Event>(hEvent);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventHostSignal(
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    toObject<Event>(hEvent)->set();
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventHostSynchronize(
+    ze_event_handle_t hEvent,
+    uint64_t timeout )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return toObject<Event>(hEvent)->wait(timeout) ? ZE_RESULT_SUCCESS : ZE_RESULT_NOT_READY;
+}
+
+static ze_result_t ZE_APICALL zeEventQueryStatus(
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    return toObject<Event>(hEvent)->query() ? ZE_RESULT_SUCCESS : ZE_RESULT_NOT_READY;
+}
+
+static ze_result_t ZE_APICALL zeEventHostReset(
+    ze_event_handle_t hEvent )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    toObject<Event>(hEvent)->reset();
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeEventQueryKernelTimestamp(
+    ze_event_handle_t hEvent,
+    ze_kernel_timestamp_result_t* dstptr )
+{
+    if (hEvent == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (dstptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto event = toObject<Event>(hEvent);
+    if (!event->query()) {
+        return ZE_RESULT_NOT_READY;
+    }
+    *dstptr = event->getTimestamp();
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Image and sampler
+
+static ze_result_t ZE_APICALL zeImageGetProperties(
+    ze_device_handle_t hDevice,
+    const ze_image_desc_t* desc,
+    ze_image_properties_t* pImageProperties )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || pImageProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pImageProperties);
+    pImageProperties->samplerFilterFlags =
+        ZE_IMAGE_SAMPLER_FILTER_FLAG_POINT | ZE_IMAGE_SAMPLER_FILTER_FLAG_LINEAR;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeImageCreate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_image_desc_t* desc,
+    ze_image_handle_t* phImage )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto image = new Image();
+    image->desc = *desc;
+    image->bytesPerPixel = getBytesPerPixel(desc->format.layout);
+    image->width = (uint32_t)std::max<uint64_t>(desc->width, 1);
+    image->height = std::max(desc->height, 1u);
+    image->depth = std::max(desc->depth, 1u);
+    if (desc->type == ZE_IMAGE_TYPE_1DARRAY) {
+        image->height = std::max(desc->arraylevels, 1u);
+    } else if (desc->type == ZE_IMAGE_TYPE_2DARRAY) {
+        image->depth = std::max(desc->arraylevels, 1u);
+    }
+    image->data.resize((size_t)image->width * image->height * image->depth * image->bytesPerPixel);
+    *phImage = toHandle<ze_image_handle_t>(image);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeImageDestroy(
+    ze_image_handle_t hImage )
+{
+    if (hImage == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Image>(hImage);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeSamplerCreate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_sampler_desc_t* desc,
+    ze_sampler_handle_t* phSampler )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || phSampler == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto sampler = new Sampler();
+    sampler->desc = *desc;
+    *phSampler = toHandle<ze_sampler_handle_t>(sampler);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeSamplerDestroy(
+    ze_sampler_handle_t hSampler )
+{
+    if (hSampler == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Sampler>(hSampler);
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Memory
+
+static ze_result_t ZE_APICALL zeMemAllocShared(
+    ze_context_handle_t hContext,
+    const ze_device_mem_alloc_desc_t* device_desc,
+    const ze_host_mem_alloc_desc_t* host_desc,
+    size_t size,
+    size_t alignment,
+    ze_device_handle_t hDevice,
+    void** pptr )
+{
+    if (device_desc == nullptr || host_desc == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return allocate(hContext, size, alignment, ZE_MEMORY_TYPE_SHARED, hDevice, pptr);
+}
+
+static ze_result_t ZE_APICALL zeMemAllocDevice(
+    ze_context_handle_t hContext,
+    const ze_device_mem_alloc_desc_t* device_desc,
+    size_t size,
+    size_t alignment,
+    ze_device_handle_t hDevice,
+    void** pptr )
+{
+    if (hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (device_desc == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return allocate(hContext, size, alignment, ZE_MEMORY_TYPE_DEVICE, hDevice, pptr);
+}
+
+static ze_result_t ZE_APICALL zeMemAllocHost(
+    ze_context_handle_t hContext,
+    const ze_host_mem_alloc_desc_t* host_desc,
+    size_t size,
+    size_t alignment,
+    void** pptr )
+{
+    if (host_desc == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return allocate(hContext, size, alignment, ZE_MEMORY_TYPE_HOST, nullptr, pptr);
+}
+
+static ze_result_t ZE_APICALL zeMemFree(
+    ze_context_handle_t hContext,
+    void* ptr )
+{
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (ptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    Driver* driver = toObject<Context>(hContext)->driver;
+    std::lock_guard<std::mutex> lock(driver->mutex);
+    auto it = driver->allocations.find((uintptr_t)ptr);
+    if (it == driver->allocations.end()) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    if (it->second.device) {
+        it->second.device->memoryUsed -= it->second.size;
+    }
+    driver->allocations.erase(it);
+    alignedFree(ptr);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeMemGetAllocProperties(
+    ze_context_handle_t hContext,
+    const void* ptr,
+    ze_memory_allocation_properties_t* pMemAllocProperties,
+    ze_device_handle_t* phDevice )
+{
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (ptr == nullptr || pMemAllocProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    Driver* driver = toObject<Context>(hContext)->driver;
+    std::lock_guard<std::mutex> lock(driver->mutex);
+    uintptr_t base = 0;
+    const Allocation* allocation = findAllocation(driver, ptr, &base);
+    clearOutput(pMemAllocProperties);
+    if (allocation) {
+        pMemAllocProperties->type = allocation->type;
+        pMemAllocProperties->id = allocation->id;
+        pMemAllocProperties->pageSize = allocation->device ? 64 * 1024 : 4096;
+    }
+    if (phDevice) {
+        *phDevice = toHandle<ze_device_handle_t>(allocation ? allocation->device : nullptr);
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeMemGetAddressRange(
+    ze_context_handle_t hContext,
+    const void* ptr,
+    void** pBase,
+    size_t* pSize )
+{
+    if (hContext == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (ptr == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    Driver* driver = toObject<Context>(hContext)->driver;
+    std::lock_guard<std::mutex> lock(driver->mutex);
+    uintptr_t base = 0;
+    const Allocation* allocation = findAllocation(driver, ptr, &base);
+    if (allocation == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    if (pBase) {
+        *pBase = reinterpret_cast<void*>(base);
+    }
+    if (pSize) {
+        *pSize = allocation->size;
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Module and kernel
+
+static ze_result_t ZE_APICALL zeModuleCreate(
+    ze_context_handle_t hContext,
+    ze_device_handle_t hDevice,
+    const ze_module_desc_t* desc,
+    ze_module_handle_t* phModule,
+    ze_module_build_log_handle_t* phBuildLog )
+{
+    if (hContext == nullptr || hDevice == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || desc->pInputModule == nullptr || phModule == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (desc->inputSize == 0) {
+        return ZE_RESULT_ERROR_INVALID_SIZE;
+    }
+
+    // Native binaries from zeModuleGetNativeBinary are the SPIR-V input, so
+    // both formats are parsed.  Other native binaries accept any kernel name.
+    std::vector<std::string> kernelNames = getEntryPoints(desc->pInputModule, desc->inputSize);
+    bool failed = desc->format == ZE_MODULE_FORMAT_IL_SPIRV && kernelNames.empty();
+
+    if (phBuildLog) {
+        auto buildLog = new ModuleBuildLog();
+        if (failed) {
+            buildLog->log = "error: input is not a SPIR-V module with entry points";
+        }
+        *phBuildLog = toHandle<ze_module_build_log_handle_t>(buildLog);
+    }
+    if (failed) {
+        return ZE_RESULT_ERROR_MODULE_BUILD_FAILURE;
+    }
+
+    auto module = new Module();
+    module->binary.assign(desc->pInputModule, desc->pInputModule + desc->inputSize);
+    module->kernelNames = std::move(kernelNames);
+    *phModule = toHandle<ze_module_handle_t>(module);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeModuleDestroy(
+    ze_module_handle_t hModule )
+{
+    if (hModule == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Module>(hModule);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeModuleGetNativeBinary(
+    ze_module_handle_t hModule,
+    size_t* pSize,
+    uint8_t* pModuleNativeBinary )
+{
+    if (hModule == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pSize == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto module = toObject<Module>(hModule);
+    if (pModuleNativeBinary) {
+        memcpy(pModuleNativeBinary, module->binary.data(), std::min(*pSize, module->binary.size()));
+    }
+    *pSize = module->binary.size();
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeModuleGetKernelNames(
+    ze_module_handle_t hModule,
+    uint32_t* pCount,
+    const char** pNames )
+{
+    if (hModule == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto module = toObject<Module>(hModule);
+    uint32_t count = countOutputs(pCount, pNames != nullptr, (uint32_t)module->kernelNames.size());
+    for (uint32_t i = 0; i < count; i++) {
+        pNames[i] = module->kernelNames[i].c_str();
+    }
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeModuleBuildLogDestroy(
+    ze_module_build_log_handle_t hModuleBuildLog )
+{
+    if (hModuleBuildLog == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<ModuleBuildLog>(hModuleBuildLog);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeModuleBuildLogGetString(
+    ze_module_build_log_handle_t hModuleBuildLog,
+    size_t* pSize,
+    char* pBuildLog )
+{
+    if (hModuleBuildLog == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pSize == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const std::string& log = toObject<ModuleBuildLog>(hModuleBuildLog)->log;
+    if (pBuildLog && *pSize) {
+        size_t length = std::min(*pSize - 1, log.size());
+        memcpy(pBuildLog, log.c_str(), length);
+        pBuildLog[length] = '\0';
+    }
+    *pSize = log.size() + 1;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelCreate(
+    ze_module_handle_t hModule,
+    const ze_kernel_desc_t* desc,
+    ze_kernel_handle_t* phKernel )
+{
+    if (hModule == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (desc == nullptr || desc->pKernelName == nullptr || phKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    auto module = toObject<Module>(hModule);
+    if (!module->kernelNames.empty() &&
+        std::find(module->kernelNames.begin(), module->kernelNames.end(), desc->pKernelName) ==
+            module->kernelNames.end()) {
+        return ZE_RESULT_ERROR_INVALID_KERNEL_NAME;
+    }
+    auto kernel = new Kernel();
+    kernel->module = module;
+    kernel->name = desc->pKernelName;
+    *phKernel = toHandle<ze_kernel_handle_t>(kernel);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelDestroy(
+    ze_kernel_handle_t hKernel )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    delete toObject<Kernel>(hKernel);
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelSetGroupSize(
+    ze_kernel_handle_t hKernel,
+    uint32_t groupSizeX,
+    uint32_t groupSizeY,
+    uint32_t groupSizeZ )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (groupSizeX == 0 || groupSizeY == 0 || groupSizeZ == 0 ||
+        (uint64_t)groupSizeX * groupSizeY * groupSizeZ > 1024) {
+        return ZE_RESULT_ERROR_INVALID_GROUP_SIZE_DIMENSION;
+    }
+    auto kernel = toObject<Kernel>(hKernel);
+    kernel->groupSize[0] = groupSizeX;
+    kernel->groupSize[1] = groupSizeY;
+    kernel->groupSize[2] = groupSizeZ;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelSuggestGroupSize(
+    ze_kernel_handle_t hKernel,
+    uint32_t globalSizeX,
+    uint32_t globalSizeY,
+    uint32_t globalSizeZ,
+    uint32_t* groupSizeX,
+    uint32_t* groupSizeY,
+    uint32_t* groupSizeZ )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (groupSizeX == nullptr || groupSizeY == nullptr || groupSizeZ == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const uint32_t maxGroupSize = 256;
+    *groupSizeX = largestDivisor(globalSizeX, maxGroupSize);
+    *groupSizeY = largestDivisor(globalSizeY, maxGroupSize / *groupSizeX);
+    *groupSizeZ = largestDivisor(globalSizeZ, maxGroupSize / (*groupSizeX * *groupSizeY));
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelSuggestMaxCooperativeGroupCount(
+    ze_kernel_handle_t hKernel,
+    uint32_t* totalGroupCount )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (totalGroupCount == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    *totalGroupCount = 32;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelSetArgumentValue(
+    ze_kernel_handle_t hKernel,
+    uint32_t argIndex,
+    size_t argSize,
+    const void* pArgValue )
+{
+    (void)argIndex;
+    (void)argSize;
+    (void)pArgValue;
+    return hKernel ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+}
+
+static ze_result_t ZE_APICALL zeKernelSetIndirectAccess(
+    ze_kernel_handle_t hKernel,
+    ze_kernel_indirect_access_flags_t flags )
+{
+    (void)flags;
+    return hKernel ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+}
+
+static ze_result_t ZE_APICALL zeKernelGetProperties(
+    ze_kernel_handle_t hKernel,
+    ze_kernel_properties_t* pKernelProperties )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pKernelProperties == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    clearOutput(pKernelProperties);
+    pKernelProperties->maxSubgroupSize = 32;
+    pKernelProperties->maxNumSubgroups = 128;
+    return ZE_RESULT_SUCCESS;
+}
+
+static ze_result_t ZE_APICALL zeKernelGetName(
+    ze_kernel_handle_t hKernel,
+    size_t* pSize,
+    char* pName )
+{
+    if (hKernel == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_HANDLE;
+    }
+    if (pSize == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    const std::string& name = toObject<Kernel>(hKernel)->name;
+    if (pName && *pSize) {
+        size_t length = std::min(*pSize - 1, name.size());
+        memcpy(pName, name.c_str(), length);
+        pName[length] = '\0';
+    }
+    *pSize = name.size() + 1;
+    return ZE_RESULT_SUCCESS;
+}
+
+} // namespace mock
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch tables, queried by the loader when it loads the driver.
+
+static bool isSupportedVersion(
+    ze_api_version_t version )
+{
+    return ZE_MAJOR_VERSION(version) == ZE_MAJOR_VERSION(ZE_API_VERSION_CURRENT);
+}
+
+extern "C" {
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetGlobalProcAddrTable(
+    ze_api_version_t version,
+    ze_global_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnInit = mock::zeInit;
+#if defined(ZE_API_VERSION_CURRENT_M) && ZE_API_VERSION_CURRENT_M >= ZE_MAKE_VERSION( 1, 10 )
+    if (version >= ZE_MAKE_VERSION( 1, 10 )) {
+        pDdiTable->pfnInitDrivers = mock::zeInitDrivers;
+    }
+#endif
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetDriverProcAddrTable(
+    ze_api_version_t version,
+    ze_driver_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnGet = mock::zeDriverGet;
+    pDdiTable->pfnGetApiVersion = mock::zeDriverGetApiVersion;
+    pDdiTable->pfnGetProperties = mock::zeDriverGetProperties;
+    pDdiTable->pfnGetExtensionProperties = mock::zeDriverGetExtensionProperties;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetDeviceProcAddrTable(
+    ze_api_version_t version,
+    ze_device_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnGet = mock::zeDeviceGet;
+    pDdiTable->pfnGetSubDevices = mock::zeDeviceGetSubDevices;
+    pDdiTable->pfnGetProperties = mock::zeDeviceGetProperties;
+    pDdiTable->pfnGetComputeProperties = mock::zeDeviceGetComputeProperties;
+    pDdiTable->pfnGetModuleProperties = mock::zeDeviceGetModuleProperties;
+    pDdiTable->pfnGetCommandQueueGroupProperties = mock::zeDeviceGetCommandQueueGroupProperties;
+    pDdiTable->pfnGetMemoryProperties = mock::zeDeviceGetMemoryProperties;
+    pDdiTable->pfnGetMemoryAccessProperties = mock::zeDeviceGetMemoryAccessProperties;
+    pDdiTable->pfnGetCacheProperties = mock::zeDeviceGetCacheProperties;
+    pDdiTable->pfnGetImageProperties = mock::zeDeviceGetImageProperties;
+    pDdiTable->pfnGetExternalMemoryProperties = mock::zeDeviceGetExternalMemoryProperties;
+    pDdiTable->pfnGetP2PProperties = mock::zeDeviceGetP2PProperties;
+    pDdiTable->pfnCanAccessPeer = mock::zeDeviceCanAccessPeer;
+    pDdiTable->pfnGetStatus = mock::zeDeviceGetStatus;
+    pDdiTable->pfnGetGlobalTimestamps = mock::zeDeviceGetGlobalTimestamps;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetContextProcAddrTable(
+    ze_api_version_t version,
+    ze_context_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeContextCreate;
+    pDdiTable->pfnDestroy = mock::zeContextDestroy;
+    pDdiTable->pfnGetStatus = mock::zeContextGetStatus;
+    pDdiTable->pfnSystemBarrier = mock::zeContextSystemBarrier;
+    pDdiTable->pfnMakeMemoryResident = mock::zeContextMakeMemoryResident;
+    pDdiTable->pfnEvictMemory = mock::zeContextMakeMemoryResident;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetCommandQueueProcAddrTable(
+    ze_api_version_t version,
+    ze_command_queue_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeCommandQueueCreate;
+    pDdiTable->pfnDestroy = mock::zeCommandQueueDestroy;
+    pDdiTable->pfnExecuteCommandLists = mock::zeCommandQueueExecuteCommandLists;
+    pDdiTable->pfnSynchronize = mock::zeCommandQueueSynchronize;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetCommandListProcAddrTable(
+    ze_api_version_t version,
+    ze_command_list_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeCommandListCreate;
+    pDdiTable->pfnCreateImmediate = mock::zeCommandListCreateImmediate;
+    pDdiTable->pfnDestroy = mock::zeCommandListDestroy;
+    pDdiTable->pfnClose = mock::zeCommandListClose;
+    pDdiTable->pfnReset = mock::zeCommandListReset;
+    pDdiTable->pfnAppendWriteGlobalTimestamp = mock::zeCommandListAppendWriteGlobalTimestamp;
+    pDdiTable->pfnAppendBarrier = mock::zeCommandListAppendBarrier;
+    pDdiTable->pfnAppendMemoryRangesBarrier = mock::zeCommandListAppendMemoryRangesBarrier;
+    pDdiTable->pfnAppendMemoryCopy = mock::zeCommandListAppendMemoryCopy;
+    pDdiTable->pfnAppendMemoryFill = mock::zeCommandListAppendMemoryFill;
+    pDdiTable->pfnAppendMemoryCopyRegion = mock::zeCommandListAppendMemoryCopyRegion;
+    pDdiTable->pfnAppendImageCopy = mock::zeCommandListAppendImageCopy;
+    pDdiTable->pfnAppendImageCopyRegion = mock::zeCommandListAppendImageCopyRegion;
+    pDdiTable->pfnAppendImageCopyToMemory = mock::zeCommandListAppendImageCopyToMemory;
+    pDdiTable->pfnAppendImageCopyFromMemory = mock::zeCommandListAppendImageCopyFromMemory;
+    pDdiTable->pfnAppendMemoryPrefetch = mock::zeCommandListAppendMemoryPrefetch;
+    pDdiTable->pfnAppendMemAdvise = mock::zeCommandListAppendMemAdvise;
+    pDdiTable->pfnAppendSignalEvent = mock::zeCommandListAppendSignalEvent;
+    pDdiTable->pfnAppendWaitOnEvents = mock::zeCommandListAppendWaitOnEvents;
+    pDdiTable->pfnAppendEventReset = mock::zeCommandListAppendEventReset;
+    pDdiTable->pfnAppendQueryKernelTimestamps = mock::zeCommandListAppendQueryKernelTimestamps;
+    pDdiTable->pfnAppendLaunchKernel = mock::zeCommandListAppendLaunchKernel;
+    pDdiTable->pfnAppendLaunchCooperativeKernel = mock::zeCommandListAppendLaunchKernel;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetFenceProcAddrTable(
+    ze_api_version_t version,
+    ze_fence_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeFenceCreate;
+    pDdiTable->pfnDestroy = mock::zeFenceDestroy;
+    pDdiTable->pfnHostSynchronize = mock::zeFenceHostSynchronize;
+    pDdiTable->pfnQueryStatus = mock::zeFenceQueryStatus;
+    pDdiTable->pfnReset = mock::zeFenceReset;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetEventPoolProcAddrTable(
+    ze_api_version_t version,
+    ze_event_pool_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeEventPoolCreate;
+    pDdiTable->pfnDestroy = mock::zeEventPoolDestroy;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetEventProcAddrTable(
+    ze_api_version_t version,
+    ze_event_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeEventCreate;
+    pDdiTable->pfnDestroy = mock::zeEventDestroy;
+    pDdiTable->pfnHostSignal = mock::zeEventHostSignal;
+    pDdiTable->pfnHostSynchronize = mock::zeEventHostSynchronize;
+    pDdiTable->pfnQueryStatus = mock::zeEventQueryStatus;
+    pDdiTable->pfnHostReset = mock::zeEventHostReset;
+    pDdiTable->pfnQueryKernelTimestamp = mock::zeEventQueryKernelTimestamp;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetImageProcAddrTable(
+    ze_api_version_t version,
+    ze_image_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnGetProperties = mock::zeImageGetProperties;
+    pDdiTable->pfnCreate = mock::zeImageCreate;
+    pDdiTable->pfnDestroy = mock::zeImageDestroy;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetModuleProcAddrTable(
+    ze_api_version_t version,
+    ze_module_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeModuleCreate;
+    pDdiTable->pfnDestroy = mock::zeModuleDestroy;
+    pDdiTable->pfnGetNativeBinary = mock::zeModuleGetNativeBinary;
+    pDdiTable->pfnGetKernelNames = mock::zeModuleGetKernelNames;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetModuleBuildLogProcAddrTable(
+    ze_api_version_t version,
+    ze_module_build_log_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnDestroy = mock::zeModuleBuildLogDestroy;
+    pDdiTable->pfnGetString = mock::zeModuleBuildLogGetString;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetKernelProcAddrTable(
+    ze_api_version_t version,
+    ze_kernel_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeKernelCreate;
+    pDdiTable->pfnDestroy = mock::zeKernelDestroy;
+    pDdiTable->pfnSetGroupSize = mock::zeKernelSetGroupSize;
+    pDdiTable->pfnSuggestGroupSize = mock::zeKernelSuggestGroupSize;
+    pDdiTable->pfnSuggestMaxCooperativeGroupCount = mock::zeKernelSuggestMaxCooperativeGroupCount;
+    pDdiTable->pfnSetArgumentValue = mock::zeKernelSetArgumentValue;
+    pDdiTable->pfnSetIndirectAccess = mock::zeKernelSetIndirectAccess;
+    pDdiTable->pfnGetProperties = mock::zeKernelGetProperties;
+    pDdiTable->pfnGetName = mock::zeKernelGetName;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetSamplerProcAddrTable(
+    ze_api_version_t version,
+    ze_sampler_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnCreate = mock::zeSamplerCreate;
+    pDdiTable->pfnDestroy = mock::zeSamplerDestroy;
+    return ZE_RESULT_SUCCESS;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetMemProcAddrTable(
+    ze_api_version_t version,
+    ze_mem_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    if (!isSupportedVersion(version)) {
+        return ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+    }
+    pDdiTable->pfnAllocShared = mock::zeMemAllocShared;
+    pDdiTable->pfnAllocDevice = mock::zeMemAllocDevice;
+    pDdiTable->pfnAllocHost = mock::zeMemAllocHost;
+    pDdiTable->pfnFree = mock::zeMemFree;
+    pDdiTable->pfnGetAllocProperties = mock::zeMemGetAllocProperties;
+    pDdiTable->pfnGetAddressRange = mock::zeMemGetAddressRange;
+    return ZE_RESULT_SUCCESS;
+}
+
+// Physical and virtual memory are not emulated, but the loader expects every
+// core table to be present.
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetPhysicalMemProcAddrTable(
+    ze_api_version_t version,
+    ze_physical_mem_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return isSupportedVersion(version) ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+}
+
+ZE_DLLEXPORT ze_result_t ZE_APICALL zeGetVirtualMemProcAddrTable(
+    ze_api_version_t version,
+    ze_virtual_mem_dditable_t* pDdiTable )
+{
+    if (pDdiTable == nullptr) {
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
+    return isSupportedVersion(version) ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_UNSUPPORTED_VERSION;
+}
+
+} // extern "C"
@@ -0,0 +1,273 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace mock {
+
+// The latency model, read from the environment by zeInit.  All durations are
+// in nanoseconds.
+struct Config
+{
+    uint32_t devices = 1;           // LZ_MOCK_DEVICES
+    uint32_t computeEngines = 1;    // LZ_MOCK_COMPUTE_ENGINES
+    uint32_t copyEngines = 2;       // LZ_MOCK_COPY_ENGINES
+    uint64_t launchNs = 5000;       // LZ_MOCK_LAUNCH_NS, per submission
+    uint64_t kernelNs = 10000;      // LZ_MOCK_KERNEL_NS, per kernel
+    uint64_t groupNs = 0;           // LZ_MOCK_GROUP_NS, per work-group
+    uint64_t copyNs = 2000;         // LZ_MOCK_COPY_NS, per copy or fill
+    double copyGBps = 16.0;         // LZ_MOCK_COPY_GBPS
+    uint64_t memoryBytes = 4096ull << 20;   // LZ_MOCK_MEMORY_MB
+
+    static Config fromEnvironment();
+};
+
+// Nanoseconds on the host steady clock.  Device timestamps are derived from
+// the same clock so host and device times correlate exactly.
+uint64_t now();
+
+// Sleeps for most of the remaining time and spins for the rest, since the
+// modeled durations are often shorter than the scheduler quantum.
+void waitUntil(
+    uint64_t deadline );
+
+class Signal
+{
+public:
+    void set();
+    void reset();
+    bool query();
+
+    // Returns false if the timeout expires first.  A timeout of UINT64_MAX
+    // waits forever.
+    bool wait(
+        uint64_t timeoutNs );
+
+protected:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool signaled_ = false;
+};
+
+struct Driver;
+struct Device;
+
+struct EventPool
+{
+    Driver* driver = nullptr;
+    bool timestamps = false;
+};
+
+struct Event : public Signal
+{
+    EventPool* pool = nullptr;
+    ze_kernel_timestamp_result_t timestamp = {};
+
+    ze_kernel_timestamp_result_t getTimestamp();
+
+    // Signals the event from an engine, recording the device ticks at which
+    // the command started and ended.
+    void complete(
+        uint64_t startTicks,
+        uint64_t endTicks );
+};
+
+struct Fence : public Signal
+{
+};
+
+struct Command
+{
+    std::vector<Event*> waits;
+    Event* signal = nullptr;
+    uint64_t modeledNs = 0;
+    std::function<void()> work;
+};
+
+// An engine executes submitted commands in order on a host thread, one
+// thread per (device, ordinal, index).  Each command waits for its events,
+// performs its work, then occupies the engine until its modeled duration
+// has elapsed.
+class Engine
+{
+public:
+    explicit Engine(
+        Device* device );
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // Returns an id that may be passed to synchronize.
+    uint64_t submit(
+        std::vector<Command> commands,
+        Fence* fence );
+
+    bool synchronize(
+        uint64_t id,
+        uint64_t timeoutNs );
+
+private:
+    struct Batch
+    {
+        std::vector<Command> commands;
+        Fence* fence = nullptr;
+        uint64_t readyNs = 0;
+        uint64_t id = 0;
+    };
+
+    void run();
+    bool waitForEvent(
+        Event* event );
+
+    Device* device_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Batch> queue_;
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+struct QueueGroup
+{
+    ze_command_queue_group_property_flags_t flags;
+    uint32_t numQueues;
+};
+
+struct Device
+{
+    Driver* driver = nullptr;
+    uint32_t index = 0;
+    std::vector<QueueGroup> queueGroups;
+    uint64_t memoryUsed = 0;    // guarded by Driver::mutex
+
+    // Returns the engine for the given queue, creating it if no queue or
+    // immediate command list currently uses it.
+    std::shared_ptr<Engine> getEngine(
+        uint32_t ordinal,
+        uint32_t index );
+
+private:
+    std::mutex mutex_;
+    std::map<std::pair<uint32_t, uint32_t>, std::weak_ptr<Engine>> engines_;
+};
+
+struct Allocation
+{
+    size_t size;
+    ze_memory_type_t type;
+    Device* device;
+    uint64_t id;
+};
+
+struct Driver
+{
+    Config config;
+    uint64_t epochNs = 0;
+    std::vector<std::unique_ptr<Device>> devices;
+
+    std::mutex mutex;
+    std::map<uintptr_t, Allocation> allocations;
+    uint64_t nextAllocationId = 1;
+
+    // Device ticks are nanoseconds since the driver was initialized.
+    uint64_t ticks(
+        uint64_t hostNs ) const
+    {
+        return hostNs - epochNs;
+    }
+};
+
+struct Context
+{
+    Driver* driver = nullptr;
+};
+
+struct CommandQueue
+{
+    Device* device = nullptr;
+    std::shared_ptr<Engine> engine;
+    bool synchronous = false;
+    uint64_t lastSubmitted = 0;
+};
+
+struct CommandList
+{
+    Device* device = nullptr;
+    uint32_t ordinal = 0;
+    std::vector<Command> commands;
+
+    // Immediate command lists submit each command as it is appended.
+    std::shared_ptr<Engine> engine;
+    bool synchronous = false;
+    uint64_t lastSubmitted = 0;
+};
+
+struct Image
+{
+    ze_image_desc_t desc;
+    uint32_t bytesPerPixel;
+    uint32_t width, height, depth;
+    std::vector<uint8_t> data;
+};
+
+struct Module
+{
+    std::vector<uint8_t> binary;
+    std::vector<std::string> kernelNames;   // empty if unknown
+};
+
+struct Kernel
+{
+    Module* module = nullptr;
+    std::string name;
+    uint32_t groupSize[3] = {1, 1, 1};
+};
+
+struct ModuleBuildLog
+{
+    std::string log;
+};
+
+struct Sampler
+{
+    ze_sampler_desc_t desc;
+};
+
+} // namespace mock
@@ -0,0 +1,547 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "ze_api.h"
+#include "layers/zel_tracing_api.h"
+#include "layers/zel_tracing_register_cb.h"
+
+// The core APIs traced by ApiTracer.  Each entry names an API without its
+// "ze" prefix; the loader provides a zelTracer<name>RegisterCallback function
+// for each of them.  This is a subset of the loader's tracing table: the
+// Level Zero 1.0 core APIs plus zeDeviceGetGlobalTimestamps.  Core APIs added
+// later, and extension and experimental APIs, are not traced.  Sysman (zes)
+// and tools (zet) APIs are not traced either: the loader's tracing layer only
+// intercepts the core ze dispatch table.
+#define LZUTIL_TRACED_APIS( X ) \
+    X( DriverGet ) \
+    X( DriverGetApiVersion ) \
+    X( DriverGetProperties ) \
+    X( DriverGetIpcProperties ) \
+    X( DriverGetExtensionProperties ) \
+    X( DeviceGet ) \
+    X( DeviceGetSubDevices ) \
+    X( DeviceGetProperties ) \
+    X( DeviceGetComputeProperties ) \
+    X( DeviceGetModuleProperties ) \
+    X( DeviceGetCommandQueueGroupProperties ) \
+    X( DeviceGetMemoryProperties ) \
+    X( DeviceGetMemoryAccessProperties ) \
+    X( DeviceGetCacheProperties ) \
+    X( DeviceGetImageProperties ) \
+    X( DeviceGetExternalMemoryProperties ) \
+    X( DeviceGetP2PProperties ) \
+    X( DeviceCanAccessPeer ) \
+    X( DeviceGetStatus ) \
+    X( DeviceGetGlobalTimestamps ) \
+    X( ContextCreate ) \
+    X( ContextDestroy ) \
+    X( ContextGetStatus ) \
+    X( ContextSystemBarrier ) \
+    X( ContextMakeMemoryResident ) \
+    X( ContextEvictMemory ) \
+    X( ContextMakeImageResident ) \
+    X( ContextEvictImage ) \
+    X( CommandQueueCreate ) \
+    X( CommandQueueDestroy ) \
+    X( CommandQueueExecuteCommandLists ) \
+    X( CommandQueueSynchronize ) \
+    X( CommandListCreate ) \
+    X( CommandListCreateImmediate ) \
+    X( CommandListDestroy ) \
+    X( CommandListClose ) \
+    X( CommandListReset ) \
+    X( CommandListAppendWriteGlobalTimestamp ) \
+    X( CommandListAppendBarrier ) \
+    X( CommandListAppendMemoryRangesBarrier ) \
+    X( CommandListAppendMemoryCopy ) \
+    X( CommandListAppendMemoryFill ) \
+    X( CommandListAppendMemoryCopyRegion ) \
+    X( CommandListAppendMemoryCopyFromContext ) \
+    X( CommandListAppendImageCopy ) \
+    X( CommandListAppendImageCopyRegion ) \
+    X( CommandListAppendImageCopyToMemory ) \
+    X( CommandListAppendImageCopyFromMemory ) \
+    X( CommandListAppendMemoryPrefetch ) \
+    X( CommandListAppendMemAdvise ) \
+    X( CommandListAppendSignalEvent ) \
+    X( CommandListAppendWaitOnEvents ) \
+    X( CommandListAppendEventReset ) \
+    X( CommandListAppendQueryKernelTimestamps ) \
+    X( CommandListAppendLaunchKernel ) \
+    X( CommandListAppendLaunchCooperativeKernel ) \
+    X( CommandListAppendLaunchKernelIndirect ) \
+    X( CommandListAppendLaunchMultipleKernelsIndirect ) \
+    X( FenceCreate ) \
+    X( FenceDestroy ) \
+    X( FenceHostSynchronize ) \
+    X( FenceQueryStatus ) \
+    X( FenceReset ) \
+    X( EventPoolCreate ) \
+    X( EventPoolDestroy ) \
+    X( EventPoolGetIpcHandle ) \
+    X( EventPoolOpenIpcHandle ) \
+    X( EventPoolCloseIpcHandle ) \
+    X( EventCreate ) \
+    X( EventDestroy ) \
+    X( EventHostSignal ) \
+    X( EventHostSynchronize ) \
+    X( EventQueryStatus ) \
+    X( EventHostReset ) \
+    X( EventQueryKernelTimestamp ) \
+    X( ImageGetProperties ) \
+    X( ImageCreate ) \
+    X( ImageDestroy ) \
+    X( ModuleCreate ) \
+    X( ModuleDestroy ) \
+    X( ModuleDynamicLink ) \
+    X( ModuleGetNativeBinary ) \
+    X( ModuleGetGlobalPointer ) \
+    X( ModuleGetKernelNames ) \
+    X( ModuleGetProperties ) \
+    X( ModuleGetFunctionPointer ) \
+    X( ModuleBuildLogDestroy ) \
+    X( ModuleBuildLogGetString ) \
+    X( KernelCreate ) \
+    X( KernelDestroy ) \
+    X( KernelSetCacheConfig ) \
+    X( KernelSetGroupSize ) \
+    X( KernelSuggestGroupSize ) \
+    X( KernelSuggestMaxCooperativeGroupCount ) \
+    X( KernelSetArgumentValue ) \
+    X( KernelSetIndirectAccess ) \
+    X( KernelGetIndirectAccess ) \
+    X( KernelGetSourceAttributes ) \
+    X( KernelGetProperties ) \
+    X( KernelGetName ) \
+    X( SamplerCreate ) \
+    X( SamplerDestroy ) \
+    X( MemAllocShared ) \
+    X( MemAllocDevice ) \
+    X( MemAllocHost ) \
+    X( MemFree ) \
+    X( MemGetAllocProperties ) \
+    X( MemGetAddressRange ) \
+    X( MemGetIpcHandle ) \
+    X( MemOpenIpcHandle ) \
+    X( MemCloseIpcHandle ) \
+    X( PhysicalMemCreate ) \
+    X( PhysicalMemDestroy ) \
+    X( VirtualMemReserve ) \
+    X( VirtualMemFree ) \
+    X( VirtualMemQueryPageSize ) \
+    X( VirtualMemMap ) \
+    X( VirtualMemUnmap ) \
+    X( VirtualMemSetAccessAttribute ) \
+    X( VirtualMemGetAccessAttribute )
+
+namespace lzutil {
+
+// Measures the latency of Level Zero API calls using the loader's tracing
+// layer, and reports a latency histogram per API.
+//
+// The tracing layer must be enabled with ZE_ENABLE_TRACING_LAYER=1 before
+// zeInit, and the tracer must be created after zeInit.  Calls are only
+// traced while the tracer exists.  Only the core APIs listed in
+// LZUTIL_TRACED_APIS are traced; Sysman (zes) calls are not.
+//
+// The prologue callback stores a timestamp in the per-call instance data.
+// The epilogue callback adds the elapsed time to a histogram in a buffer
+// owned by the calling thread, using relaxed loads and stores only, so
+// threads never contend and never take a lock after their first traced call.
+// Timestamps come from the TSC on x86 and from steady_clock elsewhere.
+//
+// A span callback may also be set to receive the host time span of every
+// traced call, e.g. to add the calls to a ChromeTrace.
+class ApiTracer
+{
+public:
+    enum Api : uint32_t {
+#define LZUTIL_TRACED_API_ENUM( _name ) API_##_name,
+        LZUTIL_TRACED_APIS( LZUTIL_TRACED_API_ENUM )
+#undef LZUTIL_TRACED_API_ENUM
+        API_COUNT
+    };
+
+    // Histogram buckets are powers of two of the timestamp ticks.
+    static const uint32_t bucketCount = 48;
+
+    // Called on the calling thread after each traced call returns, with the
+    // API and the host steady_clock times the call started and returned.
+    // The callback must not make Level Zero calls.
+    using SpanCallback = std::function<void(
+        uint32_t api,
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end)>;
+
+    // Creates and enables the tracer.  If reportFile is not null the report is
+    // written to it when the tracer is destroyed.
+    explicit ApiTracer(
+        FILE* reportFile = stdout ) :
+        reportFile_(reportFile),
+        generation_(nextGeneration()),
+        startTicks_(now()),
+        startTime_(std::chrono::steady_clock::now())
+    {
+        zel_tracer_desc_t tracerDesc = {};
+        tracerDesc.stype = ZEL_STRUCTURE_TYPE_TRACER_DESC;
+        tracerDesc.pUserData = this;
+
+        result_ = zelTracerCreate(&tracerDesc, &tracer_);
+        if (result_ != ZE_RESULT_SUCCESS) {
+            tracer_ = nullptr;
+            return;
+        }
+
+#define LZUTIL_TRACED_API_REGISTER( _name )                                     \
+        if (result_ == ZE_RESULT_SUCCESS) {                                     \
+            result_ = zelTracer##_name##RegisterCallback(                       \
+                tracer_, ZEL_REGISTER_PROLOGUE, &prologue<API_##_name>);        \
+        }                                                                       \
+        if (result_ == ZE_RESULT_SUCCESS) {                                     \
+            result_ = zelTracer##_name##RegisterCallback(                       \
+                tracer_, ZEL_REGISTER_EPILOGUE, &epilogue<API_##_name>);        \
+        }
+        LZUTIL_TRACED_APIS( LZUTIL_TRACED_API_REGISTER )
+#undef LZUTIL_TRACED_API_REGISTER
+
+        if (result_ == ZE_RESULT_SUCCESS) {
+            result_ = zelTracerSetEnabled(tracer_, true);
+        }
+    }
+
+    ~ApiTracer()
+    {
+        if (tracer_) {
+            zelTracerSetEnabled(tracer_, false);
+            zelTracerDestroy(tracer_);
+        }
+        if (reportFile_) {
+            report(reportFile_);
+        }
+    }
+
+    ApiTracer(const ApiTracer&) = delete;
+    ApiTracer& operator=(const ApiTracer&) = delete;
+
+    // Pauses or resumes tracing.
+    ze_result_t setEnabled(
+        bool enabled )
+    {
+        return tracer_ ? zelTracerSetEnabled(tracer_, enabled) : result_;
+    }
+
+    // Sets the span callback.  It must be set before other threads make
+    // traced calls, or while tracing is paused.
+    void setSpanCallback(
+        SpanCallback callback )
+    {
+        spanCallback_ = std::move(callback);
+    }
+
+    // The result of creating and enabling the tracer.
+    ze_result_t result() const
+    {
+        return result_;
+    }
+
+    static const char* name(
+        uint32_t api )
+    {
+        static const char* names[] = {
+#define LZUTIL_TRACED_API_NAME( _name ) "ze" #_name,
+            LZUTIL_TRACED_APIS( LZUTIL_TRACED_API_NAME )
+#undef LZUTIL_TRACED_API_NAME
+        };
+        return api < API_COUNT ? names[api] : "unknown";
+    }
+
+    struct Summary {
+        uint32_t    api;
+        uint64_t    calls;
+        double      totalNs;
+        double      maxNs;
+        uint64_t    buckets[bucketCount];
+    };
+
+    // Returns a summary of every API that was called, merged across threads,
+    // sorted by total time.  Threads may still be making calls.
+    std::vector<Summary> summarize() const
+    {
+        const double nsPerTick = getNsPerTick();
+
+        std::vector<Summary> summaries;
+        std::lock_guard<std::mutex> lock(threadsMutex_);
+        for (uint32_t api = 0; api < API_COUNT; api++) {
+            Summary s = {};
+            s.api = api;
+            uint64_t ticks = 0;
+            uint64_t maxTicks = 0;
+            for (const auto& thread : threads_) {
+                const Stat& stat = thread->stats[api];
+                s.calls += stat.calls.load(std::memory_order_relaxed);
+                ticks += stat.ticks.load(std::memory_order_relaxed);
+                maxTicks = std::max(maxTicks, stat.maxTicks.load(std::memory_order_relaxed));
+                for (uint32_t b = 0; b < bucketCount; b++) {
+                    s.buckets[b] += stat.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+            if (s.calls) {
+                s.totalNs = ticks * nsPerTick;
+                s.maxNs = maxTicks * nsPerTick;
+                summaries.push_back(s);
+            }
+        }
+        std::sort(summaries.begin(), summaries.end(),
+            [](const Summary& a, const Summary& b) {
+                return a.totalNs > b.totalNs;
+            });
+        return summaries;
+    }
+
+    // Writes a latency table and one histogram line per API.  Percentiles
+    // are the upper bounds of histogram buckets.
+    void report(
+        FILE* fp ) const
+    {
+        const double nsPerTick = getNsPerTick();
+        const auto summaries = summarize();
+
+        fprintf(fp, "%-48s %10s %10s %10s %10s %10s %12s\n",
+            "API", "calls", "mean ns", "p50 ns", "p99 ns", "max ns", "total ms");
+        for (const auto& s : summaries) {
+            fprintf(fp, "%-48s %10llu %10.0f %10.0f %10.0f %10.0f %12.3f\n",
+                name(s.api),
+                (unsigned long long)s.calls,
+                s.totalNs / s.calls,
+                percentile(s, 0.50) * nsPerTick,
+                percentile(s, 0.99) * nsPerTick,
+                s.maxNs,
+                s.totalNs / 1e6);
+        }
+
+        fprintf(fp, "\nHistograms (ns: calls):\n");
+        for (const auto& s : summaries) {
+            fprintf(fp, "%s\n   ", name(s.api));
+            for (uint32_t b = 0; b < bucketCount; b++) {
+                if (s.buckets[b]) {
+                    fprintf(fp, " <%.0f: %llu",
+                        (double)(2ull << b) * nsPerTick,
+                        (unsigned long long)s.buckets[b]);
+                }
+            }
+            fprintf(fp, "\n");
+        }
+    }
+
+private:
+    // Counters are written by one thread and read by report(), so relaxed
+    // atomics are enough and compile to plain loads and stores.
+    struct Stat {
+        std::atomic<uint64_t>   calls;
+        std::atomic<uint64_t>   ticks;
+        std::atomic<uint64_t>   maxTicks;
+        std::atomic<uint64_t>   buckets[bucketCount];
+    };
+
+    struct ThreadBuffer {
+        Stat    stats[API_COUNT];
+    };
+
+    struct ThreadState {
+        uint64_t        generation;
+        ThreadBuffer*   buffer;
+    };
+
+    zel_tracer_handle_t tracer_ = nullptr;
+    ze_result_t         result_ = ZE_RESULT_SUCCESS;
+    FILE*               reportFile_;
+    SpanCallback        spanCallback_;
+
+    const uint64_t      generation_;
+    const uint64_t      startTicks_;
+    const std::chrono::steady_clock::time_point startTime_;
+
+    mutable std::mutex                          threadsMutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>>  threads_;
+
+    static uint64_t nextGeneration()
+    {
+        static std::atomic<uint64_t> generation(0);
+        return ++generation;
+    }
+
+    static ThreadState& threadState()
+    {
+        static thread_local ThreadState state = { 0, nullptr };
+        return state;
+    }
+
+    static uint64_t now()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static uint32_t bucket(
+        uint64_t ticks )
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, ticks | 1);
+        const uint32_t b = index;
+#elif defined(__GNUC__)
+        const uint32_t b = 63 - __builtin_clzll(ticks | 1);
+#else
+        uint32_t b = 0;
+        while (ticks >>= 1) {
+            b++;
+        }
+#endif
+        return std::min(b, bucketCount - 1);
+    }
+
+    // Calibrates ticks against steady_clock over the life of the tracer.
+    double getNsPerTick() const
+    {
+        const uint64_t ticks = now() - startTicks_;
+        const double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - startTime_).count();
+        return ticks ? ns / ticks : 1.0;
+    }
+
+    static uint64_t percentile(
+        const Summary& s,
+        double fraction )
+    {
+        const uint64_t target = (uint64_t)(s.calls * fraction);
+        uint64_t seen = 0;
+        for (uint32_t b = 0; b < bucketCount; b++) {
+            seen += s.buckets[b];
+            if (seen > target) {
+                return 2ull << b;
+            }
+        }
+        return 2ull << (bucketCount - 1);
+    }
+
+    ThreadBuffer* addThread()
+    {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        for (auto& stat : buffer->stats) {
+            stat.calls.store(0, std::memory_order_relaxed);
+            stat.ticks.store(0, std::memory_order_relaxed);
+            stat.maxTicks.store(0, std::memory_order_relaxed);
+            for (auto& count : stat.buckets) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(threadsMutex_);
+        threads_.push_back(std::move(buffer));
+        return threads_.back().get();
+    }
+
+    static void add(
+        std::atomic<uint64_t>& counter,
+        uint64_t value )
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+            std::memory_order_relaxed);
+    }
+
+    void record(
+        uint32_t api,
+        uint64_t ticks )
+    {
+        ThreadState& state = threadState();
+        if (state.generation != generation_) {
+            state.buffer = addThread();
+            state.generation = generation_;
+        }
+
+        Stat& stat = state.buffer->stats[api];
+        add(stat.calls, 1);
+        add(stat.ticks, ticks);
+        add(stat.buckets[bucket(ticks)], 1);
+        if (ticks > stat.maxTicks.load(std::memory_order_relaxed)) {
+            stat.maxTicks.store(ticks, std::memory_order_relaxed);
+        }
+
+        // The span ends now and is as long as the measured call.
+        if (spanCallback_) {
+            const auto end = std::chrono::steady_clock::now();
+            const auto duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::nano>(ticks * getNsPerTick()));
+            spanCallback_(api, end - duration, end);
+        }
+    }
+
+    // The instance data is pointer sized, so on 32-bit hosts only the low
+    // bits of the start time are kept, which is enough for the difference.
+    template <uint32_t api, typename Params>
+    static void ZE_APICALL prologue(
+        Params* /*params*/,
+        ze_result_t /*result*/,
+        void* /*tracerUserData*/,
+        void** instanceUserData )
+    {
+        *instanceUserData = reinterpret_cast<void*>(static_cast<uintptr_t>(now()));
+    }
+
+    template <uint32_t api, typename Params>
+    static void ZE_APICALL epilogue(
+        Params* /*params*/,
+        ze_result_t /*result*/,
+        void* tracerUserData,
+        void** instanceUserData )
+    {
+        const uintptr_t end = static_cast<uintptr_t>(now());
+        const uintptr_t start = reinterpret_cast<uintptr_t>(*instanceUserData);
+        static_cast<ApiTracer*>(tracerUserData)->record(api, end - start);
+    }
+};
+
+} // namespace lzutil
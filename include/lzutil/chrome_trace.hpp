@@ -0,0 +1,382 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ze_api.h"
+#include "lzutil/timestamp_profiler.hpp"
+
+namespace lzutil {
+
+// Maps device timestamps to host steady_clock time.
+//
+// Each call to sync() reads the device timer with zeDeviceGetGlobalTimestamps
+// between two reads of the host clock, and records the device ticks against
+// the midpoint of the host reads.  Device ticks are mapped to host time by
+// interpolating between the two nearest sync points, so drift between the
+// two clocks is corrected as long as sync() is called regularly, e.g. once
+// per second or whenever timestamps are collected.  Before the first and
+// after the last sync point the nearest measured rate is used.
+//
+// Kernel timestamps only have kernelTimestampValidBits bits.  They are
+// extended using the most recent sync point, so they must be converted
+// within half a wrap of the kernel timestamp counter from a sync.
+class DeviceClock
+{
+public:
+    explicit DeviceClock(
+        ze_device_handle_t device ) :
+        device_(device)
+    {
+        // With the base device properties stype the timer resolution is
+        // reported in nanoseconds per tick.
+        ze_device_properties_t deviceProps = {};
+        deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+        zeDeviceGetProperties(device_, &deviceProps);
+
+        nsPerTick_ = deviceProps.timerResolution ?
+            (double)deviceProps.timerResolution :
+            1.0;
+        globalMask_ = makeMask(deviceProps.timestampValidBits);
+        kernelMask_ = makeMask(deviceProps.kernelTimestampValidBits);
+
+        sync();
+    }
+
+    // Adds a sync point.
+    ze_result_t sync()
+    {
+        const auto before = std::chrono::steady_clock::now();
+        uint64_t hostTimestamp = 0;
+        uint64_t deviceTimestamp = 0;
+        const ze_result_t result = zeDeviceGetGlobalTimestamps(device_, &hostTimestamp, &deviceTimestamp);
+        const auto after = std::chrono::steady_clock::now();
+
+        if (result == ZE_RESULT_SUCCESS) {
+            SyncPoint point;
+            point.hostNs = (hostNs(before) + hostNs(after)) / 2.0;
+            point.rawTicks = deviceTimestamp & globalMask_;
+            point.ticks = points_.empty() ?
+                point.rawTicks :
+                points_.back().ticks + ((point.rawTicks - points_.back().rawTicks) & globalMask_);
+            points_.push_back(point);
+        }
+        return result;
+    }
+
+    // Converts a global kernel timestamp to host steady_clock nanoseconds.
+    double kernelTicksToHostNs(
+        uint64_t kernelTicks ) const
+    {
+        return ticksToHostNs(extendKernelTicks(kernelTicks));
+    }
+
+    // Converts extended device ticks to host steady_clock nanoseconds.
+    double ticksToHostNs(
+        uint64_t ticks ) const
+    {
+        if (points_.empty()) {
+            return ticks * nsPerTick_;
+        }
+        if (points_.size() == 1) {
+            return points_[0].hostNs + (int64_t)(ticks - points_[0].ticks) * nsPerTick_;
+        }
+
+        // Find the segment containing ticks, or the first or last segment.
+        auto it = std::upper_bound(points_.begin(), points_.end(), ticks,
+            [](uint64_t t, const SyncPoint& p) {
+                return t < p.ticks;
+            });
+        const size_t upper = std::min<size_t>(
+            std::max<size_t>(it - points_.begin(), 1), points_.size() - 1);
+        const SyncPoint& p0 = points_[upper - 1];
+        const SyncPoint& p1 = points_[upper];
+
+        const double nsPerTick = (p1.ticks > p0.ticks) ?
+            (p1.hostNs - p0.hostNs) / (p1.ticks - p0.ticks) :
+            nsPerTick_;
+        return p0.hostNs + (int64_t)(ticks - p0.ticks) * nsPerTick;
+    }
+
+    // The difference between the measured and nominal device timer rates,
+    // in parts per million, over all sync points.
+    double driftPpm() const
+    {
+        if (points_.size() < 2 || points_.back().ticks == points_.front().ticks) {
+            return 0.0;
+        }
+        const double hostSpan = points_.back().hostNs - points_.front().hostNs;
+        const double deviceSpan = (points_.back().ticks - points_.front().ticks) * nsPerTick_;
+        return (hostSpan / deviceSpan - 1.0) * 1e6;
+    }
+
+    size_t syncPoints() const
+    {
+        return points_.size();
+    }
+
+    static double hostNs(
+        std::chrono::steady_clock::time_point t )
+    {
+        return std::chrono::duration<double, std::nano>(t.time_since_epoch()).count();
+    }
+
+private:
+    struct SyncPoint {
+        double      hostNs;
+        uint64_t    rawTicks;
+        uint64_t    ticks;      // extended past timestampValidBits
+    };
+
+    ze_device_handle_t      device_;
+    double                  nsPerTick_;
+    uint64_t                globalMask_;
+    uint64_t                kernelMask_;
+    std::vector<SyncPoint>  points_;
+
+    static uint64_t makeMask(
+        uint32_t validBits )
+    {
+        return (validBits == 0 || validBits >= 64) ?
+            ~0ULL :
+            (1ULL << validBits) - 1;
+    }
+
+    // Kernel timestamps are the low bits of the global timer.  The high bits
+    // are chosen to put the timestamp within half a wrap of the last sync
+    // point.
+    uint64_t extendKernelTicks(
+        uint64_t kernelTicks ) const
+    {
+        if (points_.empty() || kernelMask_ == ~0ULL) {
+            return kernelTicks;
+        }
+        const uint64_t reference = points_.back().ticks;
+        const uint64_t wrap = kernelMask_ + 1;
+        uint64_t ticks = (reference & ~kernelMask_) | (kernelTicks & kernelMask_);
+        if (ticks > reference && ticks - reference > wrap / 2 && ticks >= wrap) {
+            ticks -= wrap;
+        } else if (ticks < reference && reference - ticks > wrap / 2) {
+            ticks += wrap;
+        }
+        return ticks;
+    }
+};
+
+// Collects host and device spans and writes them as a Chrome Trace Event
+// JSON file, which can be opened in chrome://tracing or Perfetto.
+//
+// All times are host steady_clock nanoseconds.  Device timestamps are
+// converted with a DeviceClock.  Host spans may be added from any thread.
+class ChromeTrace
+{
+public:
+    static const uint32_t hostPid = 0;
+
+    // Records a host span on the calling thread from construction to
+    // destruction.
+    class Scope
+    {
+    public:
+        Scope(
+            ChromeTrace& trace,
+            const std::string& name,
+            const char* category = "host" ) :
+            trace_(trace),
+            name_(name),
+            category_(category),
+            start_(std::chrono::steady_clock::now()) {}
+
+        ~Scope()
+        {
+            trace_.addHostSpan(name_, category_, start_, std::chrono::steady_clock::now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ChromeTrace&    trace_;
+        std::string     name_;
+        const char*     category_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    ChromeTrace()
+    {
+        setProcessName(hostPid, "Host");
+    }
+
+    // Returns a small, stable id for the calling thread.
+    static uint32_t hostThreadId()
+    {
+        static std::atomic<uint32_t> nextId(0);
+        static thread_local uint32_t id = nextId++;
+        return id;
+    }
+
+    void addSpan(
+        uint32_t pid,
+        uint32_t tid,
+        const std::string& name,
+        const char* category,
+        double startNs,
+        double endNs )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(Event{ name, category, pid, tid, startNs, std::max(endNs, startNs) });
+    }
+
+    void addHostSpan(
+        const std::string& name,
+        const char* category,
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end )
+    {
+        addSpan(hostPid, hostThreadId(), name, category,
+            DeviceClock::hostNs(start), DeviceClock::hostNs(end));
+    }
+
+    // Adds collected timestamp profiler records to a device lane.
+    void addDeviceRecords(
+        const DeviceClock& clock,
+        uint32_t pid,
+        uint32_t tid,
+        const std::vector<TimestampProfiler::Record>& records,
+        const char* category = "device" )
+    {
+        for (const auto& r : records) {
+            addSpan(pid, tid, r.name, category,
+                clock.kernelTicksToHostNs(r.globalStart),
+                clock.kernelTicksToHostNs(r.globalEnd));
+        }
+    }
+
+    void setProcessName(
+        uint32_t pid,
+        const std::string& name )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.push_back(Name{ "process_name", pid, 0, name });
+    }
+
+    void setThreadName(
+        uint32_t pid,
+        uint32_t tid,
+        const std::string& name )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.push_back(Name{ "thread_name", pid, tid, name });
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_.size();
+    }
+
+    // Writes complete ("X") events with microsecond timestamps relative to
+    // the earliest span.
+    bool write(
+        const std::string& fileName ) const
+    {
+        FILE* fp = fopen(fileName.c_str(), "w");
+        if (fp == nullptr) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        double originNs = 0.0;
+        for (size_t i = 0; i < events_.size(); i++) {
+            originNs = (i == 0) ? events_[i].startNs : std::min(originNs, events_[i].startNs);
+        }
+
+        fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const auto& n : names_) {
+            fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", n.type, n.pid, n.tid, escape(n.name).c_str());
+            first = false;
+        }
+        for (const auto& e : events_) {
+            fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", escape(e.name).c_str(), escape(e.category).c_str(),
+                e.pid, e.tid, (e.startNs - originNs) / 1e3, (e.endNs - e.startNs) / 1e3);
+            first = false;
+        }
+        fprintf(fp, "\n]}\n");
+
+        return fclose(fp) == 0;
+    }
+
+private:
+    struct Event {
+        std::string name;
+        const char* category;
+        uint32_t    pid;
+        uint32_t    tid;
+        double      startNs;
+        double      endNs;
+    };
+
+    struct Name {
+        const char* type;
+        uint32_t    pid;
+        uint32_t    tid;
+        std::string name;
+    };
+
+    mutable std::mutex  mutex_;
+    std::vector<Event>  events_;
+    std::vector<Name>   names_;
+
+    static std::string escape(
+        const std::string& s )
+    {
+        std::string ret;
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+                ret += c;
+            } else if ((unsigned char)c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                ret += buf;
+            } else {
+                ret += c;
+            }
+        }
+        return ret;
+    }
+};
+
+} // namespace lzutil
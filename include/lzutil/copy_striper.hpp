@@ -0,0 +1,226 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// Splits large copies across every copy engine on a device.
+//
+// The striper discovers the command queue groups that support copies but not
+// compute, which are the dedicated (main and link) copy engines, and creates
+// one command queue and command list per engine.  A copy is divided into
+// contiguous chunks, one per engine, and all chunks are submitted before
+// waiting for any of them, so the engines run concurrently.
+//
+// The compute engine can optionally be added as one more copy engine.  If a
+// device has no dedicated copy engines the compute engine is always used.
+class CopyStriper
+{
+public:
+    struct Engine
+    {
+        uint32_t                    ordinal;
+        uint32_t                    index;
+        bool                        compute;
+        ze_command_queue_handle_t   queue;
+        ze_command_list_handle_t    cmdList;
+    };
+
+    static const size_t defaultMinChunkSize = 1024 * 1024;
+    static const size_t chunkAlignment = 4096;
+
+    CopyStriper(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        bool useCompute = false,
+        size_t minChunkSize = defaultMinChunkSize ) :
+        context_(context),
+        device_(device),
+        minChunkSize_(std::max(minChunkSize, chunkAlignment))
+    {
+        uint32_t groupCount = 0;
+        zeDeviceGetCommandQueueGroupProperties(device_, &groupCount, nullptr);
+
+        std::vector<ze_command_queue_group_properties_t> groups(groupCount);
+        for (auto& group : groups) {
+            group.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+        }
+        zeDeviceGetCommandQueueGroupProperties(device_, &groupCount, groups.data());
+
+        uint32_t computeOrdinal = UINT32_MAX;
+        for (uint32_t ordinal = 0; ordinal < groupCount; ordinal++) {
+            const auto flags = groups[ordinal].flags;
+            if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) {
+                if (computeOrdinal == UINT32_MAX) {
+                    computeOrdinal = ordinal;
+                }
+            } else if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) {
+                for (uint32_t index = 0; index < groups[ordinal].numQueues; index++) {
+                    addEngine(ordinal, index, false);
+                }
+            }
+        }
+
+        if (computeOrdinal != UINT32_MAX && (useCompute || engines_.empty())) {
+            addEngine(computeOrdinal, 0, true);
+        }
+    }
+
+    ~CopyStriper()
+    {
+        for (auto& engine : engines_) {
+            zeCommandListDestroy(engine.cmdList);
+            zeCommandQueueDestroy(engine.queue);
+        }
+    }
+
+    CopyStriper(const CopyStriper&) = delete;
+    CopyStriper& operator=(const CopyStriper&) = delete;
+
+    const std::vector<Engine>& engines() const
+    {
+        return engines_;
+    }
+
+    // Copies size bytes from src to dst using up to maxEngines engines, and
+    // waits for the copy to complete.  Each engine copies at least
+    // minChunkSize bytes, so small copies use fewer engines.
+    ze_result_t copy(
+        void* dst,
+        const void* src,
+        size_t size,
+        size_t maxEngines = SIZE_MAX )
+    {
+        if (engines_.empty()) {
+            return ZE_RESULT_ERROR_UNINITIALIZED;
+        }
+        if (size == 0) {
+            return ZE_RESULT_SUCCESS;
+        }
+
+        const size_t chunkSize = getChunkSize(size, maxEngines);
+
+        ze_result_t result = ZE_RESULT_SUCCESS;
+        size_t submitted = 0;
+        for (size_t offset = 0; offset < size; offset += chunkSize, submitted++) {
+            Engine& engine = engines_[submitted];
+            const size_t bytes = std::min(chunkSize, size - offset);
+
+            result = record(engine, (char*)dst + offset, (const char*)src + offset, bytes);
+            if (result == ZE_RESULT_SUCCESS) {
+                result = zeCommandQueueExecuteCommandLists(
+                    engine.queue, 1, &engine.cmdList, nullptr);
+            }
+            if (result != ZE_RESULT_SUCCESS) {
+                break;
+            }
+        }
+
+        // Always wait for everything that was submitted, even on error, so
+        // the command lists can safely be reset by the next copy.
+        for (size_t i = 0; i < submitted; i++) {
+            ze_result_t syncResult = zeCommandQueueSynchronize(engines_[i].queue, UINT64_MAX);
+            if (result == ZE_RESULT_SUCCESS) {
+                result = syncResult;
+            }
+        }
+
+        return result;
+    }
+
+private:
+    ze_context_handle_t context_;
+    ze_device_handle_t  device_;
+    size_t              minChunkSize_;
+
+    std::vector<Engine> engines_;
+
+    void addEngine(
+        uint32_t ordinal,
+        uint32_t index,
+        bool compute )
+    {
+        Engine engine = {};
+        engine.ordinal = ordinal;
+        engine.index = index;
+        engine.compute = compute;
+
+        ze_command_queue_desc_t queueDesc = {};
+        queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+        queueDesc.ordinal = ordinal;
+        queueDesc.index = index;
+        queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+        if (zeCommandQueueCreate(context_, device_, &queueDesc, &engine.queue) != ZE_RESULT_SUCCESS) {
+            return;
+        }
+
+        ze_command_list_desc_t cmdListDesc = {};
+        cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+        cmdListDesc.commandQueueGroupOrdinal = ordinal;
+        if (zeCommandListCreate(context_, device_, &cmdListDesc, &engine.cmdList) != ZE_RESULT_SUCCESS) {
+            zeCommandQueueDestroy(engine.queue);
+            return;
+        }
+
+        engines_.push_back(engine);
+    }
+
+    // Rounding chunks up to the alignment can only reduce the number of
+    // chunks, so there are never more chunks than engines.
+    size_t getChunkSize(
+        size_t size,
+        size_t maxEngines ) const
+    {
+        size_t count = std::min(engines_.size(), std::max<size_t>(maxEngines, 1));
+        count = std::min(count, std::max<size_t>(size / minChunkSize_, 1));
+
+        const size_t chunkSize = (size + count - 1) / count;
+        return (chunkSize + chunkAlignment - 1) / chunkAlignment * chunkAlignment;
+    }
+
+    static ze_result_t record(
+        const Engine& engine,
+        void* dst,
+        const void* src,
+        size_t size )
+    {
+        ze_result_t result = zeCommandListReset(engine.cmdList);
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListAppendMemoryCopy(
+                engine.cmdList, dst, src, size, nullptr, 0, nullptr);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListClose(engine.cmdList);
+        }
+        return result;
+    }
+};
+
+} // namespace lzutil
@@ -0,0 +1,61 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace lzutil {
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void empty() {}
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %3 "empty"
+//   %1 = OpTypeVoid
+//   %2 = OpTypeFunction %1
+//   %3 = OpFunction %1 None %2
+//   %4 = OpLabel
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t emptyKernelSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000005, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0005000F, 0x00000006, 0x00000003, 0x74706D65, 0x00000079,
+    0x00020013, 0x00000001,
+    0x00030021, 0x00000002, 0x00000001,
+    0x00050036, 0x00000001, 0x00000003, 0x00000000, 0x00000002,
+    0x000200F8, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char emptyKernelName[] = "empty";
+
+} // namespace lzutil
@@ -0,0 +1,281 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// Waits for events by spinning on zeEventQueryStatus for a short window and
+// then blocking in zeEventHostSynchronize.
+//
+// The spin window adapts to recent completion times: it is set to a
+// percentile of the recent wait durations, so waits that usually finish
+// quickly are caught by spinning, while waits that usually take longer than
+// maxSpinNs stop spinning and block almost immediately.
+//
+// wait() waits on the calling thread.  notify() hands an event to a single
+// background thread that watches any number of events and runs a callback
+// when each one completes, so many request streams can share one waiting
+// thread.  Callbacks run on that thread and may call notify() again.
+class EventWaiter
+{
+public:
+    struct Options {
+        uint64_t    minSpinNs = 0;
+        uint64_t    maxSpinNs = 50 * 1000;
+        uint64_t    initialSpinNs = 10 * 1000;
+        // When the background thread blocks, it blocks on the oldest event
+        // for at most this long before checking the others again.
+        uint64_t    blockSliceNs = 200 * 1000;
+        double      percentile = 0.9;
+        size_t      historySize = 64;
+    };
+
+    using Callback = std::function<void(ze_result_t)>;
+
+    EventWaiter() : EventWaiter(Options()) {}
+
+    explicit EventWaiter(
+        const Options& options ) :
+        options_(options),
+        spinNs_(std::min(std::max(options.initialSpinNs, options.minSpinNs), options.maxSpinNs)),
+        historyNext_(0),
+        spinCompletions_(0),
+        blockCompletions_(0),
+        stop_(false)
+    {
+        history_.reserve(options_.historySize ? options_.historySize : 1);
+    }
+
+    // Waits for all events passed to notify() before returning.
+    ~EventWaiter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    EventWaiter(const EventWaiter&) = delete;
+    EventWaiter& operator=(const EventWaiter&) = delete;
+
+    uint64_t spinWindowNs() const { return spinNs_.load(std::memory_order_relaxed); }
+    uint64_t spinCompletions() const { return spinCompletions_.load(std::memory_order_relaxed); }
+    uint64_t blockCompletions() const { return blockCompletions_.load(std::memory_order_relaxed); }
+
+    // Waits for an event on the calling thread.  The timeout covers both the
+    // spin and the blocking phases.
+    ze_result_t wait(
+        ze_event_handle_t event,
+        uint64_t timeout = UINT64_MAX )
+    {
+        const auto start = clk::now();
+        const uint64_t spinNs = std::min(spinWindowNs(), timeout);
+
+        ze_result_t result = zeEventQueryStatus(event);
+        uint64_t elapsed = 0;
+        while (result == ZE_RESULT_NOT_READY && elapsed < spinNs) {
+            result = zeEventQueryStatus(event);
+            elapsed = elapsedNs(start);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            spinCompletions_.fetch_add(1, std::memory_order_relaxed);
+            record(elapsedNs(start));
+            return result;
+        }
+        if (result != ZE_RESULT_NOT_READY) {
+            return result;
+        }
+
+        elapsed = elapsedNs(start);
+        result = zeEventHostSynchronize(event,
+            timeout == UINT64_MAX ? UINT64_MAX : timeout - std::min(timeout, elapsed));
+        if (result == ZE_RESULT_SUCCESS) {
+            blockCompletions_.fetch_add(1, std::memory_order_relaxed);
+            record(elapsedNs(start));
+        }
+        return result;
+    }
+
+    // Calls callback on the waiter thread once the event completes, or with
+    // the error if querying the event fails.
+    void notify(
+        ze_event_handle_t event,
+        Callback callback )
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(Pending{ event, std::move(callback), clk::now() });
+            if (!thread_.joinable()) {
+                thread_ = std::thread(&EventWaiter::run, this);
+            }
+        }
+        cv_.notify_one();
+    }
+
+private:
+    using clk = std::chrono::steady_clock;
+
+    struct Pending {
+        ze_event_handle_t   event;
+        Callback            callback;
+        clk::time_point     start;
+    };
+
+    Options options_;
+
+    std::atomic<uint64_t> spinNs_;
+    std::mutex historyMutex_;
+    std::vector<uint64_t> history_;
+    std::vector<uint64_t> scratch_;
+    size_t historyNext_;
+
+    std::atomic<uint64_t> spinCompletions_;
+    std::atomic<uint64_t> blockCompletions_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Pending> incoming_;
+    bool stop_;
+    std::thread thread_;
+
+    static uint64_t elapsedNs(
+        clk::time_point start )
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - start).count();
+    }
+
+    // Records a completion time and updates the spin window.
+    void record(
+        uint64_t ns )
+    {
+        if (options_.historySize == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(historyMutex_);
+        if (history_.size() < options_.historySize) {
+            history_.push_back(ns);
+        } else {
+            history_[historyNext_] = ns;
+        }
+        historyNext_ = (historyNext_ + 1) % options_.historySize;
+
+        // Recomputing the percentile is much more expensive than a spin
+        // iteration, so it is only done every few completions.
+        const size_t interval = std::max<size_t>(options_.historySize / 8, 1);
+        if (historyNext_ % interval != 0) {
+            return;
+        }
+
+        scratch_.assign(history_.begin(), history_.end());
+        const size_t index = std::min(scratch_.size() - 1,
+            (size_t)(options_.percentile * scratch_.size()));
+        std::nth_element(scratch_.begin(), scratch_.begin() + index, scratch_.end());
+
+        // If most waits outlast the longest allowed spin, spinning only burns
+        // CPU, so block right away instead.
+        const uint64_t target = scratch_[index];
+        spinNs_.store(target > options_.maxSpinNs ?
+            options_.minSpinNs :
+            std::max(target, options_.minSpinNs),
+            std::memory_order_relaxed);
+    }
+
+    void run()
+    {
+        std::vector<Pending> pending;
+        ze_event_handle_t blocked = nullptr;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (pending.empty()) {
+                    cv_.wait(lock, [this] { return stop_ || !incoming_.empty(); });
+                    if (incoming_.empty()) {
+                        return;
+                    }
+                }
+                for (auto& p : incoming_) {
+                    pending.push_back(std::move(p));
+                }
+                incoming_.clear();
+            }
+
+            // Check every event, completing the ones that are done.
+            for (size_t i = 0; i < pending.size(); ) {
+                const ze_result_t result = zeEventQueryStatus(pending[i].event);
+                if (result == ZE_RESULT_NOT_READY) {
+                    i++;
+                    continue;
+                }
+                if (result == ZE_RESULT_SUCCESS) {
+                    auto& counter = (pending[i].event == blocked) ?
+                        blockCompletions_ :
+                        spinCompletions_;
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                    record(elapsedNs(pending[i].start));
+                }
+
+                Pending p = std::move(pending[i]);
+                if (i + 1 != pending.size()) {
+                    pending[i] = std::move(pending.back());
+                }
+                pending.pop_back();
+
+                p.callback(result);
+            }
+            blocked = nullptr;
+
+            if (pending.empty()) {
+                continue;
+            }
+
+            // Keep spinning while the oldest event is within the spin
+            // window, otherwise block on it for a slice.
+            auto oldest = std::min_element(pending.begin(), pending.end(),
+                [](const Pending& a, const Pending& b) { return a.start < b.start; });
+            if (elapsedNs(oldest->start) >= spinWindowNs()) {
+                zeEventHostSynchronize(oldest->event, options_.blockSliceNs);
+                blocked = oldest->event;
+            }
+        }
+    }
+};
+
+} // namespace lzutil
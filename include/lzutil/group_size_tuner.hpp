@@ -0,0 +1,402 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ze_api.h"
+#include "lzutil/file_util.hpp"
+#include "lzutil/timestamp_profiler.hpp"
+
+namespace lzutil {
+
+// Finds the fastest work-group size for a kernel and global size, and
+// remembers it in a small text database so later runs can skip tuning.
+//
+// Candidates are power-of-two group sizes that evenly divide the global size
+// and fit within maxGroupSizeX/Y/Z and maxTotalGroupSize.  Each sub-group
+// size reported by the device is tried as well, using a kernel compiled for
+// that sub-group size by a caller-supplied factory.  The group size returned
+// by zeKernelSuggestGroupSize is always measured as the baseline.
+//
+// Entries are keyed by the device UUID, driver version, kernel name and
+// global size, so a driver update or a different device triggers retuning.
+class GroupSizeTuner
+{
+public:
+    struct Config {
+        uint32_t    groupSizeX;
+        uint32_t    groupSizeY;
+        uint32_t    groupSizeZ;
+        uint32_t    subGroupSize;   // 0 for the compiler's choice
+        double      ns;             // minimum kernel time
+    };
+
+    struct Result {
+        Config      best;
+        Config      suggested;
+        bool        cached;         // true if read from the database
+        size_t      measured;       // configurations measured this run
+    };
+
+    // Returns a kernel with all arguments set, compiled for the requested
+    // sub-group size, or nullptr if that sub-group size is not supported.
+    // A sub-group size of zero requests the compiler's choice.  The tuner
+    // destroys the kernels it receives.
+    using KernelFactory = std::function<ze_kernel_handle_t(uint32_t subGroupSize)>;
+
+    explicit GroupSizeTuner(
+        const std::string& dbPath,
+        uint32_t iterations = 5 ) :
+        dbPath_(dbPath),
+        iterations_(iterations ? iterations : 1)
+    {
+        load(dbPath_, entries_);
+    }
+
+    const std::string& dbPath() const { return dbPath_; }
+
+    static std::string makeKey(
+        ze_driver_handle_t driver,
+        ze_device_handle_t device,
+        const std::string& kernelName,
+        uint32_t globalSizeX,
+        uint32_t globalSizeY,
+        uint32_t globalSizeZ )
+    {
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        ze_device_properties_t deviceProps = {};
+        deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+        zeDeviceGetProperties(device, &deviceProps);
+
+        std::string key;
+        for (auto b : deviceProps.uuid.id) {
+            char hex[3];
+            snprintf(hex, sizeof(hex), "%02x", b);
+            key += hex;
+        }
+        key += "-";
+        key += std::to_string(driverProps.driverVersion);
+        key += "-";
+        for (auto c : kernelName) {
+            key += (c == ' ' || c == '\t' || c == '\n') ? '_' : c;
+        }
+
+        char sizes[64];
+        snprintf(sizes, sizeof(sizes), "-%ux%ux%u",
+            globalSizeX, globalSizeY, globalSizeZ);
+        key += sizes;
+
+        return key;
+    }
+
+    // Looks up a previously tuned configuration.
+    bool lookup(
+        ze_driver_handle_t driver,
+        ze_device_handle_t device,
+        const std::string& kernelName,
+        uint32_t globalSizeX,
+        uint32_t globalSizeY,
+        uint32_t globalSizeZ,
+        Result& result ) const
+    {
+        auto it = entries_.find(
+            makeKey(driver, device, kernelName, globalSizeX, globalSizeY, globalSizeZ));
+        if (it == entries_.end()) {
+            return false;
+        }
+        result = it->second;
+        result.cached = true;
+        result.measured = 0;
+        return true;
+    }
+
+    // Returns the tuned configuration from the database if there is one,
+    // otherwise sweeps the candidates, records the winner, and saves the
+    // database.  Set force to retune even if an entry exists.
+    ze_result_t tune(
+        ze_driver_handle_t driver,
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        const std::string& kernelName,
+        uint32_t globalSizeX,
+        uint32_t globalSizeY,
+        uint32_t globalSizeZ,
+        const KernelFactory& factory,
+        Result& result,
+        bool force = false )
+    {
+        if (!force && lookup(driver, device, kernelName,
+                globalSizeX, globalSizeY, globalSizeZ, result)) {
+            return ZE_RESULT_SUCCESS;
+        }
+
+        ze_device_compute_properties_t computeProps = {};
+        computeProps.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
+        ze_result_t status = zeDeviceGetComputeProperties(device, &computeProps);
+        if (status != ZE_RESULT_SUCCESS) {
+            return status;
+        }
+
+        ze_command_queue_desc_t queueDesc = {};
+        queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+        queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+        ze_command_queue_handle_t queue = nullptr;
+        status = zeCommandQueueCreate(context, device, &queueDesc, &queue);
+        if (status != ZE_RESULT_SUCCESS) {
+            return status;
+        }
+
+        ze_command_list_desc_t cmdListDesc = {};
+        cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+        ze_command_list_handle_t cmdList = nullptr;
+        status = zeCommandListCreate(context, device, &cmdListDesc, &cmdList);
+        if (status != ZE_RESULT_SUCCESS) {
+            zeCommandQueueDestroy(queue);
+            return status;
+        }
+
+        TimestampProfiler profiler(context, device);
+        const uint32_t globalSize[3] = { globalSizeX, globalSizeY, globalSizeZ };
+
+        result = Result();
+        result.best.ns = -1.0;
+        result.suggested.ns = -1.0;
+
+        std::vector<uint32_t> subGroupSizes(1, 0);
+        subGroupSizes.insert(subGroupSizes.end(),
+            computeProps.subGroupSizes,
+            computeProps.subGroupSizes + computeProps.numSubGroupSizes);
+
+        for (auto subGroupSize : subGroupSizes) {
+            ze_kernel_handle_t kernel = factory(subGroupSize);
+            if (kernel == nullptr) {
+                continue;
+            }
+
+            std::vector<Config> candidates;
+            if (subGroupSize == 0) {
+                Config suggested = {};
+                if (zeKernelSuggestGroupSize(kernel, globalSizeX, globalSizeY, globalSizeZ,
+                        &suggested.groupSizeX, &suggested.groupSizeY, &suggested.groupSizeZ) == ZE_RESULT_SUCCESS) {
+                    suggested.ns = measure(queue, cmdList, profiler, kernel, globalSize, suggested);
+                    result.suggested = suggested;
+                    result.measured++;
+                    consider(result.best, suggested);
+                }
+            }
+            getCandidates(computeProps, globalSize, subGroupSize, candidates);
+
+            for (auto& candidate : candidates) {
+                candidate.ns = measure(queue, cmdList, profiler, kernel, globalSize, candidate);
+                result.measured++;
+                consider(result.best, candidate);
+            }
+
+            zeKernelDestroy(kernel);
+        }
+
+        zeCommandListDestroy(cmdList);
+        zeCommandQueueDestroy(queue);
+
+        if (result.best.ns < 0.0) {
+            return ZE_RESULT_ERROR_UNKNOWN;
+        }
+
+        entries_[makeKey(driver, device, kernelName, globalSizeX, globalSizeY, globalSizeZ)] = result;
+        save();
+
+        return ZE_RESULT_SUCCESS;
+    }
+
+    // Writes the database, merging with entries saved by other processes.
+    bool save() const
+    {
+        std::map<std::string, Result> merged;
+        load(dbPath_, merged);
+        for (auto& it : entries_) {
+            merged[it.first] = it.second;
+        }
+
+        std::random_device rd;
+        const std::string tempPath = dbPath_ + "." + std::to_string(rd()) + ".tmp";
+
+        FILE* fp = fopen(tempPath.c_str(), "w");
+        if (fp == nullptr) {
+            return false;
+        }
+
+        bool ok = true;
+        for (auto& it : merged) {
+            const Config& b = it.second.best;
+            const Config& s = it.second.suggested;
+            ok = fprintf(fp, "%s %u %u %u %u %.1f %u %u %u %u %.1f\n",
+                it.first.c_str(),
+                b.groupSizeX, b.groupSizeY, b.groupSizeZ, b.subGroupSize, b.ns,
+                s.groupSizeX, s.groupSizeY, s.groupSizeZ, s.subGroupSize, s.ns) > 0 && ok;
+        }
+        ok = (fclose(fp) == 0) && ok;
+
+        if (ok && !replaceFile(tempPath, dbPath_)) {
+            ok = false;
+        }
+        if (!ok) {
+            remove(tempPath.c_str());
+        }
+        return ok;
+    }
+
+private:
+    std::string dbPath_;
+    uint32_t    iterations_;
+    std::map<std::string, Result> entries_;
+
+    static void load(
+        const std::string& path,
+        std::map<std::string, Result>& entries )
+    {
+        FILE* fp = fopen(path.c_str(), "r");
+        if (fp == nullptr) {
+            return;
+        }
+
+        char key[512];
+        Result r = {};
+        while (fscanf(fp, "%511s %u %u %u %u %lf %u %u %u %u %lf",
+                key,
+                &r.best.groupSizeX, &r.best.groupSizeY, &r.best.groupSizeZ,
+                &r.best.subGroupSize, &r.best.ns,
+                &r.suggested.groupSizeX, &r.suggested.groupSizeY, &r.suggested.groupSizeZ,
+                &r.suggested.subGroupSize, &r.suggested.ns) == 11) {
+            entries[key] = r;
+        }
+
+        fclose(fp);
+    }
+
+    static void consider(
+        Config& best,
+        const Config& candidate )
+    {
+        if (candidate.ns >= 0.0 && (best.ns < 0.0 || candidate.ns < best.ns)) {
+            best = candidate;
+        }
+    }
+
+    // Power-of-two group sizes that divide the global size, fit the device
+    // limits, and fill whole sub-groups.
+    static void getCandidates(
+        const ze_device_compute_properties_t& props,
+        const uint32_t globalSize[3],
+        uint32_t subGroupSize,
+        std::vector<Config>& candidates )
+    {
+        const uint32_t maxGroupSize[3] = {
+            props.maxGroupSizeX, props.maxGroupSizeY, props.maxGroupSizeZ };
+
+        std::vector<uint32_t> sizes[3];
+        for (int d = 0; d < 3; d++) {
+            for (uint32_t s = 1; s <= maxGroupSize[d] && s <= globalSize[d]; s *= 2) {
+                if (globalSize[d] % s == 0) {
+                    sizes[d].push_back(s);
+                }
+            }
+        }
+
+        for (auto x : sizes[0]) {
+            for (auto y : sizes[1]) {
+                for (auto z : sizes[2]) {
+                    const uint64_t total = (uint64_t)x * y * z;
+                    if (total > props.maxTotalGroupSize ||
+                        (subGroupSize != 0 && total % subGroupSize != 0)) {
+                        continue;
+                    }
+                    Config c = {};
+                    c.groupSizeX = x;
+                    c.groupSizeY = y;
+                    c.groupSizeZ = z;
+                    c.subGroupSize = subGroupSize;
+                    candidates.push_back(c);
+                }
+            }
+        }
+    }
+
+    // Returns the minimum kernel time in nanoseconds, or a negative value if
+    // the configuration could not be launched.
+    double measure(
+        ze_command_queue_handle_t queue,
+        ze_command_list_handle_t cmdList,
+        TimestampProfiler& profiler,
+        ze_kernel_handle_t kernel,
+        const uint32_t globalSize[3],
+        const Config& config )
+    {
+        if (zeKernelSetGroupSize(kernel,
+                config.groupSizeX, config.groupSizeY, config.groupSizeZ) != ZE_RESULT_SUCCESS) {
+            return -1.0;
+        }
+
+        ze_group_count_t groupCount = {
+            globalSize[0] / config.groupSizeX,
+            globalSize[1] / config.groupSizeY,
+            globalSize[2] / config.groupSizeZ };
+
+        // The first launch is not timed.
+        bool ok = zeCommandListReset(cmdList) == ZE_RESULT_SUCCESS;
+        ok = ok && zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+            nullptr, 0, nullptr) == ZE_RESULT_SUCCESS;
+        for (uint32_t i = 0; ok && i < iterations_; i++) {
+            ok = zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) == ZE_RESULT_SUCCESS;
+            ok = ok && zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+                profiler.signal("tune"), 0, nullptr) == ZE_RESULT_SUCCESS;
+        }
+        ok = ok && zeCommandListClose(cmdList) == ZE_RESULT_SUCCESS;
+        ok = ok && zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) == ZE_RESULT_SUCCESS;
+        ok = ok && zeCommandQueueSynchronize(queue, UINT64_MAX) == ZE_RESULT_SUCCESS;
+
+        profiler.clear();
+        if (!ok) {
+            profiler.discard();
+            return -1.0;
+        }
+        profiler.collect();
+
+        auto summary = profiler.summarize();
+        auto it = summary.find("tune");
+        return it == summary.end() ? -1.0 : it->second.minNs;
+    }
+};
+
+} // namespace lzutil
@@ -0,0 +1,371 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// A move-only owner for a Level Zero handle, which destroys the handle with
+// destroyFn when the owner is destroyed or reset.
+//
+//   lzutil::Context context;
+//   zeContextCreate(driver, &contextDesc, context.put());
+template <typename T, ze_result_t (ZE_APICALL *destroyFn)(T)>
+class Unique
+{
+public:
+    Unique() = default;
+
+    explicit Unique(
+        T handle ) :
+        handle_(handle) {}
+
+    Unique(Unique&& other) noexcept :
+        handle_(other.release()) {}
+
+    Unique& operator=(Unique&& other) noexcept
+    {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+
+    ~Unique()
+    {
+        reset();
+    }
+
+    Unique(const Unique&) = delete;
+    Unique& operator=(const Unique&) = delete;
+
+    T get() const
+    {
+        return handle_;
+    }
+
+    explicit operator bool() const
+    {
+        return handle_ != nullptr;
+    }
+
+    // Destroys the current handle and returns storage for a new one, for use
+    // as the output parameter of a create function.
+    T* put()
+    {
+        reset();
+        return &handle_;
+    }
+
+    T release()
+    {
+        return std::exchange(handle_, nullptr);
+    }
+
+    void reset(
+        T handle = nullptr )
+    {
+        T old = std::exchange(handle_, handle);
+        if (old) {
+            destroyFn(old);
+        }
+    }
+
+private:
+    T   handle_ = nullptr;
+};
+
+using Context = Unique<ze_context_handle_t, zeContextDestroy>;
+using CommandQueue = Unique<ze_command_queue_handle_t, zeCommandQueueDestroy>;
+using CommandList = Unique<ze_command_list_handle_t, zeCommandListDestroy>;
+using EventPool = Unique<ze_event_pool_handle_t, zeEventPoolDestroy>;
+using Event = Unique<ze_event_handle_t, zeEventDestroy>;
+using Module = Unique<ze_module_handle_t, zeModuleDestroy>;
+using Kernel = Unique<ze_kernel_handle_t, zeKernelDestroy>;
+
+// A move-only owner for a handle borrowed from a recycler, which returns the
+// handle to the recycler instead of destroying it.  The recycler must outlive
+// the handles it gives out.
+template <typename T, typename Recycler>
+class Recycled
+{
+public:
+    Recycled() = default;
+
+    Recycled(
+        Recycler* recycler,
+        T handle ) :
+        recycler_(recycler),
+        handle_(handle) {}
+
+    Recycled(Recycled&& other) noexcept :
+        recycler_(other.recycler_),
+        handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Recycled& operator=(Recycled&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            recycler_ = other.recycler_;
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Recycled()
+    {
+        reset();
+    }
+
+    Recycled(const Recycled&) = delete;
+    Recycled& operator=(const Recycled&) = delete;
+
+    T get() const
+    {
+        return handle_;
+    }
+
+    explicit operator bool() const
+    {
+        return handle_ != nullptr;
+    }
+
+    // Returns the handle to the recycler.
+    void reset()
+    {
+        T old = std::exchange(handle_, nullptr);
+        if (old) {
+            recycler_->recycle(old);
+        }
+    }
+
+private:
+    Recycler*   recycler_ = nullptr;
+    T           handle_ = nullptr;
+};
+
+// Hands out command lists for one command queue group, and resets released
+// command lists with zeCommandListReset so they can be reused.  A command
+// list must not be released while it is executing.  Like EventRecycler, the
+// recycler destroys every command list it created when it is destroyed,
+// including command lists that are still held by callers.
+class CommandListRecycler
+{
+public:
+    using Handle = Recycled<ze_command_list_handle_t, CommandListRecycler>;
+
+    CommandListRecycler(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        uint32_t ordinal = 0,
+        ze_command_list_flags_t flags = 0 ) :
+        context_(context),
+        device_(device),
+        ordinal_(ordinal),
+        flags_(flags) {}
+
+    ~CommandListRecycler()
+    {
+        for (auto cmdList : cmdLists_) {
+            zeCommandListDestroy(cmdList);
+        }
+    }
+
+    CommandListRecycler(const CommandListRecycler&) = delete;
+    CommandListRecycler& operator=(const CommandListRecycler&) = delete;
+
+    // Returns a command list that is ready for recording, or an empty handle
+    // if a new command list could not be created.
+    Handle acquire()
+    {
+        ze_command_list_handle_t cmdList = nullptr;
+        if (!free_.empty()) {
+            cmdList = free_.back();
+            free_.pop_back();
+        } else {
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+            cmdListDesc.commandQueueGroupOrdinal = ordinal_;
+            cmdListDesc.flags = flags_;
+            if (zeCommandListCreate(context_, device_, &cmdListDesc, &cmdList) == ZE_RESULT_SUCCESS) {
+                cmdLists_.push_back(cmdList);
+                created_++;
+            } else {
+                cmdList = nullptr;
+            }
+        }
+        return Handle(this, cmdList);
+    }
+
+    // Command lists created so far.
+    uint32_t created() const
+    {
+        return created_;
+    }
+
+    // Command lists waiting to be reused.
+    size_t available() const
+    {
+        return free_.size();
+    }
+
+private:
+    friend class Recycled<ze_command_list_handle_t, CommandListRecycler>;
+
+    ze_context_handle_t     context_;
+    ze_device_handle_t      device_;
+    uint32_t                ordinal_;
+    ze_command_list_flags_t flags_;
+
+    std::vector<ze_command_list_handle_t>   cmdLists_;
+    std::vector<ze_command_list_handle_t>   free_;
+    uint32_t                                created_ = 0;
+
+    void recycle(
+        ze_command_list_handle_t cmdList )
+    {
+        if (zeCommandListReset(cmdList) == ZE_RESULT_SUCCESS) {
+            free_.push_back(cmdList);
+        } else {
+            cmdLists_.erase(std::find(cmdLists_.begin(), cmdLists_.end(), cmdList));
+            zeCommandListDestroy(cmdList);
+        }
+    }
+};
+
+// Hands out events from a set of event pools that grows one pool at a time,
+// and resets released events with zeEventHostReset so they can be reused.
+// An event must not be released while a command that signals or waits on it
+// is pending.  The recycler destroys every event it created when it is
+// destroyed, including events that are still held by callers.
+class EventRecycler
+{
+public:
+    using Handle = Recycled<ze_event_handle_t, EventRecycler>;
+
+    EventRecycler(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        uint32_t eventsPerPool = 256,
+        ze_event_pool_flags_t poolFlags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE ) :
+        context_(context),
+        device_(device),
+        eventsPerPool_(eventsPerPool ? eventsPerPool : 1),
+        poolFlags_(poolFlags) {}
+
+    ~EventRecycler()
+    {
+        // Events are destroyed before their pools.
+        for (auto event : events_) {
+            zeEventDestroy(event);
+        }
+        for (auto pool : pools_) {
+            zeEventPoolDestroy(pool);
+        }
+    }
+
+    EventRecycler(const EventRecycler&) = delete;
+    EventRecycler& operator=(const EventRecycler&) = delete;
+
+    // Returns an event in the reset state, or an empty handle if a new event
+    // pool could not be created.
+    Handle acquire()
+    {
+        if (free_.empty()) {
+            grow();
+        }
+        ze_event_handle_t event = nullptr;
+        if (!free_.empty()) {
+            event = free_.back();
+            free_.pop_back();
+        }
+        return Handle(this, event);
+    }
+
+    // Events created so far.
+    size_t created() const
+    {
+        return events_.size();
+    }
+
+    // Events waiting to be reused.
+    size_t available() const
+    {
+        return free_.size();
+    }
+
+private:
+    friend class Recycled<ze_event_handle_t, EventRecycler>;
+
+    ze_context_handle_t     context_;
+    ze_device_handle_t      device_;
+    uint32_t                eventsPerPool_;
+    ze_event_pool_flags_t   poolFlags_;
+
+    std::vector<ze_event_pool_handle_t> pools_;
+    std::vector<ze_event_handle_t>      events_;
+    std::vector<ze_event_handle_t>      free_;
+
+    void grow()
+    {
+        ze_event_pool_desc_t eventPoolDesc = {};
+        eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+        eventPoolDesc.flags = poolFlags_;
+        eventPoolDesc.count = eventsPerPool_;
+
+        ze_event_pool_handle_t pool = nullptr;
+        if (zeEventPoolCreate(context_, &eventPoolDesc, 1, &device_, &pool) != ZE_RESULT_SUCCESS) {
+            return;
+        }
+        pools_.push_back(pool);
+
+        for (uint32_t i = 0; i < eventsPerPool_; i++) {
+            ze_event_desc_t eventDesc = {};
+            eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+            eventDesc.index = i;
+            eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+            eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+            ze_event_handle_t event = nullptr;
+            if (zeEventCreate(pool, &eventDesc, &event) == ZE_RESULT_SUCCESS) {
+                events_.push_back(event);
+                free_.push_back(event);
+            }
+        }
+    }
+
+    void recycle(
+        ze_event_handle_t event )
+    {
+        zeEventHostReset(event);
+        free_.push_back(event);
+    }
+};
+
+} // namespace lzutil
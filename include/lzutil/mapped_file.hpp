@@ -0,0 +1,209 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lzutil {
+
+// A file mapped into the address space of the process.
+//
+// Pages are read from and written back to the file by the operating system on
+// demand, so a mapping may be much larger than device memory, or even than
+// physical memory.  Writable mappings are shared, so stores are visible in the
+// file once the mapping is flushed or closed.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps an existing file.  Returns false if the file cannot be opened or
+    // mapped, or is empty.
+    bool open(
+        const std::string& path,
+        bool writable )
+    {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(),
+            writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+            FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize = {};
+        if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &fileSize)) {
+            close();
+            return false;
+        }
+        return map((size_t)fileSize.QuadPart, writable);
+#else
+        fd_ = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        struct stat st = {};
+        if (fd_ < 0 || fstat(fd_, &st) != 0) {
+            close();
+            return false;
+        }
+        return map((size_t)st.st_size, writable);
+#endif
+    }
+
+    // Creates or truncates a file of the given size and maps it writable.
+    bool create(
+        const std::string& path,
+        size_t size )
+    {
+        close();
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize = {};
+        fileSize.QuadPart = (LONGLONG)size;
+        if (file_ == INVALID_HANDLE_VALUE ||
+            !SetFilePointerEx(file_, fileSize, nullptr, FILE_BEGIN) ||
+            !SetEndOfFile(file_)) {
+            close();
+            return false;
+        }
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0 || ftruncate(fd_, (off_t)size) != 0) {
+            close();
+            return false;
+        }
+#endif
+        return map(size, true);
+    }
+
+    // Writes modified pages back to the file.
+    bool flush()
+    {
+        if (data_ == nullptr || !writable_) {
+            return data_ != nullptr;
+        }
+#if defined(_WIN32)
+        return FlushViewOfFile(data_, 0) && FlushFileBuffers(file_);
+#else
+        return msync(data_, size_, MS_SYNC) == 0;
+#endif
+    }
+
+    void close()
+    {
+#if defined(_WIN32)
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) {
+            munmap(data_, size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        writable_ = false;
+    }
+
+    void* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE  file_ = INVALID_HANDLE_VALUE;
+    HANDLE  mapping_ = nullptr;
+#else
+    int     fd_ = -1;
+#endif
+    void*   data_ = nullptr;
+    size_t  size_ = 0;
+    bool    writable_ = false;
+
+    bool map(
+        size_t size,
+        bool writable )
+    {
+        if (size == 0) {
+            close();
+            return false;
+        }
+#if defined(_WIN32)
+        mapping_ = CreateFileMappingA(file_, nullptr,
+            writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) {
+            data_ = MapViewOfFile(mapping_,
+                writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+        }
+#else
+        void* data = mmap(nullptr, size,
+            writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd_, 0);
+        data_ = (data == MAP_FAILED) ? nullptr : data;
+#endif
+        if (data_ == nullptr) {
+            close();
+            return false;
+        }
+        size_ = size;
+        writable_ = writable;
+        return true;
+    }
+};
+
+} // namespace lzutil
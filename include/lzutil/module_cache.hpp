@@ -0,0 +1,238 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ze_api.h"
+#include "lzutil/file_util.hpp"
+
+namespace lzutil {
+
+// Builds modules from SPIR-V and caches the resulting native binaries on disk.
+//
+// Cache entries are keyed by a hash of the SPIR-V, a hash of the build flags,
+// the device UUID, and the driver version, so a driver update or a different
+// device never picks up a stale binary.  Entries are written to a temporary
+// file and renamed into place, so many processes may share one cache
+// directory.  If a cached binary is rejected by the driver the module is
+// rebuilt from SPIR-V and the entry is replaced.
+class ModuleCache
+{
+public:
+    explicit ModuleCache(
+        const std::string& cacheDir ) :
+        cacheDir_(cacheDir)
+    {
+        if (!cacheDir_.empty()) {
+            makeDirectory(cacheDir_);
+        }
+    }
+
+    const std::string& cacheDir() const { return cacheDir_; }
+
+    static uint64_t hash(
+        const void* data,
+        size_t size,
+        uint64_t h = 0xcbf29ce484222325ULL )
+    {
+        // 64-bit FNV-1a
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            h ^= bytes[i];
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // Returns the path of the cache entry for the given module and device.
+    std::string getCachePath(
+        ze_driver_handle_t driver,
+        ze_device_handle_t device,
+        const uint8_t* spirv,
+        size_t spirvSize,
+        const char* buildFlags ) const
+    {
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        ze_device_properties_t deviceProps = {};
+        deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+        zeDeviceGetProperties(device, &deviceProps);
+
+        const std::string flags = buildFlags ? buildFlags : "";
+
+        char name[128];
+        snprintf(name, sizeof(name), "%016llx-%016llx-",
+            (unsigned long long)hash(spirv, spirvSize),
+            (unsigned long long)hash(flags.data(), flags.size()));
+
+        std::string path = cacheDir_;
+        if (!path.empty()) {
+            path += "/";
+        }
+        path += name;
+        for (auto b : deviceProps.uuid.id) {
+            char hex[3];
+            snprintf(hex, sizeof(hex), "%02x", b);
+            path += hex;
+        }
+        path += "-";
+        path += std::to_string(driverProps.driverVersion);
+        path += ".bin";
+
+        return path;
+    }
+
+    // Creates a module, loading the native binary from the cache if possible.
+    // cacheHit is set to true if the module was created from a cached binary.
+    ze_result_t createModule(
+        ze_driver_handle_t driver,
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        const uint8_t* spirv,
+        size_t spirvSize,
+        const char* buildFlags,
+        ze_module_handle_t* phModule,
+        ze_module_build_log_handle_t* phBuildLog = nullptr,
+        bool* cacheHit = nullptr )
+    {
+        if (cacheHit) {
+            *cacheHit = false;
+        }
+        if (phBuildLog) {
+            *phBuildLog = nullptr;
+        }
+
+        const std::string path = getCachePath(driver, device, spirv, spirvSize, buildFlags);
+
+        std::vector<uint8_t> native;
+        if (readFile(path, native)) {
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_NATIVE;
+            moduleDesc.inputSize = native.size();
+            moduleDesc.pInputModule = native.data();
+
+            ze_result_t result = zeModuleCreate(context, device, &moduleDesc, phModule, nullptr);
+            if (result == ZE_RESULT_SUCCESS) {
+                if (cacheHit) {
+                    *cacheHit = true;
+                }
+                return result;
+            }
+        }
+
+        ze_module_desc_t moduleDesc = {};
+        moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+        moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+        moduleDesc.inputSize = spirvSize;
+        moduleDesc.pInputModule = spirv;
+        moduleDesc.pBuildFlags = buildFlags;
+
+        ze_result_t result = zeModuleCreate(context, device, &moduleDesc, phModule, phBuildLog);
+        if (result != ZE_RESULT_SUCCESS) {
+            return result;
+        }
+
+        size_t nativeSize = 0;
+        if (zeModuleGetNativeBinary(*phModule, &nativeSize, nullptr) == ZE_RESULT_SUCCESS &&
+            nativeSize != 0) {
+            native.resize(nativeSize);
+            if (zeModuleGetNativeBinary(*phModule, &nativeSize, native.data()) == ZE_RESULT_SUCCESS) {
+                writeFile(path, native);
+            }
+        }
+
+        return result;
+    }
+
+    // Removes the cache entry for the given module and device, if any.
+    bool evict(
+        ze_driver_handle_t driver,
+        ze_device_handle_t device,
+        const uint8_t* spirv,
+        size_t spirvSize,
+        const char* buildFlags ) const
+    {
+        const std::string path = getCachePath(driver, device, spirv, spirvSize, buildFlags);
+        return remove(path.c_str()) == 0;
+    }
+
+private:
+    std::string cacheDir_;
+
+    static bool readFile(
+        const std::string& path,
+        std::vector<uint8_t>& data )
+    {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            return false;
+        }
+
+        bool ok = false;
+        if (fseek(fp, 0, SEEK_END) == 0) {
+            long size = ftell(fp);
+            if (size > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+                data.resize(size);
+                ok = fread(data.data(), 1, data.size(), fp) == data.size();
+            }
+        }
+
+        fclose(fp);
+        return ok;
+    }
+
+    static bool writeFile(
+        const std::string& path,
+        const std::vector<uint8_t>& data )
+    {
+        std::random_device rd;
+        const std::string tempPath = path + "." + std::to_string(rd()) + ".tmp";
+
+        FILE* fp = fopen(tempPath.c_str(), "wb");
+        if (fp == nullptr) {
+            return false;
+        }
+
+        bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+        ok = (fclose(fp) == 0) && ok;
+
+        // Replaces an existing entry, e.g. one the driver rejected.
+        if (ok && !replaceFile(tempPath, path)) {
+            ok = false;
+        }
+        if (!ok) {
+            remove(tempPath.c_str());
+        }
+        return ok;
+    }
+};
+
+} // namespace lzutil
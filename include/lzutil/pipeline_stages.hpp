@@ -0,0 +1,269 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// Queues for a three-stage upload / compute / download pipeline.  Uploads and
+// downloads go to copy-only engines when the device has them, preferably two
+// different ones, and to the compute engine otherwise.
+struct PipelineQueues
+{
+    uint32_t    computeOrdinal = UINT32_MAX;
+    uint32_t    copyOrdinal = UINT32_MAX;
+    uint32_t    uploadIndex = 0;
+    uint32_t    downloadIndex = 0;
+
+    // Returns false if the device has no compute queue group.
+    bool find(
+        ze_device_handle_t device )
+    {
+        uint32_t groupCount = 0;
+        zeDeviceGetCommandQueueGroupProperties(device, &groupCount, nullptr);
+
+        std::vector<ze_command_queue_group_properties_t> groups(groupCount);
+        for (auto& group : groups) {
+            group.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+        }
+        zeDeviceGetCommandQueueGroupProperties(device, &groupCount, groups.data());
+
+        computeOrdinal = UINT32_MAX;
+        copyOrdinal = UINT32_MAX;
+        for (uint32_t ordinal = 0; ordinal < groupCount; ordinal++) {
+            const auto flags = groups[ordinal].flags;
+            if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) {
+                if (computeOrdinal == UINT32_MAX) {
+                    computeOrdinal = ordinal;
+                }
+            } else if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) {
+                if (copyOrdinal == UINT32_MAX) {
+                    copyOrdinal = ordinal;
+                }
+            }
+        }
+        if (computeOrdinal == UINT32_MAX) {
+            return false;
+        }
+        if (copyOrdinal == UINT32_MAX) {
+            copyOrdinal = computeOrdinal;
+        }
+        uploadIndex = 0;
+        downloadIndex = std::min<uint32_t>(1, groups[copyOrdinal].numQueues - 1);
+        return true;
+    }
+
+    // Creates an immediate command list for each stage.
+    ze_result_t createCommandLists(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        ze_command_list_handle_t* upload,
+        ze_command_list_handle_t* compute,
+        ze_command_list_handle_t* download ) const
+    {
+        ze_command_queue_desc_t queueDesc = {};
+        queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+        queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+        queueDesc.ordinal = copyOrdinal;
+        queueDesc.index = uploadIndex;
+        ze_result_t result = zeCommandListCreateImmediate(context, device, &queueDesc, upload);
+
+        if (result == ZE_RESULT_SUCCESS) {
+            queueDesc.ordinal = computeOrdinal;
+            queueDesc.index = 0;
+            result = zeCommandListCreateImmediate(context, device, &queueDesc, compute);
+        }
+
+        if (result == ZE_RESULT_SUCCESS) {
+            queueDesc.ordinal = copyOrdinal;
+            queueDesc.index = downloadIndex;
+            result = zeCommandListCreateImmediate(context, device, &queueDesc, download);
+        }
+        return result;
+    }
+};
+
+// The events that order a three-stage pipeline over depth device slots.  A
+// chunk in slot s flows through the three command lists:
+//
+//   upload:   wait downloaded(s) (previous chunk in s), copy in, signal uploaded(s)
+//   compute:  wait uploaded(s), process, signal computed(s)
+//   download: wait computed(s), copy out, signal downloaded(s)
+//
+// Each event is reset on the device by its only consumer, so the host never
+// has to wait until the whole stream is done.  The consumer resets the event
+// before it signals its own event, see consume(): the producer cannot signal
+// the event for the next chunk in the slot until then, so the reset cannot
+// clobber it.
+class PipelineEvents
+{
+public:
+    PipelineEvents(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        uint32_t depth ) :
+        depth_(depth)
+    {
+        const uint32_t count = 3 * depth_ + 3;
+
+        ze_event_pool_desc_t eventPoolDesc = {};
+        eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+        eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+        eventPoolDesc.count = count;
+
+        if (zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &pool_) != ZE_RESULT_SUCCESS) {
+            pool_ = nullptr;
+            return;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            ze_event_desc_t eventDesc = {};
+            eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+            eventDesc.index = i;
+            eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+            eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+            ze_event_handle_t event = nullptr;
+            zeEventCreate(pool_, &eventDesc, &event);
+            events_.push_back(event);
+        }
+    }
+
+    ~PipelineEvents()
+    {
+        for (auto event : events_) {
+            if (event) {
+                zeEventDestroy(event);
+            }
+        }
+        if (pool_) {
+            zeEventPoolDestroy(pool_);
+        }
+    }
+
+    PipelineEvents(const PipelineEvents&) = delete;
+    PipelineEvents& operator=(const PipelineEvents&) = delete;
+
+    // Returns true if every event was created.
+    bool valid() const
+    {
+        return pool_ != nullptr &&
+            std::find(events_.begin(), events_.end(), nullptr) == events_.end();
+    }
+
+    uint32_t depth() const
+    {
+        return depth_;
+    }
+
+    ze_event_handle_t uploaded(
+        uint32_t s ) const
+    {
+        return events_[3 * s + 0];
+    }
+
+    ze_event_handle_t computed(
+        uint32_t s ) const
+    {
+        return events_[3 * s + 1];
+    }
+
+    ze_event_handle_t downloaded(
+        uint32_t s ) const
+    {
+        return events_[3 * s + 2];
+    }
+
+    // Appends a barrier after the commands that waited for consumed, the
+    // reset of consumed, and a barrier that signals produced.  The stage's
+    // work must be appended with no signal event.
+    static ze_result_t consume(
+        ze_command_list_handle_t cmdList,
+        ze_event_handle_t consumed,
+        ze_event_handle_t produced )
+    {
+        ze_result_t result = zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr);
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListAppendEventReset(cmdList, consumed);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListAppendBarrier(cmdList, produced, 0, nullptr);
+        }
+        return result;
+    }
+
+    // Waits for the three command lists, including their trailing event
+    // resets, and resets the downloaded events, which have no consumer once
+    // the stream ends.
+    ze_result_t drain(
+        ze_command_list_handle_t upload,
+        ze_command_list_handle_t compute,
+        ze_command_list_handle_t download )
+    {
+        const ze_command_list_handle_t cmdLists[] = { upload, compute, download };
+
+        ze_result_t result = ZE_RESULT_SUCCESS;
+        bool appended[3] = {};
+        for (uint32_t l = 0; l < 3; l++) {
+            const ze_result_t r = zeCommandListAppendBarrier(cmdLists[l], drained(l), 0, nullptr);
+            appended[l] = r == ZE_RESULT_SUCCESS;
+            if (result == ZE_RESULT_SUCCESS) {
+                result = r;
+            }
+        }
+        for (uint32_t l = 0; l < 3; l++) {
+            if (appended[l]) {
+                const ze_result_t r = zeEventHostSynchronize(drained(l), UINT64_MAX);
+                if (result == ZE_RESULT_SUCCESS) {
+                    result = r;
+                }
+            }
+            zeEventHostReset(drained(l));
+        }
+        for (uint32_t s = 0; s < depth_; s++) {
+            zeEventHostReset(downloaded(s));
+        }
+        return result;
+    }
+
+private:
+    uint32_t                        depth_ = 0;
+    ze_event_pool_handle_t          pool_ = nullptr;
+    // Per slot: uploaded, computed, downloaded.  Then one drained event per
+    // command list.
+    std::vector<ze_event_handle_t>  events_;
+
+    ze_event_handle_t drained(
+        uint32_t l ) const
+    {
+        return events_[3 * depth_ + l];
+    }
+};
+
+} // namespace lzutil
@@ -0,0 +1,135 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace lzutil {
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void process(global float* buf, uint n)
+//   {
+//       size_t gid = get_global_id(0);
+//       float x = buf[gid];
+//       for (uint i = 0; i < n; i++) {
+//           x = fma(x, 0.999f, 0.001f);
+//       }
+//       buf[gid] = x;
+//   }
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   %ext = OpExtInstImport "OpenCL.std"
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %process "process" %gid_var
+//   OpDecorate %gid_var BuiltIn GlobalInvocationId
+//   OpDecorate %gid_var Constant
+//   %void = OpTypeVoid
+//   %bool = OpTypeBool
+//   %uint = OpTypeInt 32 0
+//   %ulong = OpTypeInt 64 0
+//   %float = OpTypeFloat 32
+//   %v3ulong = OpTypeVector %ulong 3
+//   %ptr_in = OpTypePointer Input %v3ulong
+//   %ptr = OpTypePointer CrossWorkgroup %float
+//   %fnty = OpTypeFunction %void %ptr %uint
+//   %c0 = OpConstant %uint 0
+//   %c1 = OpConstant %uint 1
+//   %fa = OpConstant %float 0.999
+//   %fb = OpConstant %float 0.001
+//   %gid_var = OpVariable %ptr_in Input
+//   %process = OpFunction %void None %fnty
+//   %buf = OpFunctionParameter %ptr
+//   %n = OpFunctionParameter %uint
+//   %entry = OpLabel
+//   %gid3 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gid = OpCompositeExtract %ulong %gid3 0
+//   %addr = OpInBoundsPtrAccessChain %ptr %buf %gid
+//   %x = OpLoad %float %addr Aligned 4
+//   OpBranch %header
+//   %header = OpLabel
+//   %i = OpPhi %uint %c0 %entry %inext %body
+//   %a = OpPhi %float %x %entry %b %body
+//   %cond = OpULessThan %bool %i %n
+//   OpBranchConditional %cond %body %exit
+//   %body = OpLabel
+//   %b = OpExtInst %float %ext 26 %a %fa %fb
+//   %inext = OpIAdd %uint %i %c1
+//   OpBranch %header
+//   %exit = OpLabel
+//   OpStore %addr %a Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t processKernelSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000020, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0005000B, 0x00000001, 0x6E65704F, 0x732E4C43, 0x00006474,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0006000F, 0x00000006, 0x00000010, 0x636F7270, 0x00737365, 0x0000000F,
+    0x00040047, 0x0000000F, 0x0000000B, 0x0000001C,
+    0x00030047, 0x0000000F, 0x00000016,
+    0x00020013, 0x00000002,
+    0x00020014, 0x00000003,
+    0x00040015, 0x00000004, 0x00000020, 0x00000000,
+    0x00040015, 0x00000005, 0x00000040, 0x00000000,
+    0x00030016, 0x00000006, 0x00000020,
+    0x00040017, 0x00000007, 0x00000005, 0x00000003,
+    0x00040020, 0x00000008, 0x00000001, 0x00000007,
+    0x00040020, 0x00000009, 0x00000005, 0x00000006,
+    0x00050021, 0x0000000A, 0x00000002, 0x00000009, 0x00000004,
+    0x0004002B, 0x00000004, 0x0000000B, 0x00000000,
+    0x0004002B, 0x00000004, 0x0000000C, 0x00000001,
+    0x0004002B, 0x00000006, 0x0000000D, 0x3F7FBE77,
+    0x0004002B, 0x00000006, 0x0000000E, 0x3A83126F,
+    0x0004003B, 0x00000008, 0x0000000F, 0x00000001,
+    0x00050036, 0x00000002, 0x00000010, 0x00000000, 0x0000000A,
+    0x00030037, 0x00000009, 0x00000011,
+    0x00030037, 0x00000004, 0x00000012,
+    0x000200F8, 0x00000013,
+    0x0006003D, 0x00000007, 0x00000014, 0x0000000F, 0x00000002, 0x00000020,
+    0x00050051, 0x00000005, 0x00000015, 0x00000014, 0x00000000,
+    0x00050046, 0x00000009, 0x00000016, 0x00000011, 0x00000015,
+    0x0006003D, 0x00000006, 0x00000017, 0x00000016, 0x00000002, 0x00000004,
+    0x000200F9, 0x00000018,
+    0x000200F8, 0x00000018,
+    0x000700F5, 0x00000004, 0x00000019, 0x0000000B, 0x00000013, 0x0000001E, 0x0000001C,
+    0x000700F5, 0x00000006, 0x0000001A, 0x00000017, 0x00000013, 0x0000001D, 0x0000001C,
+    0x000500B0, 0x00000003, 0x0000001B, 0x00000019, 0x00000012,
+    0x000400FA, 0x0000001B, 0x0000001C, 0x0000001F,
+    0x000200F8, 0x0000001C,
+    0x0008000C, 0x00000006, 0x0000001D, 0x00000001, 0x0000001A, 0x0000001A, 0x0000000D, 0x0000000E,
+    0x00050080, 0x00000004, 0x0000001E, 0x00000019, 0x0000000C,
+    0x000200F9, 0x00000018,
+    0x000200F8, 0x0000001F,
+    0x0005003E, 0x00000016, 0x0000001A, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char processKernelName[] = "process";
+
+} // namespace lzutil
@@ -0,0 +1,385 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+// This header requires C++20 coroutines.  Samples that use it request
+// CXX_STANDARD 20 in add_level_zero_sample.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "ze_api.h"
+
+#include "handles.hpp"
+
+namespace lzutil {
+
+class Reactor;
+
+// A coroutine run by a Reactor.  A task does not start until it is given to
+// Reactor::spawn, and the reactor destroys it when it finishes.
+class Task
+{
+public:
+    struct promise_type {
+        std::exception_ptr exception;
+
+        Task get_return_object()
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept :
+        handle_(std::exchange(other.handle_, nullptr)) {}
+
+    ~Task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+
+private:
+    friend class Reactor;
+
+    explicit Task(
+        Handle handle ) :
+        handle_(handle) {}
+
+    Handle release()
+    {
+        return std::exchange(handle_, nullptr);
+    }
+
+    Handle handle_;
+};
+
+// An awaitable device operation.  Awaiting it suspends the task until the
+// operation's event is signaled, and returns the result of appending the
+// operation.  Operations must be awaited by a Task; an operation that is
+// destroyed without being awaited waits for its event on the host.
+class Operation
+{
+public:
+    // Waits for an event owned by the caller.
+    Operation(
+        Reactor* reactor,
+        ze_event_handle_t event,
+        ze_result_t result ) :
+        reactor_(reactor),
+        event_(event),
+        result_(result) {}
+
+    // Waits for an event borrowed from the reactor, which is returned to the
+    // reactor once the operation completes.
+    Operation(
+        Reactor* reactor,
+        EventRecycler::Handle&& owned,
+        ze_result_t result ) :
+        reactor_(reactor),
+        event_(owned.get()),
+        owned_(std::move(owned)),
+        result_(result) {}
+
+    Operation(Operation&& other) noexcept :
+        reactor_(other.reactor_),
+        event_(std::exchange(other.event_, nullptr)),
+        owned_(std::move(other.owned_)),
+        result_(other.result_) {}
+
+    inline ~Operation();
+
+    Operation(const Operation&) = delete;
+    Operation& operator=(const Operation&) = delete;
+    Operation& operator=(Operation&&) = delete;
+
+    bool await_ready() const
+    {
+        return result_ != ZE_RESULT_SUCCESS ||
+            zeEventQueryStatus(event_) == ZE_RESULT_SUCCESS;
+    }
+
+    inline void await_suspend(
+        Task::Handle handle );
+
+    inline ze_result_t await_resume();
+
+private:
+    Reactor*                reactor_;
+    ze_event_handle_t       event_;
+    EventRecycler::Handle   owned_;
+    ze_result_t             result_;
+};
+
+// A single-threaded reactor that resumes tasks as their device operations
+// complete.
+//
+// Each operation appended through the reactor signals an event taken from an
+// EventRecycler, which grows by one event pool at a time, so any number of
+// operations may be in flight.  run() polls the events that tasks are waiting
+// for and resumes the tasks whose events have signaled, so one thread can
+// drive thousands of in-flight operations.  When no event has signaled the
+// reactor spins, or blocks on the oldest event for up to blockSliceNs.
+//
+// Operations are appended to caller-supplied command lists, which should be
+// immediate command lists so the operations start without further
+// submission.
+class Reactor
+{
+public:
+    struct Options {
+        // Events per event pool.
+        uint32_t    eventsPerPool = 256;
+        // Time to block on the oldest event when a sweep finds nothing to
+        // resume, or zero to spin.
+        uint64_t    blockSliceNs = 0;
+    };
+
+    Reactor(
+        ze_context_handle_t context,
+        ze_device_handle_t device ) :
+        Reactor(context, device, Options()) {}
+
+    Reactor(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        const Options& options ) :
+        options_(options),
+        events_(context, device, options.eventsPerPool) {}
+
+    // Tasks that are still waiting are destroyed once their events signal.
+    ~Reactor()
+    {
+        std::vector<Waiter> waiters;
+        waiters.swap(waiters_);
+        for (auto& waiter : waiters) {
+            zeEventHostSynchronize(waiter.event, UINT64_MAX);
+            waiter.handle.destroy();
+        }
+    }
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // Appends an operation with append, which is called with the event the
+    // operation must signal.
+    template <typename Append>
+    Operation submit(
+        Append&& append )
+    {
+        EventRecycler::Handle event = events_.acquire();
+        if (!event) {
+            return Operation(this, nullptr, ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY);
+        }
+        const ze_result_t result = append(event.get());
+        return Operation(this, std::move(event), result);
+    }
+
+    Operation copy(
+        ze_command_list_handle_t cmdList,
+        void* dst,
+        const void* src,
+        size_t size,
+        uint32_t numWaitEvents = 0,
+        ze_event_handle_t* waitEvents = nullptr )
+    {
+        return submit([&](ze_event_handle_t event) {
+            return zeCommandListAppendMemoryCopy(cmdList, dst, src, size,
+                event, numWaitEvents, waitEvents);
+        });
+    }
+
+    Operation launch(
+        ze_command_list_handle_t cmdList,
+        ze_kernel_handle_t kernel,
+        const ze_group_count_t& groupCount,
+        uint32_t numWaitEvents = 0,
+        ze_event_handle_t* waitEvents = nullptr )
+    {
+        return submit([&](ze_event_handle_t event) {
+            return zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+                event, numWaitEvents, waitEvents);
+        });
+    }
+
+    // Waits for an event owned by the caller.  The event is not reset.
+    Operation wait(
+        ze_event_handle_t event )
+    {
+        return Operation(this, event,
+            event ? ZE_RESULT_SUCCESS : ZE_RESULT_ERROR_INVALID_NULL_HANDLE);
+    }
+
+    // Starts a task.  It runs until its first suspension before this returns.
+    void spawn(
+        Task task )
+    {
+        Task::Handle handle = task.release();
+        if (handle) {
+            tasks_++;
+            resume(handle);
+        }
+    }
+
+    // Resumes every task whose event has signaled, and returns how many
+    // tasks were resumed.
+    size_t poll()
+    {
+        // Compacts in place rather than swap-removing, so waiters_ stays in
+        // the order the tasks parked and front() is the oldest waiter.
+        size_t waiting = 0;
+        for (size_t i = 0; i < waiters_.size(); i++) {
+            if (zeEventQueryStatus(waiters_[i].event) == ZE_RESULT_SUCCESS) {
+                ready_.push_back(waiters_[i].handle);
+            } else {
+                waiters_[waiting++] = waiters_[i];
+            }
+        }
+        waiters_.resize(waiting);
+
+        // Resumed tasks add new waiters, so resume after the sweep.
+        const size_t resumed = ready_.size();
+        for (size_t i = 0; i < resumed; i++) {
+            resume(ready_[i]);
+        }
+        ready_.clear();
+        return resumed;
+    }
+
+    // Runs until every task has finished, then rethrows the first exception
+    // thrown by a task, if any.
+    void run()
+    {
+        while (!waiters_.empty()) {
+            if (poll() == 0 && options_.blockSliceNs && !waiters_.empty()) {
+                zeEventHostSynchronize(waiters_.front().event, options_.blockSliceNs);
+            }
+        }
+        if (exception_) {
+            std::rethrow_exception(std::exchange(exception_, nullptr));
+        }
+    }
+
+    // Tasks that have been spawned and have not finished.
+    size_t tasks() const
+    {
+        return tasks_;
+    }
+
+    // Most tasks waiting for an event at once.
+    size_t maxWaiting() const
+    {
+        return maxWaiting_;
+    }
+
+    // Events created, in use or free.
+    size_t events() const
+    {
+        return events_.created();
+    }
+
+private:
+    friend class Operation;
+
+    struct Waiter {
+        ze_event_handle_t   event;
+        Task::Handle        handle;
+    };
+
+    Options         options_;
+    EventRecycler   events_;
+
+    std::vector<Waiter>         waiters_;
+    std::vector<Task::Handle>   ready_;
+    size_t                      tasks_ = 0;
+    size_t                      maxWaiting_ = 0;
+    std::exception_ptr          exception_;
+
+    void park(
+        ze_event_handle_t event,
+        Task::Handle handle )
+    {
+        waiters_.push_back({event, handle});
+        maxWaiting_ = std::max(maxWaiting_, waiters_.size());
+    }
+
+    void resume(
+        Task::Handle handle )
+    {
+        handle.resume();
+        if (handle.done()) {
+            if (handle.promise().exception && !exception_) {
+                exception_ = handle.promise().exception;
+            }
+            handle.destroy();
+            tasks_--;
+        }
+    }
+};
+
+inline Operation::~Operation()
+{
+    if (owned_ && result_ == ZE_RESULT_SUCCESS) {
+        zeEventHostSynchronize(owned_.get(), UINT64_MAX);
+    }
+}
+
+inline void Operation::await_suspend(
+    Task::Handle handle )
+{
+    reactor_->park(event_, handle);
+}
+
+inline ze_result_t Operation::await_resume()
+{
+    owned_.reset();
+    event_ = nullptr;
+    return result_;
+}
+
+} // namespace lzutil
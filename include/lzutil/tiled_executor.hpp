@@ -0,0 +1,394 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "ze_api.h"
+#include "zes_api.h"
+#include "lzutil/pipeline_stages.hpp"
+
+namespace lzutil {
+
+// Streams a dataset that may not fit in device memory through a bounded set
+// of device tiles.
+//
+// The executor keeps depth tiles resident on the device.  Each tile is
+// uploaded on a copy engine, processed by a caller-supplied function on the
+// compute engine, and downloaded on a copy engine, and the three stages of
+// different tiles overlap.  The source and destination may be any host
+// memory, including a memory-mapped file, so the dataset is bounded by the
+// address space rather than by device or physical memory.
+//
+// The tile size is derived from the free device memory reported by Sysman
+// (zesMemoryGetState), and is re-evaluated while streaming so the executor
+// backs off when other work needs device memory and grows again when it is
+// released.  Sysman must be enabled with ZES_ENABLE_SYSMAN=1 before zeInit.
+// Without Sysman the executor assumes it is the only user of device memory.
+class TiledExecutor
+{
+public:
+    struct Options
+    {
+        // Fraction of the free device memory the resident tiles may use.
+        double      residencyFraction = 0.5;
+        size_t      minTileBytes = 1024 * 1024;
+        size_t      maxTileBytes = 256 * 1024 * 1024;
+        // Tile sizes and offsets are multiples of this.
+        size_t      tileAlignment = 64 * 1024;
+        // Number of tiles resident on the device.
+        uint32_t    depth = 3;
+        // Re-evaluate the tile size every this many tiles, or never if zero.
+        uint32_t    requeryTiles = 16;
+    };
+
+    // Appends the work for one tile to cmdList.  The tile holds bytes bytes
+    // of the dataset starting at offset.  Commands appended by the function
+    // run after the tile is uploaded and before it is downloaded.
+    using TileFunction = std::function<void(
+        ze_command_list_handle_t cmdList,
+        void* tile,
+        size_t offset,
+        size_t bytes)>;
+
+    TiledExecutor(
+        ze_context_handle_t context,
+        ze_device_handle_t device ) :
+        TiledExecutor(context, device, Options()) {}
+
+    TiledExecutor(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        const Options& options ) :
+        context_(context),
+        device_(device),
+        options_(options),
+        events_(context, device, std::max<uint32_t>(options.depth, 1))
+    {
+        options_.depth = std::max<uint32_t>(options_.depth, 1);
+        options_.tileAlignment = std::max<size_t>(options_.tileAlignment, 1);
+        options_.minTileBytes = alignDown(
+            std::max(options_.minTileBytes, options_.tileAlignment));
+        options_.maxTileBytes = alignDown(
+            std::max(options_.maxTileBytes, options_.minTileBytes));
+
+        PipelineQueues queues;
+        if (queues.find(device_)) {
+            queues.createCommandLists(context_, device_, &upload_, &compute_, &download_);
+        }
+        findMemoryModules();
+    }
+
+    ~TiledExecutor()
+    {
+        release();
+        for (auto cmdList : { upload_, compute_, download_ }) {
+            if (cmdList) {
+                zeCommandListDestroy(cmdList);
+            }
+        }
+    }
+
+    TiledExecutor(const TiledExecutor&) = delete;
+    TiledExecutor& operator=(const TiledExecutor&) = delete;
+
+    // Returns the free and total device memory, in bytes.
+    void queryMemory(
+        uint64_t& freeBytes,
+        uint64_t& totalBytes ) const
+    {
+        freeBytes = 0;
+        totalBytes = 0;
+        for (auto memory : memories_) {
+            zes_mem_state_t memState = {};
+            memState.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
+            if (zesMemoryGetState(memory, &memState) == ZE_RESULT_SUCCESS) {
+                freeBytes += memState.free;
+                totalBytes += memState.size;
+            }
+        }
+        if (totalBytes == 0) {
+            totalBytes = capacity_;
+            freeBytes = capacity_ - std::min<uint64_t>(capacity_, residentBytes());
+        }
+    }
+
+    // Returns the tile size the executor would use right now.  Memory held
+    // by the executor's own tiles counts as available.
+    size_t chooseTileBytes() const
+    {
+        uint64_t freeBytes = 0;
+        uint64_t totalBytes = 0;
+        queryMemory(freeBytes, totalBytes);
+
+        const uint64_t available =
+            std::min<uint64_t>(freeBytes + residentBytes(), totalBytes);
+        const uint64_t budget = (uint64_t)(available * options_.residencyFraction);
+        const size_t tileBytes = alignDown((size_t)std::min<uint64_t>(
+            budget / options_.depth, SIZE_MAX));
+        return std::min(std::max(tileBytes, options_.minTileBytes),
+            options_.maxTileBytes);
+    }
+
+    // Processes size bytes from src into dst, tile by tile, and waits for
+    // completion.  src and dst may be the same memory.
+    ze_result_t run(
+        const void* src,
+        void* dst,
+        size_t size,
+        const TileFunction& fn )
+    {
+        if (!upload_ || !compute_ || !download_ || !events_.valid()) {
+            return ZE_RESULT_ERROR_UNINITIALIZED;
+        }
+
+        ze_result_t result = resize(chooseTileBytes());
+
+        size_t offset = 0;
+        uint32_t sinceDrain = 0;
+        for (uint64_t tile = 0; result == ZE_RESULT_SUCCESS && offset < size; tile++) {
+            if (tile > 0 && options_.requeryTiles && tile % options_.requeryTiles == 0) {
+                const size_t want = chooseTileBytes();
+                if (want < tileBytes_ / 4 * 3 || want > tileBytes_ / 2 * 3) {
+                    result = drain();
+                    sinceDrain = 0;
+                    if (result == ZE_RESULT_SUCCESS) {
+                        result = resize(want);
+                    }
+                    if (result != ZE_RESULT_SUCCESS) {
+                        break;
+                    }
+                }
+            }
+
+            const uint32_t s = sinceDrain % options_.depth;
+            const size_t bytes = std::min(tileBytes_, size - offset);
+
+            result = appendTile(s, sinceDrain >= options_.depth,
+                (const char*)src + offset, (char*)dst + offset, offset, bytes, fn);
+
+            offset += bytes;
+            sinceDrain++;
+            tiles_++;
+        }
+
+        const ze_result_t drainResult = drain();
+        return result != ZE_RESULT_SUCCESS ? result : drainResult;
+    }
+
+    // Frees the device tiles.  They are allocated again by the next run.
+    void release()
+    {
+        for (auto slot : slots_) {
+            zeMemFree(context_, slot);
+        }
+        slots_.clear();
+        tileBytes_ = 0;
+    }
+
+    size_t tileBytes() const
+    {
+        return tileBytes_;
+    }
+
+    uint64_t residentBytes() const
+    {
+        return (uint64_t)tileBytes_ * slots_.size();
+    }
+
+    uint64_t peakResidentBytes() const
+    {
+        return peakResidentBytes_;
+    }
+
+    uint64_t tiles() const
+    {
+        return tiles_;
+    }
+
+    uint32_t resizes() const
+    {
+        return resizes_;
+    }
+
+    bool hasSysman() const
+    {
+        return !memories_.empty();
+    }
+
+private:
+    ze_context_handle_t context_ = nullptr;
+    ze_device_handle_t  device_ = nullptr;
+    Options             options_;
+
+    ze_command_list_handle_t    upload_ = nullptr;
+    ze_command_list_handle_t    compute_ = nullptr;
+    ze_command_list_handle_t    download_ = nullptr;
+
+    PipelineEvents              events_;
+
+    std::vector<zes_mem_handle_t>   memories_;
+    uint64_t                        capacity_ = 0;
+
+    std::vector<void*>  slots_;
+    size_t              tileBytes_ = 0;
+    uint64_t            peakResidentBytes_ = 0;
+    uint64_t            tiles_ = 0;
+    uint32_t            resizes_ = 0;
+
+    size_t alignDown(
+        size_t bytes ) const
+    {
+        return bytes / options_.tileAlignment * options_.tileAlignment;
+    }
+
+    void findMemoryModules()
+    {
+        zes_device_handle_t sysmanDevice = (zes_device_handle_t)device_;
+
+        uint32_t memoryCount = 0;
+        if (zesDeviceEnumMemoryModules(sysmanDevice, &memoryCount, nullptr) == ZE_RESULT_SUCCESS &&
+            memoryCount > 0) {
+            std::vector<zes_mem_handle_t> memories(memoryCount);
+            zesDeviceEnumMemoryModules(sysmanDevice, &memoryCount, memories.data());
+
+            // System memory modules describe host memory, not device memory.
+            for (auto memory : memories) {
+                zes_mem_properties_t memProps = {};
+                memProps.stype = ZES_STRUCTURE_TYPE_MEM_PROPERTIES;
+                if (zesMemoryGetProperties(memory, &memProps) == ZE_RESULT_SUCCESS &&
+                    memProps.location == ZES_MEM_LOC_SYSTEM) {
+                    continue;
+                }
+                memories_.push_back(memory);
+            }
+        }
+
+        uint32_t count = 0;
+        zeDeviceGetMemoryProperties(device_, &count, nullptr);
+
+        std::vector<ze_device_memory_properties_t> memoryProps(count);
+        for (auto& props : memoryProps) {
+            props.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES;
+        }
+        zeDeviceGetMemoryProperties(device_, &count, memoryProps.data());
+
+        for (const auto& props : memoryProps) {
+            capacity_ += props.totalSize;
+        }
+    }
+
+    // Reallocates the tiles.  If an allocation fails the tile size is halved
+    // until the allocations succeed or the minimum tile size is reached.
+    ze_result_t resize(
+        size_t tileBytes )
+    {
+        if (tileBytes == tileBytes_ && !slots_.empty()) {
+            return ZE_RESULT_SUCCESS;
+        }
+        if (!slots_.empty()) {
+            resizes_++;
+        }
+        release();
+
+        ze_device_mem_alloc_desc_t deviceDesc = {};
+        deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+        ze_result_t result = ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY;
+        while (tileBytes >= options_.minTileBytes) {
+            result = ZE_RESULT_SUCCESS;
+            for (uint32_t s = 0; s < options_.depth && result == ZE_RESULT_SUCCESS; s++) {
+                void* slot = nullptr;
+                result = zeMemAllocDevice(context_, &deviceDesc, tileBytes, 0, device_, &slot);
+                if (result == ZE_RESULT_SUCCESS) {
+                    slots_.push_back(slot);
+                }
+            }
+            if (result == ZE_RESULT_SUCCESS) {
+                tileBytes_ = tileBytes;
+                peakResidentBytes_ = std::max(peakResidentBytes_, residentBytes());
+                break;
+            }
+            release();
+            tileBytes = alignDown(tileBytes / 2);
+        }
+        return result;
+    }
+
+    // Appends the upload, processing and download of one tile in slot s,
+    // ordered by the events as described at PipelineEvents.
+    ze_result_t appendTile(
+        uint32_t s,
+        bool slotInUse,
+        const void* src,
+        void* dst,
+        size_t offset,
+        size_t bytes,
+        const TileFunction& fn )
+    {
+        void* slot = slots_[s];
+        ze_event_handle_t slotFree = events_.downloaded(s);
+        ze_event_handle_t ready = events_.uploaded(s);
+        ze_event_handle_t done = events_.computed(s);
+
+        ze_result_t result = ZE_RESULT_SUCCESS;
+        if (slotInUse) {
+            result = zeCommandListAppendMemoryCopy(upload_, slot, src, bytes,
+                nullptr, 1, &slotFree);
+            if (result == ZE_RESULT_SUCCESS) {
+                result = PipelineEvents::consume(upload_, slotFree, ready);
+            }
+        } else {
+            result = zeCommandListAppendMemoryCopy(upload_, slot, src, bytes,
+                ready, 0, nullptr);
+        }
+
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListAppendBarrier(compute_, nullptr, 1, &ready);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            fn(compute_, slot, offset, bytes);
+            result = PipelineEvents::consume(compute_, ready, done);
+        }
+
+        if (result == ZE_RESULT_SUCCESS) {
+            result = zeCommandListAppendMemoryCopy(download_, dst, slot, bytes,
+                nullptr, 1, &done);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            result = PipelineEvents::consume(download_, done, slotFree);
+        }
+        return result;
+    }
+
+    ze_result_t drain()
+    {
+        return events_.drain(upload_, compute_, download_);
+    }
+};
+
+} // namespace lzutil
@@ -0,0 +1,281 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// Collects device execution times for appended commands using kernel
+// timestamp events.
+//
+// Call signal() to get an event for a named region and pass it as the signal
+// event when appending a kernel launch or copy.  After the commands have
+// completed, call collect() to read the timestamps, convert them to
+// nanoseconds, and recycle the events.  Durations are aggregated per region.
+class TimestampProfiler
+{
+public:
+    struct Record {
+        std::string name;
+        uint64_t    globalStart;    // device ticks
+        uint64_t    globalEnd;      // device ticks
+        double      durationNs;     // context (execution) time
+    };
+
+    struct Summary {
+        size_t  count;
+        double  minNs;
+        double  medianNs;
+        double  maxNs;
+        double  totalNs;
+    };
+
+    TimestampProfiler(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        uint32_t eventsPerPool = 256 ) :
+        context_(context),
+        device_(device),
+        eventsPerPool_(eventsPerPool ? eventsPerPool : 1),
+        nextIndex_(0)
+    {
+        // With the base device properties stype the timer resolution is
+        // reported in nanoseconds per tick.
+        ze_device_properties_t deviceProps = {};
+        deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+        zeDeviceGetProperties(device_, &deviceProps);
+
+        nsPerTick_ = deviceProps.timerResolution ?
+            (double)deviceProps.timerResolution :
+            1.0;
+        validBits_ = deviceProps.kernelTimestampValidBits;
+        tickMask_ = (validBits_ == 0 || validBits_ >= 64) ?
+            ~0ULL :
+            (1ULL << validBits_) - 1;
+    }
+
+    ~TimestampProfiler()
+    {
+        for (auto& p : pending_) {
+            zeEventDestroy(p.event);
+        }
+        for (auto event : freeEvents_) {
+            zeEventDestroy(event);
+        }
+        for (auto pool : pools_) {
+            zeEventPoolDestroy(pool);
+        }
+    }
+
+    TimestampProfiler(const TimestampProfiler&) = delete;
+    TimestampProfiler& operator=(const TimestampProfiler&) = delete;
+
+    double nsPerTick() const { return nsPerTick_; }
+    uint32_t validBits() const { return validBits_; }
+
+    // Returns a kernel timestamp event to signal from an appended command.
+    // The result is recorded under the given region name by collect().
+    ze_event_handle_t signal(
+        const std::string& name )
+    {
+        ze_event_handle_t event = getEvent();
+        if (event != nullptr) {
+            pending_.push_back(Pending{ name, event });
+        }
+        return event;
+    }
+
+    // Converts a pair of kernel timestamps to a tick count, accounting for
+    // the timestamp counter wrapping at kernelTimestampValidBits.
+    uint64_t elapsedTicks(
+        uint64_t start,
+        uint64_t end ) const
+    {
+        start &= tickMask_;
+        end &= tickMask_;
+        return (end >= start) ?
+            end - start :
+            (tickMask_ - start) + end + 1;
+    }
+
+    double ticksToNs(
+        uint64_t ticks ) const
+    {
+        return ticks * nsPerTick_;
+    }
+
+    // Reads all pending timestamps.  Events that have not completed are
+    // waited on.  Returns the number of records collected.
+    size_t collect()
+    {
+        size_t collected = 0;
+
+        for (auto& p : pending_) {
+            ze_result_t result = zeEventHostSynchronize(p.event, UINT64_MAX);
+
+            ze_kernel_timestamp_result_t ts = {};
+            if (result == ZE_RESULT_SUCCESS) {
+                result = zeEventQueryKernelTimestamp(p.event, &ts);
+            }
+            if (result == ZE_RESULT_SUCCESS) {
+                Record r;
+                r.name = p.name;
+                r.globalStart = ts.global.kernelStart;
+                r.globalEnd = ts.global.kernelEnd;
+                r.durationNs = ticksToNs(elapsedTicks(ts.context.kernelStart, ts.context.kernelEnd));
+
+                durations_[r.name].push_back(r.durationNs);
+                records_.push_back(r);
+                collected++;
+            }
+
+            zeEventHostReset(p.event);
+            freeEvents_.push_back(p.event);
+        }
+        pending_.clear();
+
+        return collected;
+    }
+
+    // Recycles pending events without reading them, e.g. when the commands
+    // that would have signaled them were never submitted.
+    void discard()
+    {
+        for (auto& p : pending_) {
+            zeEventHostReset(p.event);
+            freeEvents_.push_back(p.event);
+        }
+        pending_.clear();
+    }
+
+    const std::vector<Record>& records() const { return records_; }
+
+    void clear()
+    {
+        records_.clear();
+        durations_.clear();
+    }
+
+    std::map<std::string, Summary> summarize() const
+    {
+        std::map<std::string, Summary> ret;
+        for (auto& it : durations_) {
+            std::vector<double> sorted(it.second);
+            std::sort(sorted.begin(), sorted.end());
+
+            Summary s;
+            s.count = sorted.size();
+            s.minNs = sorted.front();
+            s.medianNs = sorted[sorted.size() / 2];
+            s.maxNs = sorted.back();
+            s.totalNs = 0.0;
+            for (auto d : sorted) {
+                s.totalNs += d;
+            }
+            ret[it.first] = s;
+        }
+        return ret;
+    }
+
+    void print(
+        FILE* fp = stdout ) const
+    {
+        fprintf(fp, "\t%-32s %8s %12s %12s %12s\n",
+            "Region", "Count", "Min (us)", "Median (us)", "Max (us)");
+        for (auto& it : summarize()) {
+            fprintf(fp, "\t%-32s %8zu %12.3f %12.3f %12.3f\n",
+                it.first.c_str(),
+                it.second.count,
+                it.second.minNs / 1000.0,
+                it.second.medianNs / 1000.0,
+                it.second.maxNs / 1000.0);
+        }
+    }
+
+private:
+    struct Pending {
+        std::string         name;
+        ze_event_handle_t   event;
+    };
+
+    ze_context_handle_t context_;
+    ze_device_handle_t  device_;
+    uint32_t    eventsPerPool_;
+    uint32_t    nextIndex_;
+
+    double      nsPerTick_;
+    uint32_t    validBits_;
+    uint64_t    tickMask_;
+
+    std::vector<ze_event_pool_handle_t> pools_;
+    std::vector<ze_event_handle_t>      freeEvents_;
+    std::vector<Pending>                pending_;
+
+    std::vector<Record> records_;
+    std::map<std::string, std::vector<double>> durations_;
+
+    ze_event_handle_t getEvent()
+    {
+        if (!freeEvents_.empty()) {
+            ze_event_handle_t event = freeEvents_.back();
+            freeEvents_.pop_back();
+            return event;
+        }
+
+        if (pools_.empty() || nextIndex_ == eventsPerPool_) {
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_KERNEL_TIMESTAMP | ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = eventsPerPool_;
+
+            ze_event_pool_handle_t pool = nullptr;
+            if (zeEventPoolCreate(context_, &eventPoolDesc, 1, &device_, &pool) != ZE_RESULT_SUCCESS) {
+                return nullptr;
+            }
+            pools_.push_back(pool);
+            nextIndex_ = 0;
+        }
+
+        ze_event_desc_t eventDesc = {};
+        eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+        eventDesc.index = nextIndex_++;
+        eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+        eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+        ze_event_handle_t event = nullptr;
+        if (zeEventCreate(pools_.back(), &eventDesc, &event) != ZE_RESULT_SUCCESS) {
+            return nullptr;
+        }
+        return event;
+    }
+};
+
+} // namespace lzutil
@@ -0,0 +1,335 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ze_api.h"
+
+namespace lzutil {
+
+// A simple sub-allocating pool for USM host, device, or shared allocations.
+//
+// The pool reserves large slabs from the driver and carves them into
+// power-of-two size classes.  Freed blocks are kept on a per-class free list
+// and are reused by later allocations of the same class, so the steady state
+// makes no driver calls.  Allocations larger than the largest size class are
+// passed through to the driver.
+//
+// The pool never returns slab memory to the driver until it is destroyed.
+class USMPool
+{
+public:
+    static const size_t minClassSize = 64;
+    static const size_t defaultSlabSize = 64 * 1024 * 1024;
+
+    // For device and shared pools the capacity defaults to capacityPercent of
+    // the total device memory reported by zeDeviceGetMemoryProperties.  Host
+    // pools are unbounded by default.
+    USMPool(
+        ze_context_handle_t context,
+        ze_device_handle_t device,
+        ze_memory_type_t type,
+        size_t slabSize = defaultSlabSize,
+        uint32_t capacityPercent = 75 ) :
+        context_(context),
+        device_(device),
+        type_(type),
+        slabSize_(slabSize),
+        capacity_(0),
+        reserved_(0),
+        inUse_(0),
+        slabOffset_(0)
+    {
+        if (device_ != nullptr && type_ != ZE_MEMORY_TYPE_HOST) {
+            capacity_ = getDeviceMemorySize(device_) / 100 * capacityPercent;
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            if (zeDeviceGetProperties(device_, &deviceProps) == ZE_RESULT_SUCCESS &&
+                deviceProps.maxMemAllocSize != 0 &&
+                slabSize_ > deviceProps.maxMemAllocSize) {
+                slabSize_ = (size_t)deviceProps.maxMemAllocSize;
+            }
+        }
+
+        size_t classSize = minClassSize;
+        while (classSize <= slabSize_ / 4) {
+            classSizes_.push_back(classSize);
+            classSize *= 2;
+        }
+        freeLists_.resize(classSizes_.size());
+    }
+
+    ~USMPool()
+    {
+        for (auto& it : largeAllocations_) {
+            zeMemFree(context_, it.first);
+        }
+        for (auto slab : slabs_) {
+            zeMemFree(context_, slab);
+        }
+    }
+
+    USMPool(const USMPool&) = delete;
+    USMPool& operator=(const USMPool&) = delete;
+
+    ze_result_t allocate(
+        size_t size,
+        void** pptr )
+    {
+        if (pptr == nullptr) {
+            return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+        }
+        *pptr = nullptr;
+        if (size == 0) {
+            return ZE_RESULT_ERROR_UNSUPPORTED_SIZE;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        const size_t classIndex = getClassIndex(size);
+        if (classIndex >= classSizes_.size()) {
+            return allocateLarge(size, pptr);
+        }
+
+        const size_t classSize = classSizes_[classIndex];
+        auto& freeList = freeLists_[classIndex];
+        if (freeList.empty()) {
+            ze_result_t result = carve(classIndex);
+            if (result != ZE_RESULT_SUCCESS) {
+                return result;
+            }
+        }
+
+        void* ptr = freeList.back();
+        freeList.pop_back();
+
+        liveAllocations_[ptr] = classIndex;
+        inUse_ += classSize;
+
+        *pptr = ptr;
+        return ZE_RESULT_SUCCESS;
+    }
+
+    ze_result_t free(
+        void* ptr )
+    {
+        if (ptr == nullptr) {
+            return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = liveAllocations_.find(ptr);
+        if (it != liveAllocations_.end()) {
+            const size_t classIndex = it->second;
+            liveAllocations_.erase(it);
+            freeLists_[classIndex].push_back(ptr);
+            inUse_ -= classSizes_[classIndex];
+            return ZE_RESULT_SUCCESS;
+        }
+
+        auto large = largeAllocations_.find(ptr);
+        if (large != largeAllocations_.end()) {
+            ze_result_t result = zeMemFree(context_, ptr);
+            reserved_ -= large->second;
+            inUse_ -= large->second;
+            largeAllocations_.erase(large);
+            return result;
+        }
+
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    ze_memory_type_t type() const { return type_; }
+    size_t slabSize() const { return slabSize_; }
+    size_t capacity() const { return capacity_; }
+    size_t bytesReserved() const { return reserved_; }
+    size_t bytesInUse() const { return inUse_; }
+
+    // Returns the total size of all memory modules reported for the device.
+    static uint64_t getDeviceMemorySize(
+        ze_device_handle_t device )
+    {
+        uint32_t count = 0;
+        zeDeviceGetMemoryProperties(device, &count, nullptr);
+
+        std::vector<ze_device_memory_properties_t> memProps(count);
+        for (auto& prop : memProps) {
+            prop.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES;
+        }
+        zeDeviceGetMemoryProperties(device, &count, memProps.data());
+
+        uint64_t totalSize = 0;
+        for (auto& prop : memProps) {
+            totalSize += prop.totalSize;
+        }
+        return totalSize;
+    }
+
+private:
+    ze_context_handle_t context_;
+    ze_device_handle_t  device_;
+    ze_memory_type_t    type_;
+    size_t  slabSize_;
+    size_t  capacity_;
+    size_t  reserved_;
+    size_t  inUse_;
+
+    std::mutex mutex_;
+
+    std::vector<size_t> classSizes_;
+    std::vector<std::vector<void*>> freeLists_;
+
+    std::vector<void*> slabs_;
+    size_t  slabOffset_;
+
+    std::unordered_map<void*, size_t> liveAllocations_;
+    std::unordered_map<void*, size_t> largeAllocations_;
+
+    size_t getClassIndex(
+        size_t size ) const
+    {
+        size_t classIndex = 0;
+        while (classIndex < classSizes_.size() && classSizes_[classIndex] < size) {
+            classIndex++;
+        }
+        return classIndex;
+    }
+
+    bool exceedsCapacity(
+        size_t size ) const
+    {
+        return capacity_ != 0 && reserved_ + size > capacity_;
+    }
+
+    ze_result_t driverAllocate(
+        size_t size,
+        void** pptr )
+    {
+        ze_device_mem_alloc_desc_t deviceDesc = {};
+        deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+        ze_host_mem_alloc_desc_t hostDesc = {};
+        hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+        switch (type_) {
+        case ZE_MEMORY_TYPE_HOST:
+            return zeMemAllocHost(context_, &hostDesc, size, 0, pptr);
+        case ZE_MEMORY_TYPE_DEVICE:
+            return zeMemAllocDevice(context_, &deviceDesc, size, 0, device_, pptr);
+        case ZE_MEMORY_TYPE_SHARED:
+            return zeMemAllocShared(context_, &deviceDesc, &hostDesc, size, 0, device_, pptr);
+        default:
+            return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+        }
+    }
+
+    ze_result_t allocateLarge(
+        size_t size,
+        void** pptr )
+    {
+        if (exceedsCapacity(size)) {
+            return type_ == ZE_MEMORY_TYPE_HOST ?
+                ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY :
+                ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        ze_result_t result = driverAllocate(size, pptr);
+        if (result == ZE_RESULT_SUCCESS) {
+            largeAllocations_[*pptr] = size;
+            reserved_ += size;
+            inUse_ += size;
+        }
+        return result;
+    }
+
+    // Carves a new block for the given size class from the current slab,
+    // reserving a new slab from the driver when the current slab is full.
+    // Alignment padding and the unused tail of a full slab are handed to the
+    // free lists of the smaller classes rather than abandoned.
+    ze_result_t carve(
+        size_t classIndex )
+    {
+        const size_t classSize = classSizes_[classIndex];
+
+        // Blocks are aligned to their size class relative to the start of
+        // the slab, since every class size is a power of two.
+        size_t offset = (slabOffset_ + classSize - 1) & ~(classSize - 1);
+
+        if (slabs_.empty() || offset + classSize > slabSize_) {
+            if (exceedsCapacity(slabSize_)) {
+                return type_ == ZE_MEMORY_TYPE_HOST ?
+                    ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY :
+                    ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY;
+            }
+
+            void* slab = nullptr;
+            ze_result_t result = driverAllocate(slabSize_, &slab);
+            if (result != ZE_RESULT_SUCCESS) {
+                return result;
+            }
+
+            if (!slabs_.empty()) {
+                recycle(slabOffset_, slabSize_);
+            }
+            slabs_.push_back(slab);
+            reserved_ += slabSize_;
+            offset = 0;
+        } else {
+            recycle(slabOffset_, offset);
+        }
+
+        char* base = static_cast<char*>(slabs_.back());
+        freeLists_[classIndex].push_back(base + offset);
+        slabOffset_ = offset + classSize;
+
+        return ZE_RESULT_SUCCESS;
+    }
+
+    // Splits the range [begin, end) of the current slab into the largest
+    // aligned size class blocks that fit and puts them on the free lists.
+    void recycle(
+        size_t begin,
+        size_t end )
+    {
+        char* base = static_cast<char*>(slabs_.back());
+        while (begin + minClassSize <= end) {
+            size_t classIndex = classSizes_.size() - 1;
+            while (classIndex > 0 &&
+                   ((begin & (classSizes_[classIndex] - 1)) != 0 ||
+                    begin + classSizes_[classIndex] > end)) {
+                classIndex--;
+            }
+            freeLists_[classIndex].push_back(base + begin);
+            begin += classSizes_[classIndex];
+        }
+    }
+};
+
+} // namespace lzutil
@@ -21,18 +21,213 @@
 */
 
 #include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
 #include <vector>
 #include <popl/popl.hpp>
 
 #include "ze_api.h"
 #include "zello_log.h"
 
+struct DeviceEntry {
+    std::string         label;
+    ze_device_handle_t  device;
+};
+
+using clk = std::chrono::high_resolution_clock;
+
+template<typename T>
+static void WriteProperties(
+    log_writer& w,
+    const char* title,
+    const char* key,
+    const T& props )
+{
+    if (w.json()) {
+        w.key("", key);
+        log_struct(w, props);
+    } else {
+        w.raw(title);
+        w.raw(":\n");
+        log_struct(w, props);
+        w.raw("\n");
+    }
+}
+
+template<typename T>
+static void WritePropertiesArray(
+    log_writer& w,
+    const char* label,
+    const char* title,
+    const char* key,
+    const std::vector<T>& props )
+{
+    if (w.json()) {
+        w.key("", key);
+        w.begin_array();
+        for (auto& prop : props) {
+            log_struct(w, prop);
+        }
+        w.end_array();
+    } else {
+        for (size_t i = 0; i < props.size(); i++) {
+            w.raw((label + ("[" + std::to_string(i) + "]:\n")).c_str());
+            WriteProperties(w, title, key, props[i]);
+        }
+    }
+}
+
+// Queries all properties for a device and formats them into a string, so
+// devices can be queried concurrently and printed in a deterministic order.
+static std::string GetDeviceInfo(
+    ze_device_handle_t device,
+    log_writer::format_t format )
+{
+    log_writer w(format);
+
+    ze_device_properties_t deviceProps = {};
+    deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+    zeDeviceGetProperties(device, &deviceProps);
+
+    ze_device_compute_properties_t computeProps = {};
+    computeProps.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
+    zeDeviceGetComputeProperties(device, &computeProps);
+
+    ze_device_module_properties_t moduleProps = {};
+    moduleProps.stype = ZE_STRUCTURE_TYPE_DEVICE_MODULE_PROPERTIES;
+    zeDeviceGetModuleProperties(device, &moduleProps);
+
+    //zeDeviceGetCommandQueueGroupProperties(
+
+    uint32_t memoryCount = 0;
+    zeDeviceGetMemoryProperties(device, &memoryCount, nullptr);
+
+    std::vector<ze_device_memory_properties_t> memoryProps(memoryCount);
+    for (auto& prop : memoryProps) {
+        prop.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES;
+    }
+    zeDeviceGetMemoryProperties(device, &memoryCount, memoryProps.data());
+
+    ze_device_memory_access_properties_t memAccessProps = {};
+    memAccessProps.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_ACCESS_PROPERTIES;
+    zeDeviceGetMemoryAccessProperties(device, &memAccessProps);
+
+    uint32_t cacheCount = 0;
+    zeDeviceGetCacheProperties(device, &cacheCount, nullptr);
+
+    std::vector<ze_device_cache_properties_t> cacheProps(cacheCount);
+    for (auto& prop : cacheProps) {
+        prop.stype = ZE_STRUCTURE_TYPE_DEVICE_CACHE_PROPERTIES;
+    }
+    zeDeviceGetCacheProperties(device, &cacheCount, cacheProps.data());
+
+    ze_device_image_properties_t imageProps = {};
+    imageProps.stype = ZE_STRUCTURE_TYPE_IMAGE_PROPERTIES;
+    zeDeviceGetImageProperties(device, &imageProps);
+
+    ze_device_external_memory_properties_t externalMemProps = {};
+    externalMemProps.stype = ZE_STRUCTURE_TYPE_DEVICE_EXTERNAL_MEMORY_PROPERTIES;
+    zeDeviceGetExternalMemoryProperties(device, &externalMemProps);
+
+    //zeDeviceGetP2PProperties
+
+    uint32_t queueGroupCount = 0;
+    zeDeviceGetCommandQueueGroupProperties(device, &queueGroupCount, nullptr);
+
+    std::vector<ze_command_queue_group_properties_t> queueGroupProps(queueGroupCount);
+    for (auto& prop : queueGroupProps) {
+        prop.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+    }
+    zeDeviceGetCommandQueueGroupProperties(device, &queueGroupCount, queueGroupProps.data());
+
+    w.begin_object();
+    WriteProperties(w, "Device Properties", "deviceProperties", deviceProps);
+    WriteProperties(w, "Compute Properties", "computeProperties", computeProps);
+    WriteProperties(w, "Module Properties", "moduleProperties", moduleProps);
+    WritePropertiesArray(w, "Memory", "Memory Properties", "memoryProperties", memoryProps);
+    WriteProperties(w, "Memory Access Properties", "memoryAccessProperties", memAccessProps);
+    WritePropertiesArray(w, "Cache", "Cache Properties", "cacheProperties", cacheProps);
+    WriteProperties(w, "Image Properties", "imageProperties", imageProps);
+    //WriteProperties(w, "External Memory Properties", "externalMemoryProperties", externalMemProps);
+    WritePropertiesArray(w, "QueueGroup", "Queue Group Properties", "queueGroupProperties", queueGroupProps);
+    w.end_object();
+
+    return w.str();
+}
+
+static std::vector<DeviceEntry> GetDeviceEntries(
+    const std::vector<ze_device_handle_t>& devices )
+{
+    std::vector<DeviceEntry> entries;
+    for (uint32_t i = 0; i < devices.size(); i++) {
+        const std::string label = "Device[" + std::to_string(i) + "]";
+        entries.push_back(DeviceEntry{ label, devices[i] });
+
+        uint32_t subDeviceCount = 0;
+        zeDeviceGetSubDevices(devices[i], &subDeviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> subDevices(subDeviceCount);
+        zeDeviceGetSubDevices(devices[i], &subDeviceCount, subDevices.data());
+
+        for (uint32_t s = 0; s < subDeviceCount; s++) {
+            entries.push_back(DeviceEntry{
+                label + ".SubDevice[" + std::to_string(s) + "]",
+                subDevices[s] });
+        }
+    }
+    return entries;
+}
+
+static std::vector<std::string> CollectDeviceInfo(
+    const std::vector<DeviceEntry>& entries,
+    unsigned numThreads,
+    log_writer::format_t format )
+{
+    std::vector<std::string> info(entries.size());
+
+    if (numThreads <= 1 || entries.size() <= 1) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            info[i] = GetDeviceInfo(entries[i].device, format);
+        }
+        return info;
+    }
+
+    // Each worker claims the next device that has not been queried yet and
+    // writes its output into that device's slot.
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    numThreads = std::min<unsigned>(numThreads, (unsigned)entries.size());
+    for (unsigned t = 0; t < numThreads; t++) {
+        workers.emplace_back([&]() {
+            size_t i;
+            while ((i = next.fetch_add(1)) < entries.size()) {
+                info[i] = GetDeviceInfo(entries[i].device, format);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return info;
+}
+
 int main(
     int argc,
     char** argv )
 {
+    unsigned numThreads = 1;
+    bool compare = false;
+    bool json = false;
+
     {
         popl::OptionParser op("Supported Options");
+        op.add<popl::Value<unsigned>>("t", "threads", "Device Query Threads (0: one per hardware thread)", numThreads, &numThreads);
+        op.add<popl::Switch>("", "compare", "Report Serial vs. Parallel Collection Time", &compare);
+        op.add<popl::Switch>("", "json", "Print Properties as JSON", &json);
 
         bool printUsage = false;
         try {
@@ -50,28 +245,53 @@ int main(
         }
     }
 
+    unsigned compareThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (numThreads == 0) {
+        numThreads = compareThreads;
+    } else if (numThreads > 1) {
+        compareThreads = numThreads;
+    }
+
+    const log_writer::format_t format = json ? log_writer::JSON : log_writer::TEXT;
+
+    // In JSON mode the JSON document is the only thing written to stdout;
+    // status and timing messages go to stderr instead.
+    FILE* status = json ? stderr : stdout;
+
     ze_result_t result;
 
     result = zeInit(0);
     if (result != ZE_RESULT_SUCCESS) {
-        printf("zeInit failed (%u)!\n", result);
+        fprintf(status, "zeInit failed (%u)!\n", result);
     }
 
     uint32_t driverCount = 0;
     result = zeDriverGet(&driverCount, nullptr);
-    printf("Enumerated %u drivers.\n\n", driverCount);
+    fprintf(status, "Enumerated %u drivers.\n\n", driverCount);
 
     std::vector<ze_driver_handle_t> drivers(driverCount);
     result = zeDriverGet(&driverCount, drivers.data());
 
-    for (auto& driver : drivers) {
-        printf("Driver:\n");
+    log_writer doc(format);
+    if (json) {
+        doc.begin_object();
+        doc.key("", "drivers");
+        doc.begin_array();
+    }
 
+    for (auto& driver : drivers) {
         ze_driver_properties_t driverProps = {};
         driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
         zeDriverGetProperties(driver, &driverProps);
 
-        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+        if (json) {
+            doc.begin_object();
+            doc.key("", "driverVersion");
+            doc.number(driverProps.driverVersion);
+        } else {
+            printf("Driver:\n");
+            printf("\tDriver Version: %u\n", driverProps.driverVersion );
+        }
 
         uint32_t deviceCount = 0;
         zeDeviceGet(driver, &deviceCount, nullptr);
@@ -79,67 +299,63 @@ int main(
         std::vector<ze_device_handle_t> devices(deviceCount);
         zeDeviceGet(driver, &deviceCount, devices.data());
 
-        for (uint32_t i = 0; i < deviceCount; i++) {
-            printf("Device[%u]:\n", i);
-
-            ze_device_properties_t deviceProps = {};
-            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
-            zeDeviceGetProperties(devices[i], &deviceProps);
-
-            ze_device_compute_properties_t computeProps = {};
-            computeProps.stype = ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES;
-            zeDeviceGetComputeProperties(devices[i], &computeProps);
-
-            ze_device_module_properties_t moduleProps = {};
-            moduleProps.stype = ZE_STRUCTURE_TYPE_DEVICE_MODULE_PROPERTIES;
-            zeDeviceGetModuleProperties(devices[i], &moduleProps);
-
-            //zeDeviceGetCommandQueueGroupProperties(
-
-            //zeDeviceGetMemoryProperties
-
-            ze_device_memory_access_properties_t memAccessProps = {};
-            memAccessProps.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_ACCESS_PROPERTIES;
-            zeDeviceGetMemoryAccessProperties(devices[i], &memAccessProps);
-
-            //zeDeviceGetCacheProperties
-
-            ze_device_image_properties_t imageProps = {};
-            imageProps.stype = ZE_STRUCTURE_TYPE_IMAGE_PROPERTIES;
-            zeDeviceGetImageProperties(devices[i], &imageProps);
-
-            ze_device_external_memory_properties_t externalMemProps = {};
-            externalMemProps.stype = ZE_STRUCTURE_TYPE_DEVICE_EXTERNAL_MEMORY_PROPERTIES;
-            zeDeviceGetExternalMemoryProperties(devices[i], &externalMemProps);
-
-            //zeDeviceGetP2PProperties
-
-            printf("Device Properties:\n%s\n", to_string(deviceProps).c_str());
-            printf("Compute Properties:\n%s\n", to_string(computeProps).c_str());
-            printf("Module Properties:\n%s\n", to_string(moduleProps).c_str());
-            printf("Memory Access Properties:\n%s\n", to_string(memAccessProps).c_str());
-            printf("Image Properties:\n%s\n", to_string(imageProps).c_str());
-            //printf("External Memory Properties:\n%s\n", to_string(externalMemProps).c_str());
-
-            uint32_t queueGroupCount = 0;
-            zeDeviceGetCommandQueueGroupProperties(devices[i], &queueGroupCount, nullptr);
-
-            std::vector<ze_command_queue_group_properties_t> queueGroupProps(queueGroupCount);
-            for (auto& prop : queueGroupProps) {
-                prop.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+        std::vector<DeviceEntry> entries = GetDeviceEntries(devices);
+
+        auto start = clk::now();
+        std::vector<std::string> info = CollectDeviceInfo(entries, numThreads, format);
+        auto end = clk::now();
+
+        if (json) {
+            doc.key("", "devices");
+            doc.begin_array();
+            for (size_t i = 0; i < entries.size(); i++) {
+                doc.begin_object();
+                doc.key("", "label");
+                doc.string(entries[i].label.c_str());
+                doc.key("", "properties");
+                doc.value(info[i].c_str(), info[i].size());
+                doc.end_object();
             }
-            zeDeviceGetCommandQueueGroupProperties(devices[i], &queueGroupCount, queueGroupProps.data());
-
-            for (uint32_t i = 0; i < queueGroupCount; i++) {
-                printf("QueueGroup[%u]:\n", i);
-                printf("Queue Group Properties:\n%s\n", to_string(queueGroupProps[i]).c_str());
+            doc.end_array();
+            doc.end_object();
+        } else {
+            for (size_t i = 0; i < entries.size(); i++) {
+                printf("%s:\n", entries[i].label.c_str());
+                printf("%s", info[i].c_str());
             }
+        }
 
+        if (compare) {
+            auto serialStart = clk::now();
+            CollectDeviceInfo(entries, 1, format);
+            auto serialEnd = clk::now();
+
+            auto parallelStart = clk::now();
+            CollectDeviceInfo(entries, compareThreads, format);
+            auto parallelEnd = clk::now();
+
+            fprintf(status, "Collected %zu devices in %.3f ms using %u thread(s).\n",
+                entries.size(),
+                std::chrono::duration<double, std::milli>(end - start).count(),
+                numThreads);
+            fprintf(status, "Serial collection:   %.3f ms\n",
+                std::chrono::duration<double, std::milli>(serialEnd - serialStart).count());
+            fprintf(status, "Parallel collection: %.3f ms (%u threads)\n",
+                std::chrono::duration<double, std::milli>(parallelEnd - parallelStart).count(),
+                compareThreads);
+        }
+        if (!json) {
+            printf("\n");
         }
-        printf("\n");
     }
 
-    printf( "Done.\n" );
+    if (json) {
+        doc.end_array();
+        doc.end_object();
+        printf("%s\n", doc.c_str());
+    }
+
+    fprintf(status, "Done.\n");
 
     return 0;
 }
@@ -8,652 +8,985 @@
  */
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 #include "ze_api.h"
 #include "zet_api.h"
 
-std::string to_string( const ze_structure_type_t val )
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Enum name tables.  Each entry maps an enum value to its name, and
+/// optionally to a short key that can be parsed back into the enum value.
+struct enum_entry
 {
-    std::string str;
-
-    switch( val )
-    {
-    case ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES:
-        str = "DRIVER_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DRIVER_IPC_PROPERTIES:
-        str = "DRIVER_IPC_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES:
-        str = "DEVICE_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES:
-        str = "DEVICE_COMPUTE_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_MODULE_PROPERTIES:
-        str = "DEVICE_MODULE_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES:
-        str = "COMMAND_QUEUE_GROUP_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES:
-        str = "DEVICE_MEMORY_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_MEMORY_ACCESS_PROPERTIES:
-        str = "DEVICE_MEMORY_ACCESS_PROPERTIES";
-        break;
+    uint32_t    value;
+    const char* name;
+    const char* key;
+};
 
-    case ZE_STRUCTURE_TYPE_DEVICE_CACHE_PROPERTIES:
-        str = "DEVICE_CACHE_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_IMAGE_PROPERTIES:
-        str = "DEVICE_IMAGE_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_P2P_PROPERTIES:
-        str = "DEVICE_P2P_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_DEVICE_EXTERNAL_MEMORY_PROPERTIES:
-        str = "DEVICE_EXTERNAL_MEMORY_PROPERTIES";
-        break;
-
-    case ZE_STRUCTURE_TYPE_CONTEXT_DESC:
-        str = "CONTEXT_DESC";
-        break;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Perfect hashes for naming enum values and parsing enum keys.  The
+/// seed and slot table are found at compile time, so a lookup is one hash,
+/// one slot load, and one compare, with no allocations.
+constexpr uint32_t enum_key_hash( const char* s, size_t len, uint32_t seed )
+{
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for( size_t i = 0; i < len; i++ ) {
+        h ^= static_cast<uint8_t>(s[i]);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
 
-    case ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC:
-        str = "COMMAND_QUEUE_DESC";
-        break;
+constexpr uint32_t enum_value_hash( uint32_t value, uint32_t seed )
+{
+    uint32_t h = value ^ (seed * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    return h ^ (h >> 16);
+}
 
-    case ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC:
-        str = "COMMAND_LIST_DESC";
-        break;
+constexpr size_t enum_key_length( const char* s )
+{
+    size_t len = 0;
+    while( s[len] != '\0' )
+        len++;
+    return len;
+}
 
-    case ZE_STRUCTURE_TYPE_EVENT_POOL_DESC:
-        str = "EVENT_POOL_DESC";
-        break;
+constexpr size_t enum_slot_count( size_t n )
+{
+    size_t count = 1;
+    while( count < 2 * n )
+        count *= 2;
+    return count;
+}
 
-    case ZE_STRUCTURE_TYPE_EVENT_DESC:
-        str = "EVENT_DESC";
-        break;
+template<size_t N>
+struct enum_hash_table
+{
+    static constexpr size_t slot_count = enum_slot_count(N);
+    static_assert(N < 255, "too many entries for 8-bit slots");
 
-    case ZE_STRUCTURE_TYPE_FENCE_DESC:
-        str = "FENCE_DESC";
-        break;
+    uint32_t    seed;
+    uint8_t     slots[slot_count];  // entry index + 1, or 0 if empty
+};
 
-    case ZE_STRUCTURE_TYPE_IMAGE_DESC:
-        str = "IMAGE_DESC";
-        break;
+constexpr uint32_t enum_entry_hash( const enum_entry& e, bool by_key, uint32_t seed )
+{
+    return by_key ?
+        enum_key_hash(e.key, enum_key_length(e.key), seed) :
+        enum_value_hash(e.value, seed);
+}
 
-    case ZE_STRUCTURE_TYPE_IMAGE_PROPERTIES:
-        str = "IMAGE_PROPERTIES";
-        break;
+template<size_t N>
+constexpr enum_hash_table<N> make_enum_hash_table( const enum_entry (&entries)[N], bool by_key )
+{
+    enum_hash_table<N> table = {};
+    const uint32_t mask = enum_hash_table<N>::slot_count - 1;
+    for( uint32_t seed = 1; seed < 100000; seed++ ) {
+        for( auto& slot : table.slots )
+            slot = 0;
+
+        bool collision = false;
+        for( size_t i = 0; i < N && !collision; i++ ) {
+            const uint32_t h = enum_entry_hash(entries[i], by_key, seed) & mask;
+            if( table.slots[h] != 0 )
+                collision = true;
+            else
+                table.slots[h] = static_cast<uint8_t>(i + 1);
+        }
 
-    case ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC:
-        str = "DEVICE_MEM_ALLOC_DESC";
-        break;
+        if( !collision ) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    // Not a constant expression, so this fails to compile if no seed works.
+    throw "no perfect hash seed found";
+}
 
-    default:
-        str = "? ";
-        str += std::to_string(val);
-        str += " ?";
-        break;
-    };
+template<size_t N>
+constexpr enum_hash_table<N> make_enum_key_hash_table( const enum_entry (&entries)[N] )
+{
+    return make_enum_hash_table(entries, true);
+}
 
-    return str;
+template<size_t N>
+constexpr enum_hash_table<N> make_enum_value_hash_table( const enum_entry (&entries)[N] )
+{
+    return make_enum_hash_table(entries, false);
 }
 
-std::string to_string(const ze_device_fp_flags_t capabilities) {
-  std::string capabilities_str = "";
-  if (capabilities == 0) {
-    capabilities_str.append("|NONE|");
-    return capabilities_str;
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_DENORM) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_DENORM|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_INF_NAN) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_INF_NAN|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_ROUND_TO_NEAREST) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_ROUND_TO_NEAREST|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_ROUND_TO_ZERO) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_ROUND_TO_ZERO|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_ROUND_TO_INF) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_ROUND_TO_INF|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_FMA) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_FMA|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_ROUNDED_DIVIDE_SQRT) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_ROUNDED_DIVIDE_SQRT|");
-  }
-  if (capabilities & ZE_DEVICE_FP_FLAG_SOFT_FLOAT) {
-    capabilities_str.append("|ZE_DEVICE_FP_FLAG_SOFT_FLOAT|");
-  }
-  return capabilities_str;
+template<size_t N>
+const enum_entry* find_enum_key(
+    const enum_entry (&entries)[N],
+    const enum_hash_table<N>& table,
+    const char* s,
+    size_t len )
+{
+    const uint32_t mask = enum_hash_table<N>::slot_count - 1;
+    const uint8_t slot = table.slots[enum_key_hash(s, len, table.seed) & mask];
+    if( slot == 0 )
+        return nullptr;
+
+    const enum_entry& e = entries[slot - 1];
+    if( strncmp(e.key, s, len) != 0 || e.key[len] != '\0' )
+        return nullptr;
+    return &e;
 }
 
-std::string to_string( const ze_device_uuid_t val )
+template<size_t N>
+const char* enum_name(
+    const enum_entry (&entries)[N],
+    const enum_hash_table<N>& table,
+    uint32_t value )
 {
-    std::string str;
+    const uint32_t mask = enum_hash_table<N>::slot_count - 1;
+    const uint8_t slot = table.slots[enum_value_hash(value, table.seed) & mask];
+    if( slot == 0 )
+        return nullptr;
 
-    str += "device_uuid_t::id : ";
-    {
-        std::string tmp;
-        for( auto& entry : val.id )
-        {
-            tmp += std::to_string( entry );
-            tmp += ", ";
-        }
-        str += "[ " + tmp.substr( 0, tmp.size() - 2 ) + " ]";;
-    }
-    str += "\n";
+    const enum_entry& e = entries[slot - 1];
+    return e.value == value ? e.name : nullptr;
+}
 
-    return str;
+static constexpr enum_entry structure_type_entries[] = {
+    { ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES, "DRIVER_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DRIVER_IPC_PROPERTIES, "DRIVER_IPC_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES, "DEVICE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_COMPUTE_PROPERTIES, "DEVICE_COMPUTE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_MODULE_PROPERTIES, "DEVICE_MODULE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES, "COMMAND_QUEUE_GROUP_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES, "DEVICE_MEMORY_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_MEMORY_ACCESS_PROPERTIES, "DEVICE_MEMORY_ACCESS_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_CACHE_PROPERTIES, "DEVICE_CACHE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_IMAGE_PROPERTIES, "DEVICE_IMAGE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_P2P_PROPERTIES, "DEVICE_P2P_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_EXTERNAL_MEMORY_PROPERTIES, "DEVICE_EXTERNAL_MEMORY_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_CONTEXT_DESC, "CONTEXT_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC, "COMMAND_QUEUE_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC, "COMMAND_LIST_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_EVENT_POOL_DESC, "EVENT_POOL_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_EVENT_DESC, "EVENT_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_FENCE_DESC, "FENCE_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_IMAGE_DESC, "IMAGE_DESC", nullptr },
+    { ZE_STRUCTURE_TYPE_IMAGE_PROPERTIES, "IMAGE_PROPERTIES", nullptr },
+    { ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC, "DEVICE_MEM_ALLOC_DESC", nullptr },
+};
+
+static constexpr auto structure_type_values =
+    make_enum_value_hash_table(structure_type_entries);
+
+const char* structure_type_name( const ze_structure_type_t val )
+{
+    return enum_name(structure_type_entries, structure_type_values, val);
 }
 
-std::string to_string(const ze_device_cache_property_flag_t val )
+std::string to_string( const ze_structure_type_t val )
 {
-    const auto bits = static_cast<uint32_t>( val );
+    const char* name = structure_type_name(val);
+    if( name != nullptr )
+        return name;
 
     std::string str;
+    str = "? ";
+    str += std::to_string(val);
+    str += " ?";
+    return str;
+}
 
-    if( 0 == bits )
-        str += "0 | ";
+static constexpr enum_entry device_type_entries[] = {
+    { ZE_DEVICE_TYPE_GPU, "ZE_DEVICE_TYPE_GPU", nullptr },
+    { ZE_DEVICE_TYPE_CPU, "ZE_DEVICE_TYPE_CPU", nullptr },
+    { ZE_DEVICE_TYPE_FPGA, "ZE_DEVICE_TYPE_FPGA", nullptr },
+    { ZE_DEVICE_TYPE_MCA, "ZE_DEVICE_TYPE_MCA", nullptr },
+};
 
-    if( static_cast<uint32_t>(ZE_DEVICE_CACHE_PROPERTY_FLAG_USER_CONTROL) & bits )
-        str += "CACHE_PROPERTY_FLAG_USER_CONTROL | ";
+static constexpr auto device_type_values =
+    make_enum_value_hash_table(device_type_entries);
 
-    return ( str.size() > 3 )
-        ? "Device::{ " + str.substr(0, str.size() - 3) + " }"
-        : "Device::{ ? }";
+const char* device_type_name( const ze_device_type_t val )
+{
+    const char* name = enum_name(device_type_entries, device_type_values, val);
+    return name ? name : "?";
 }
 
-std::string to_string( ze_device_cache_properties_t val )
+std::string to_string( const ze_device_type_t val )
 {
-    std::string str;
-
-    str += "ze_device_cache_properties_t.stype : ";
-    str += to_string(val.stype);
-    str += "\n";
+    return device_type_name(val);
+}
 
-    str += "ze_device_cache_properties_t.pNext : ";
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes formatted structures into a reusable buffer.
+///
+/// The buffer is only grown, never shrunk, so once a log_writer has formatted
+/// a structure it can format structures of the same size again without any
+/// heap allocations.  The text format matches the historical to_string()
+/// output; the JSON format writes one object per structure.
+class log_writer
+{
+public:
+    enum format_t { TEXT, JSON };
+
+    explicit log_writer( format_t format = TEXT ) :
+        buffer_(1024),
+        size_(0),
+        format_(format),
+        depth_(0),
+        after_key_(false)
     {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
+        buffer_[0] = '\0';
+        has_items_[0] = false;
     }
-    str += "\n";
 
-    str += "ze_device_cache_properties_t.flags : ";
-    str += to_string((ze_device_cache_property_flag_t)val.flags);
-    str += "\n";
+    format_t format() const { return format_; }
+    bool json() const { return format_ == JSON; }
 
-    str += "ze_device_cache_properties_t.cacheSize : ";
-    str += std::to_string(val.cacheSize);
-    str += "\n";
+    const char* c_str() const { return buffer_.data(); }
+    size_t size() const { return size_; }
+    std::string str() const { return std::string(c_str(), size()); }
 
-    return str;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-/// @brief Converts Device::image_properties_t to std::string
-std::string to_string( ze_device_image_properties_t val )
-{
-    std::string str;
-
-    str += "ze_device_image_properties_t.stype : ";
-    str += to_string(val.stype);
-    str += "\n";
+    void clear()
+    {
+        size_ = 0;
+        buffer_[0] = '\0';
+        depth_ = 0;
+        after_key_ = false;
+        has_items_[0] = false;
+    }
 
-    str += "ze_device_image_properties_t.pNext : ";
+    void raw( const char* s, size_t n )
     {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
+        if( size_ + n + 1 > buffer_.size() )
+            buffer_.resize(std::max(buffer_.size() * 2, size_ + n + 1));
+        memcpy(buffer_.data() + size_, s, n);
+        size_ += n;
+        buffer_[size_] = '\0';
     }
-    str += "\n";
 
-    str += "ze_device_image_properties_t.maxImageDims1D : ";
-    str += std::to_string(val.maxImageDims1D);
-    str += "\n";
+    void raw( const char* s )
+    {
+        raw(s, strlen(s));
+    }
 
-    str += "ze_device_image_properties_t.maxImageDims2D : ";
-    str += std::to_string(val.maxImageDims2D);
-    str += "\n";
+    // Structured output: in text mode these only emit field prefixes and
+    // newlines, in JSON mode they also emit braces, keys, and separators.
+    void begin_object()
+    {
+        if( json() ) { separator(); raw("{"); push(); }
+    }
 
-    str += "ze_device_image_properties_t.maxImageDims3D : ";
-    str += std::to_string(val.maxImageDims3D);
-    str += "\n";
+    void end_object()
+    {
+        if( json() ) { pop(); raw("}"); }
+    }
 
-    str += "ze_device_image_properties_t.maxImageBufferSize : ";
-    str += std::to_string(val.maxImageBufferSize);
-    str += "\n";
+    void begin_array()
+    {
+        if( json() ) { separator(); raw("["); push(); }
+    }
 
-    str += "ze_device_image_properties_t.maxImageArraySlices : ";
-    str += std::to_string(val.maxImageArraySlices);
-    str += "\n";
+    void end_array()
+    {
+        if( json() ) { pop(); raw("]"); }
+    }
 
-    str += "ze_device_image_properties_t.maxSamplers : ";
-    str += std::to_string(val.maxSamplers);
-    str += "\n";
+    void key( const char* prefix, const char* name )
+    {
+        if( json() ) {
+            separator();
+            quoted(name);
+            raw(":");
+            after_key_ = true;
+        } else {
+            raw(prefix);
+            raw(name);
+            raw(" : ");
+        }
+    }
 
-    str += "ze_device_image_properties_t.maxReadImageArgs : ";
-    str += std::to_string(val.maxReadImageArgs);
-    str += "\n";
+    // Appends an already formatted value, such as the output of another
+    // log_writer.
+    void value( const char* s, size_t n )
+    {
+        if( json() ) separator();
+        raw(s, n);
+    }
 
-    str += "ze_device_image_properties_t.maxWriteImageArgs : ";
-    str += std::to_string(val.maxWriteImageArgs);
-    str += "\n";
+    void raw_value( const char* s )
+    {
+        value(s, strlen(s));
+    }
 
-    return str;
-}
-std::string to_string( ze_memory_access_cap_flag_t val )
-{
-    const auto bits = static_cast<uint32_t>( val );
+    void end_field()
+    {
+        if( !json() ) raw("\n");
+    }
 
-    std::string str;
+    void string( const char* s )
+    {
+        if( json() ) { separator(); quoted(s ? s : ""); }
+        else if( s ) raw(s);
+    }
 
-    if( 0 == bits )
-        str += "0 | ";
+    void number( uint64_t v )
+    {
+        if( json() ) separator();
+        digits(v);
+    }
 
-    if( static_cast<uint32_t>(ZE_MEMORY_ACCESS_CAP_FLAG_RW) & bits )
-        str += "MEMORY_ACCESS_CAP_FLAG_RW | ";
+    void pointer( const void* p )
+    {
+        static const char digits[] = "0123456789abcdef";
+        char tmp[24];
+        char* end = tmp + sizeof(tmp);
+        char* s = end;
+        size_t v = reinterpret_cast<size_t>(p);
+        do {
+            *--s = digits[v & 0xF];
+            v >>= 4;
+        } while( v != 0 );
+        *--s = 'x';
+        *--s = '0';
+        if( json() ) { separator(); raw("\""); raw(s, end - s); raw("\""); }
+        else raw(s, end - s);
+    }
 
-    if( static_cast<uint32_t>(ZE_MEMORY_ACCESS_CAP_FLAG_ATOMIC) & bits )
-        str += "MEMORY_ACCESS_CAP_FLAG_ATOMIC | ";
+    void decimal( double v, int precision = 3 )
+    {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", precision, v);
+        if( json() ) separator();
+        raw(tmp, n);
+    }
 
-    if( static_cast<uint32_t>(ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT) & bits )
-        str += "MEMORY_ACCESS_CAP_FLAG_CONCURRENT | ";
+    void version( uint32_t v )
+    {
+        if( json() ) {
+            separator();
+            raw("\"");
+            digits(ZE_MAJOR_VERSION(v));
+            raw(".");
+            digits(ZE_MINOR_VERSION(v));
+            raw("\"");
+        } else {
+            digits(ZE_MAJOR_VERSION(v));
+            raw(".");
+            digits(ZE_MINOR_VERSION(v));
+        }
+    }
 
-    if( static_cast<uint32_t>(ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT_ATOMIC) & bits )
-        str += "MEMORY_ACCESS_CAP_FLAG_CONCURRENT_ATOMIC | ";
+    template<typename T>
+    void number_array( const T* vals, size_t count )
+    {
+        if( json() ) {
+            begin_array();
+            for( size_t i = 0; i < count; i++ )
+                number(vals[i]);
+            end_array();
+        } else {
+            raw("[ ");
+            for( size_t i = 0; i < count; i++ ) {
+                if( i != 0 ) raw(", ");
+                number(vals[i]);
+            }
+            raw(" ]");
+        }
+    }
 
-    return ( str.size() > 3 )
-        ? "Device::{ " + str.substr(0, str.size() - 3) + " }"
-        : "Device::{ ? }";
-}
+private:
+    static const int max_depth = 16;
 
+    std::vector<char> buffer_;
+    size_t size_;
+    format_t format_;
+    int depth_;
+    bool after_key_;
+    bool has_items_[max_depth];
 
+    // Writes an unsigned decimal number without going through snprintf.
+    void digits( uint64_t v )
+    {
+        char tmp[24];
+        char* end = tmp + sizeof(tmp);
+        char* p = end;
+        do {
+            *--p = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while( v != 0 );
+        raw(p, end - p);
+    }
 
-std::string to_string( ze_device_memory_access_properties_t val )
-{
-    std::string str;
+    void push()
+    {
+        if( depth_ + 1 < max_depth ) depth_++;
+        has_items_[depth_] = false;
+    }
 
-    str += "ze_device_memory_access_properties_t.stype : ";
-    str += to_string(val.stype);
-    str += "\n";
+    void pop()
+    {
+        if( depth_ > 0 ) depth_--;
+    }
 
-    str += "ze_device_memory_access_properties_t.pNext : ";
+    void separator()
     {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
+        if( after_key_ ) {
+            after_key_ = false;
+        } else {
+            if( has_items_[depth_] ) raw(",");
+        }
+        has_items_[depth_] = true;
     }
-    str += "\n";
 
-    str += "ze_device_memory_access_properties_t.hostAllocCapabilities : ";
-    str += to_string((ze_memory_access_cap_flag_t)val.hostAllocCapabilities);
-    str += "\n";
+    void quoted( const char* s )
+    {
+        raw("\"");
+        const char* run = s;
+        for( const char* p = s; *p; p++ ) {
+            const unsigned char c = static_cast<unsigned char>(*p);
+            if( c == '"' || c == '\\' || c < 0x20 ) {
+                raw(run, p - run);
+                run = p + 1;
+                if( c < 0x20 ) {
+                    static const char hex[] = "0123456789abcdef";
+                    char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                    raw(esc, 6);
+                } else {
+                    char esc[2] = { '\\', static_cast<char>(c) };
+                    raw(esc, 2);
+                }
+            }
+        }
+        raw(run, strlen(run));
+        raw("\"");
+    }
+};
 
-    str += "ze_device_memory_access_properties_t.deviceAllocCapabilities : ";
-    str += to_string((ze_memory_access_cap_flag_t)val.deviceAllocCapabilities);
-    str += "\n";
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Flag names and formatting styles.
+struct flag_desc
+{
+    uint32_t    bit;
+    const char* name;
+};
 
-    str += "ze_device_memory_access_properties_t.sharedSingleDeviceAllocCapabilities : ";
-    str += to_string((ze_memory_access_cap_flag_t)val.sharedSingleDeviceAllocCapabilities);
-    str += "\n";
+enum flag_style_t
+{
+    FLAG_STYLE_BRACES,  // Device::{ A | B }, Device::{ 0 } if no bits are set
+    FLAG_STYLE_PIPES,   // |A||B|, |NONE| if no bits are set
+};
 
-    str += "ze_device_memory_access_properties_t.sharedCrossDeviceAllocCapabilities : ";
-    str += to_string((ze_memory_access_cap_flag_t)val.sharedCrossDeviceAllocCapabilities);
-    str += "\n";
+template<size_t N>
+void log_flags( log_writer& w, uint32_t bits, const flag_desc (&flags)[N], flag_style_t style )
+{
+    if( w.json() ) {
+        w.begin_array();
+        for( auto& f : flags )
+            if( f.bit & bits )
+                w.string(f.name);
+        w.end_array();
+        return;
+    }
 
-    str += "ze_device_memory_access_properties_t.sharedSystemAllocCapabilities : ";
-    str += to_string((ze_memory_access_cap_flag_t)val.sharedSystemAllocCapabilities);
-    str += "\n";
+    if( style == FLAG_STYLE_PIPES ) {
+        if( 0 == bits ) {
+            w.raw("|NONE|");
+            return;
+        }
+        for( auto& f : flags ) {
+            if( f.bit & bits ) {
+                w.raw("|");
+                w.raw(f.name);
+                w.raw("|");
+            }
+        }
+        return;
+    }
 
-    return str;
+    bool any = false;
+    w.raw("Device::{ ");
+    if( 0 == bits ) {
+        w.raw("0");
+        any = true;
+    }
+    for( auto& f : flags ) {
+        if( f.bit & bits ) {
+            if( any ) w.raw(" | ");
+            w.raw(f.name);
+            any = true;
+        }
+    }
+    if( !any ) w.raw("?");
+    w.raw(" }");
 }
 
-std::string to_string( ze_device_memory_property_flag_t val )
+static constexpr flag_desc device_fp_flags[] = {
+    { ZE_DEVICE_FP_FLAG_DENORM, "ZE_DEVICE_FP_FLAG_DENORM" },
+    { ZE_DEVICE_FP_FLAG_INF_NAN, "ZE_DEVICE_FP_FLAG_INF_NAN" },
+    { ZE_DEVICE_FP_FLAG_ROUND_TO_NEAREST, "ZE_DEVICE_FP_FLAG_ROUND_TO_NEAREST" },
+    { ZE_DEVICE_FP_FLAG_ROUND_TO_ZERO, "ZE_DEVICE_FP_FLAG_ROUND_TO_ZERO" },
+    { ZE_DEVICE_FP_FLAG_ROUND_TO_INF, "ZE_DEVICE_FP_FLAG_ROUND_TO_INF" },
+    { ZE_DEVICE_FP_FLAG_FMA, "ZE_DEVICE_FP_FLAG_FMA" },
+    { ZE_DEVICE_FP_FLAG_ROUNDED_DIVIDE_SQRT, "ZE_DEVICE_FP_FLAG_ROUNDED_DIVIDE_SQRT" },
+    { ZE_DEVICE_FP_FLAG_SOFT_FLOAT, "ZE_DEVICE_FP_FLAG_SOFT_FLOAT" },
+};
+
+static constexpr flag_desc device_cache_property_flags[] = {
+    { ZE_DEVICE_CACHE_PROPERTY_FLAG_USER_CONTROL, "CACHE_PROPERTY_FLAG_USER_CONTROL" },
+};
+
+static constexpr flag_desc memory_access_cap_flags[] = {
+    { ZE_MEMORY_ACCESS_CAP_FLAG_RW, "MEMORY_ACCESS_CAP_FLAG_RW" },
+    { ZE_MEMORY_ACCESS_CAP_FLAG_ATOMIC, "MEMORY_ACCESS_CAP_FLAG_ATOMIC" },
+    { ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT, "MEMORY_ACCESS_CAP_FLAG_CONCURRENT" },
+    { ZE_MEMORY_ACCESS_CAP_FLAG_CONCURRENT_ATOMIC, "MEMORY_ACCESS_CAP_FLAG_CONCURRENT_ATOMIC" },
+};
+
+static constexpr flag_desc device_memory_property_flags[] = {
+    { ZE_DEVICE_MEMORY_PROPERTY_FLAG_TBD, "MEMORY_PROPERTY_FLAG_TBD" },
+};
+
+static constexpr flag_desc device_property_flags[] = {
+    { ZE_DEVICE_PROPERTY_FLAG_INTEGRATED, "PROPERTY_FLAG_INTEGRATED" },
+    { ZE_DEVICE_PROPERTY_FLAG_SUBDEVICE, "PROPERTY_FLAG_SUBDEVICE" },
+    { ZE_DEVICE_PROPERTY_FLAG_ECC, "PROPERTY_FLAG_ECC" },
+    { ZE_DEVICE_PROPERTY_FLAG_ONDEMANDPAGING, "PROPERTY_FLAG_ONDEMANDPAGING" },
+};
+
+static constexpr flag_desc command_queue_group_property_flags[] = {
+    { ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE, "ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE" },
+    { ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY, "ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY" },
+    { ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COOPERATIVE_KERNELS, "ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COOPERATIVE_KERNELS" },
+    { ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_METRICS, "ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_METRICS" },
+};
+
+static constexpr flag_desc device_p2p_property_flags[] = {
+    { ZE_DEVICE_P2P_PROPERTY_FLAG_ACCESS, "P2P_PROPERTY_FLAG_ACCESS" },
+    { ZE_DEVICE_P2P_PROPERTY_FLAG_ATOMICS, "P2P_PROPERTY_FLAG_ATOMICS" },
+};
+
+template<size_t N>
+std::string flags_to_string( uint32_t bits, const flag_desc (&flags)[N], flag_style_t style )
 {
-    const auto bits = static_cast<uint32_t>( val );
+    log_writer w;
+    log_flags(w, bits, flags, style);
+    return w.str();
+}
 
-    std::string str;
+std::string to_string(const ze_device_fp_flags_t capabilities) {
+  return flags_to_string(capabilities, device_fp_flags, FLAG_STYLE_PIPES);
+}
 
-    if( 0 == bits )
-        str += "0 | ";
+std::string to_string(const ze_device_cache_property_flag_t val )
+{
+    return flags_to_string(val, device_cache_property_flags, FLAG_STYLE_BRACES);
+}
 
-    if( static_cast<uint32_t>(ZE_DEVICE_MEMORY_PROPERTY_FLAG_TBD) & bits )
-        str += "MEMORY_PROPERTY_FLAG_TBD | ";
+std::string to_string( ze_memory_access_cap_flag_t val )
+{
+    return flags_to_string(val, memory_access_cap_flags, FLAG_STYLE_BRACES);
+}
 
-    return ( str.size() > 3 )
-        ? "Device::{ " + str.substr(0, str.size() - 3) + " }"
-        : "Device::{ ? }";
+std::string to_string( ze_device_memory_property_flag_t val )
+{
+    return flags_to_string(val, device_memory_property_flags, FLAG_STYLE_BRACES);
 }
 
-std::string to_string( const ze_device_memory_properties_t val )
+std::string to_string( ze_device_property_flag_t val )
 {
-    std::string str;
+    return flags_to_string(val, device_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "stype : ";
-    str += to_string(val.stype);
-    str += "\n";
+std::string to_string( ze_device_p2p_property_flag_t val )
+{
+    return flags_to_string(val, device_p2p_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "pNext : ";
-    {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
-    }
-    str += "\n";
+std::string command_queue_group_property_flags_to_string(
+    const ze_command_queue_group_property_flags_t flags)
+{
+    return flags_to_string(flags, command_queue_group_property_flags, FLAG_STYLE_PIPES);
+}
 
-    str += "flags : ";
-    str += to_string((ze_device_memory_property_flag_t)val.flags);
-    str += "\n";
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Field formatters.  Each one formats a single structure member of a
+/// known type, given a pointer to the member.
+typedef void (*field_formatter_t)( log_writer& w, const void* field );
 
-    str += "maxClockRate : ";
-    str += std::to_string(val.maxClockRate);
-    str += "\n";
+template<typename T>
+inline const T& field_as( const void* field )
+{
+    return *static_cast<const T*>(field);
+}
 
-    str += "maxBusWidth : ";
-    str += std::to_string(val.maxBusWidth);
-    str += "\n";
+inline void log_u32( log_writer& w, const void* f ) { w.number(field_as<uint32_t>(f)); }
+inline void log_u64( log_writer& w, const void* f ) { w.number(field_as<uint64_t>(f)); }
+inline void log_size( log_writer& w, const void* f ) { w.number(field_as<size_t>(f)); }
+inline void log_pointer( log_writer& w, const void* f ) { w.pointer(field_as<const void*>(f)); }
+inline void log_version( log_writer& w, const void* f ) { w.version(field_as<uint32_t>(f)); }
+inline void log_char_array( log_writer& w, const void* f ) { w.string(static_cast<const char*>(f)); }
+inline void log_c_string( log_writer& w, const void* f ) { w.string(field_as<const char*>(f)); }
 
-    str += "totalSize : ";
-    str += std::to_string(val.totalSize);
-    str += "\n";
+inline void log_stype( log_writer& w, const void* f )
+{
+    const ze_structure_type_t stype = field_as<ze_structure_type_t>(f);
+    const char* name = structure_type_name(stype);
+    if( name != nullptr ) {
+        w.string(name);
+    } else {
+        char tmp[32];
+        snprintf(tmp, sizeof(tmp), "? %d ?", static_cast<int>(stype));
+        w.string(tmp);
+    }
+}
 
-    str += "name : ";
-    str += val.name;
-    str += "\n";
+inline void log_device_type( log_writer& w, const void* f )
+{
+    w.string(device_type_name(field_as<ze_device_type_t>(f)));
+}
 
-    return str;
+inline void log_device_uuid( log_writer& w, const void* f )
+{
+    const ze_device_uuid_t& uuid = field_as<ze_device_uuid_t>(f);
+    if( w.json() ) {
+        w.number_array(uuid.id, ZE_MAX_DEVICE_UUID_SIZE);
+    } else {
+        w.raw("device_uuid_t::id : ");
+        w.number_array(uuid.id, ZE_MAX_DEVICE_UUID_SIZE);
+        w.raw("\n");
+    }
 }
 
-std::string to_string( const ze_device_compute_properties_t val )
+inline void log_subgroup_sizes( log_writer& w, const void* f )
 {
-    std::string str;
+    w.number_array(static_cast<const uint32_t*>(f), ZE_SUBGROUPSIZE_COUNT);
+}
 
-    str += "stype : ";
-    str += to_string(val.stype);
-    str += "\n";
+inline void log_fp_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), device_fp_flags, FLAG_STYLE_PIPES);
+}
 
-    str += "pNext : ";
-    {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
-    }
-    str += "\n";
+inline void log_cache_property_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), device_cache_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "maxTotalGroupSize : ";
-    str += std::to_string(val.maxTotalGroupSize);
-    str += "\n";
+inline void log_memory_access_cap_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), memory_access_cap_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "maxGroupSizeX : ";
-    str += std::to_string(val.maxGroupSizeX);
-    str += "\n";
+inline void log_memory_property_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), device_memory_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "maxGroupSizeY : ";
-    str += std::to_string(val.maxGroupSizeY);
-    str += "\n";
+inline void log_device_property_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), device_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "maxGroupSizeZ : ";
-    str += std::to_string(val.maxGroupSizeZ);
-    str += "\n";
+inline void log_p2p_property_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), device_p2p_property_flags, FLAG_STYLE_BRACES);
+}
 
-    str += "maxGroupCountX : ";
-    str += std::to_string(val.maxGroupCountX);
-    str += "\n";
+inline void log_queue_group_flags( log_writer& w, const void* f )
+{
+    log_flags(w, field_as<uint32_t>(f), command_queue_group_property_flags, FLAG_STYLE_PIPES);
+}
 
-    str += "maxGroupCountY : ";
-    str += std::to_string(val.maxGroupCountY);
-    str += "\n";
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Field descriptor tables.  Each structure is described at compile
+/// time by its text prefix and a list of member names, offsets, and
+/// formatters.
+struct field_desc
+{
+    const char*         name;
+    size_t              offset;
+    field_formatter_t   formatter;
+};
 
-    str += "maxGroupCountZ : ";
-    str += std::to_string(val.maxGroupCountZ);
-    str += "\n";
+struct field_table
+{
+    const char*         prefix;
+    const field_desc*   fields;
+    size_t              count;
+};
 
-    str += "maxSharedLocalMemory : ";
-    str += std::to_string(val.maxSharedLocalMemory);
-    str += "\n";
+#define ZELLO_FIELD( _type, _member, _formatter ) \
+    { #_member, offsetof(_type, _member), _formatter }
 
-    str += "numSubGroupSizes : ";
-    str += std::to_string(val.numSubGroupSizes);
-    str += "\n";
+template<typename T, size_t N>
+constexpr field_table make_field_table( const char* prefix, const field_desc (&fields)[N] )
+{
+    return field_table{ prefix, fields, N };
+}
 
-    str += "subGroupSizes : ";
-    {
-        std::string tmp;
-        for( auto& entry : val.subGroupSizes )
-        {
-            tmp += std::to_string( entry );
-            tmp += ", ";
-        }
-        str += "[ " + tmp.substr( 0, tmp.size() - 2 ) + " ]";;
+template<typename T>
+void log_struct( log_writer& w, const T& val )
+{
+    const field_table& table = get_field_table(val);
+    const char* base = reinterpret_cast<const char*>(&val);
+
+    w.begin_object();
+    for( size_t i = 0; i < table.count; i++ ) {
+        const field_desc& f = table.fields[i];
+        w.key(table.prefix, f.name);
+        f.formatter(w, base + f.offset);
+        w.end_field();
     }
-    str += "\n";
-
-    return str;
+    w.end_object();
 }
 
-std::string to_string( const ze_device_module_properties_t val )
+template<typename T>
+std::string struct_to_string( const T& val )
 {
-    std::string str;
-
-    str += "stype : ";
-    str += to_string(val.stype);
-    str += "\n";
-
-    str += "pNext : ";
-    {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
-    }
-    str += "\n";
+    log_writer w;
+    log_struct(w, val);
+    return w.str();
+}
 
-    str += "spirvVersionSupported : ";
-    {
-        std::stringstream ss;
-        ss << ZE_MAJOR_VERSION(val.spirvVersionSupported) << "." << ZE_MINOR_VERSION(val.spirvVersionSupported);
-        str += ss.str();
-    }
-    str += "\n";
+static constexpr field_desc device_cache_properties_fields[] = {
+    ZELLO_FIELD(ze_device_cache_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_cache_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_cache_properties_t, flags, log_cache_property_flags),
+    ZELLO_FIELD(ze_device_cache_properties_t, cacheSize, log_size),
+};
 
-    str += "flags : ";
-    str += std::to_string(static_cast<uint32_t>(val.flags));
-    str += "\n";
+static constexpr field_table device_cache_properties_table =
+    make_field_table<ze_device_cache_properties_t>("ze_device_cache_properties_t.", device_cache_properties_fields);
 
-    str += "fp16flags : ";
-    str += to_string(val.fp16flags);
-    str += "\n";
+inline const field_table& get_field_table( const ze_device_cache_properties_t& )
+{
+    return device_cache_properties_table;
+}
 
-    str += "fp32flags : ";
-    str += to_string(val.fp32flags);
-    str += "\n";
+std::string to_string( ze_device_cache_properties_t val )
+{
+    return struct_to_string(val);
+}
 
-    str += "fp64flags : ";
-    str += to_string(val.fp64flags);
-    str += "\n";
+static constexpr field_desc device_image_properties_fields[] = {
+    ZELLO_FIELD(ze_device_image_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_image_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_image_properties_t, maxImageDims1D, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxImageDims2D, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxImageDims3D, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxImageBufferSize, log_u64),
+    ZELLO_FIELD(ze_device_image_properties_t, maxImageArraySlices, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxSamplers, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxReadImageArgs, log_u32),
+    ZELLO_FIELD(ze_device_image_properties_t, maxWriteImageArgs, log_u32),
+};
+
+static constexpr field_table device_image_properties_table =
+    make_field_table<ze_device_image_properties_t>("ze_device_image_properties_t.", device_image_properties_fields);
+
+inline const field_table& get_field_table( const ze_device_image_properties_t& )
+{
+    return device_image_properties_table;
+}
 
-    str += "maxArgumentsSize : ";
-    str += std::to_string(val.maxArgumentsSize);
-    str += "\n";
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts Device::image_properties_t to std::string
+std::string to_string( ze_device_image_properties_t val )
+{
+    return struct_to_string(val);
+}
 
-    str += "printfBufferSize : ";
-    str += std::to_string(val.printfBufferSize);
-    str += "\n";
+static constexpr field_desc device_memory_access_properties_fields[] = {
+    ZELLO_FIELD(ze_device_memory_access_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, hostAllocCapabilities, log_memory_access_cap_flags),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, deviceAllocCapabilities, log_memory_access_cap_flags),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, sharedSingleDeviceAllocCapabilities, log_memory_access_cap_flags),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, sharedCrossDeviceAllocCapabilities, log_memory_access_cap_flags),
+    ZELLO_FIELD(ze_device_memory_access_properties_t, sharedSystemAllocCapabilities, log_memory_access_cap_flags),
+};
 
-    // ze_native_kernel_uuid_t nativeKernelSupported
+static constexpr field_table device_memory_access_properties_table =
+    make_field_table<ze_device_memory_access_properties_t>("ze_device_memory_access_properties_t.", device_memory_access_properties_fields);
 
-    return str;
+inline const field_table& get_field_table( const ze_device_memory_access_properties_t& )
+{
+    return device_memory_access_properties_table;
 }
 
-std::string to_string( const ze_device_type_t val )
+std::string to_string( ze_device_memory_access_properties_t val )
 {
-    std::string str;
-
-    switch( val )
-    {
-    case ZE_DEVICE_TYPE_GPU:
-        str = "ZE_DEVICE_TYPE_GPU";
-        break;
-
-    case ZE_DEVICE_TYPE_CPU:
-        str = "ZE_DEVICE_TYPE_CPU";
-        break;
-
-    case ZE_DEVICE_TYPE_FPGA:
-        str = "ZE_DEVICE_TYPE_FPGA";
-        break;
+    return struct_to_string(val);
+}
 
-    case ZE_DEVICE_TYPE_MCA:
-        str = "ZE_DEVICE_TYPE_MCA";
-        break;
+static constexpr field_desc device_memory_properties_fields[] = {
+    ZELLO_FIELD(ze_device_memory_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_memory_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_memory_properties_t, flags, log_memory_property_flags),
+    ZELLO_FIELD(ze_device_memory_properties_t, maxClockRate, log_u32),
+    ZELLO_FIELD(ze_device_memory_properties_t, maxBusWidth, log_u32),
+    ZELLO_FIELD(ze_device_memory_properties_t, totalSize, log_u64),
+    ZELLO_FIELD(ze_device_memory_properties_t, name, log_c_string),
+};
 
-    default:
-        str = "?";
-        break;
-    };
+static constexpr field_table device_memory_properties_table =
+    make_field_table<ze_device_memory_properties_t>("", device_memory_properties_fields);
 
-    return str;
+inline const field_table& get_field_table( const ze_device_memory_properties_t& )
+{
+    return device_memory_properties_table;
 }
 
-std::string to_string( ze_device_property_flag_t val )
+std::string to_string( const ze_device_memory_properties_t val )
 {
-    const auto bits = static_cast<uint32_t>( val );
-
-    std::string str;
+    return struct_to_string(val);
+}
 
-    if( 0 == bits )
-        str += "0 | ";
+static constexpr field_desc device_compute_properties_fields[] = {
+    ZELLO_FIELD(ze_device_compute_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_compute_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxTotalGroupSize, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupSizeX, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupSizeY, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupSizeZ, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupCountX, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupCountY, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxGroupCountZ, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, maxSharedLocalMemory, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, numSubGroupSizes, log_u32),
+    ZELLO_FIELD(ze_device_compute_properties_t, subGroupSizes, log_subgroup_sizes),
+};
+
+static constexpr field_table device_compute_properties_table =
+    make_field_table<ze_device_compute_properties_t>("", device_compute_properties_fields);
+
+inline const field_table& get_field_table( const ze_device_compute_properties_t& )
+{
+    return device_compute_properties_table;
+}
 
-    if( static_cast<uint32_t>(ZE_DEVICE_PROPERTY_FLAG_INTEGRATED) & bits )
-        str += "PROPERTY_FLAG_INTEGRATED | ";
+std::string to_string( const ze_device_compute_properties_t val )
+{
+    return struct_to_string(val);
+}
 
-    if( static_cast<uint32_t>(ZE_DEVICE_PROPERTY_FLAG_SUBDEVICE) & bits )
-        str += "PROPERTY_FLAG_SUBDEVICE | ";
+static constexpr field_desc device_module_properties_fields[] = {
+    ZELLO_FIELD(ze_device_module_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_module_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_module_properties_t, spirvVersionSupported, log_version),
+    ZELLO_FIELD(ze_device_module_properties_t, flags, log_u32),
+    ZELLO_FIELD(ze_device_module_properties_t, fp16flags, log_fp_flags),
+    ZELLO_FIELD(ze_device_module_properties_t, fp32flags, log_fp_flags),
+    ZELLO_FIELD(ze_device_module_properties_t, fp64flags, log_fp_flags),
+    ZELLO_FIELD(ze_device_module_properties_t, maxArgumentsSize, log_u32),
+    ZELLO_FIELD(ze_device_module_properties_t, printfBufferSize, log_u32),
+    // ze_native_kernel_uuid_t nativeKernelSupported
+};
 
-    if( static_cast<uint32_t>(ZE_DEVICE_PROPERTY_FLAG_ECC) & bits )
-        str += "PROPERTY_FLAG_ECC | ";
+static constexpr field_table device_module_properties_table =
+    make_field_table<ze_device_module_properties_t>("", device_module_properties_fields);
 
-    if( static_cast<uint32_t>(ZE_DEVICE_PROPERTY_FLAG_ONDEMANDPAGING) & bits )
-        str += "PROPERTY_FLAG_ONDEMANDPAGING | ";
+inline const field_table& get_field_table( const ze_device_module_properties_t& )
+{
+    return device_module_properties_table;
+}
 
-    return ( str.size() > 3 )
-        ? "Device::{ " + str.substr(0, str.size() - 3) + " }"
-        : "Device::{ ? }";
+std::string to_string( const ze_device_module_properties_t val )
+{
+    return struct_to_string(val);
 }
 
+static constexpr field_desc device_properties_fields[] = {
+    ZELLO_FIELD(ze_device_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_properties_t, type, log_device_type),
+    ZELLO_FIELD(ze_device_properties_t, vendorId, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, deviceId, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, flags, log_device_property_flags),
+    ZELLO_FIELD(ze_device_properties_t, subdeviceId, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, coreClockRate, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, maxMemAllocSize, log_u64),
+    ZELLO_FIELD(ze_device_properties_t, maxHardwareContexts, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, maxCommandQueuePriority, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, numThreadsPerEU, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, physicalEUSimdWidth, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, numEUsPerSubslice, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, numSubslicesPerSlice, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, numSlices, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, timerResolution, log_u64),
+    ZELLO_FIELD(ze_device_properties_t, timestampValidBits, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, kernelTimestampValidBits, log_u32),
+    ZELLO_FIELD(ze_device_properties_t, uuid, log_device_uuid),
+    ZELLO_FIELD(ze_device_properties_t, name, log_char_array),
+};
+
+static constexpr field_table device_properties_table =
+    make_field_table<ze_device_properties_t>("Device::properties_t::", device_properties_fields);
+
+inline const field_table& get_field_table( const ze_device_properties_t& )
+{
+    return device_properties_table;
+}
 
 std::string to_string(const ze_device_properties_t val)
 {
-    std::string str;
-
-    str += "Device::properties_t::stype : ";
-    str += to_string(val.stype);
-    str += "\n";
-
-    str += "Device::properties_t::pNext : ";
-    {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
-        str += ss.str();
-    }
-    str += "\n";
-
-    str += "Device::properties_t::type : ";
-    str += to_string(val.type);
-    str += "\n";
-
-    str += "Device::properties_t::vendorId : ";
-    str += std::to_string(val.vendorId);
-    str += "\n";
-
-    str += "Device::properties_t::deviceId : ";
-    str += std::to_string(val.deviceId);
-    str += "\n";
-
-    str += "Device::properties_t::flags : ";
-    str += to_string((ze_device_property_flag_t)val.flags);
-    str += "\n";
-
-    str += "Device::properties_t::subdeviceId : ";
-    str += std::to_string(val.subdeviceId);
-    str += "\n";
-
-    str += "Device::properties_t::coreClockRate : ";
-    str += std::to_string(val.coreClockRate);
-    str += "\n";
-
-    str += "Device::properties_t::maxMemAllocSize : ";
-    str += std::to_string(val.maxMemAllocSize);
-    str += "\n";
-
-    str += "Device::properties_t::maxHardwareContexts : ";
-    str += std::to_string(val.maxHardwareContexts);
-    str += "\n";
-
-    str += "Device::properties_t::maxCommandQueuePriority : ";
-    str += std::to_string(val.maxCommandQueuePriority);
-    str += "\n";
-
-    str += "Device::properties_t::numThreadsPerEU : ";
-    str += std::to_string(val.numThreadsPerEU);
-    str += "\n";
-
-    str += "Device::properties_t::physicalEUSimdWidth : ";
-    str += std::to_string(val.physicalEUSimdWidth);
-    str += "\n";
+    return struct_to_string(val);
+}
 
-    str += "Device::properties_t::numEUsPerSubslice : ";
-    str += std::to_string(val.numEUsPerSubslice);
-    str += "\n";
+static constexpr field_desc command_queue_group_properties_fields[] = {
+    ZELLO_FIELD(ze_command_queue_group_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_command_queue_group_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_command_queue_group_properties_t, flags, log_queue_group_flags),
+    ZELLO_FIELD(ze_command_queue_group_properties_t, maxMemoryFillPatternSize, log_size),
+    ZELLO_FIELD(ze_command_queue_group_properties_t, numQueues, log_u32),
+};
 
-    str += "Device::properties_t::numSubslicesPerSlice : ";
-    str += std::to_string(val.numSubslicesPerSlice);
-    str += "\n";
+static constexpr field_table command_queue_group_properties_table =
+    make_field_table<ze_command_queue_group_properties_t>("ze_command_queue_group_properties_t.", command_queue_group_properties_fields);
 
-    str += "Device::properties_t::numSlices : ";
-    str += std::to_string(val.numSlices);
-    str += "\n";
+inline const field_table& get_field_table( const ze_command_queue_group_properties_t& )
+{
+    return command_queue_group_properties_table;
+}
 
-    str += "Device::properties_t::timerResolution : ";
-    str += std::to_string(val.timerResolution);
-    str += "\n";
+std::string to_string(const ze_command_queue_group_properties_t props)
+{
+    return struct_to_string(props);
+}
 
-    str += "Device::properties_t::timestampValidBits : ";
-    str += std::to_string(val.timestampValidBits);
-    str += "\n";
+static constexpr field_desc device_p2p_properties_fields[] = {
+    ZELLO_FIELD(ze_device_p2p_properties_t, stype, log_stype),
+    ZELLO_FIELD(ze_device_p2p_properties_t, pNext, log_pointer),
+    ZELLO_FIELD(ze_device_p2p_properties_t, flags, log_p2p_property_flags),
+};
 
-    str += "Device::properties_t::kernelTimestampValidBits : ";
-    str += std::to_string(val.kernelTimestampValidBits);
-    str += "\n";
+static constexpr field_table device_p2p_properties_table =
+    make_field_table<ze_device_p2p_properties_t>("ze_device_p2p_properties_t.", device_p2p_properties_fields);
 
-    str += "Device::properties_t::uuid : ";
-    str += to_string(val.uuid);
-    str += "\n";
+inline const field_table& get_field_table( const ze_device_p2p_properties_t& )
+{
+    return device_p2p_properties_table;
+}
 
-    str += "Device::properties_t::name : ";
-    str += val.name;
-    str += "\n";
+std::string to_string( const ze_device_p2p_properties_t val )
+{
+    return struct_to_string(val);
+}
 
-    return str;
+std::string to_string( const ze_device_uuid_t val )
+{
+    log_writer w;
+    log_device_uuid(w, &val);
+    return w.str();
 }
 
 
@@ -663,79 +996,57 @@ std::string to_string(const ze_api_version_t version) {
   return ss.str();
 }
 
+static constexpr enum_entry result_entries[] = {
+    {ZE_RESULT_SUCCESS, "ZE_RESULT_SUCCESS", nullptr},
+    {ZE_RESULT_NOT_READY, "ZE_RESULT_NOT_READY", nullptr},
+    {ZE_RESULT_ERROR_UNINITIALIZED, "ZE_RESULT_ERROR_UNINITIALIZED", nullptr},
+    {ZE_RESULT_ERROR_DEVICE_LOST, "ZE_RESULT_ERROR_DEVICE_LOST", nullptr},
+    {ZE_RESULT_ERROR_INVALID_ARGUMENT, "ZE_RESULT_ERROR_INVALID_ARGUMENT", nullptr},
+    {ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY, "ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY", nullptr},
+    {ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY, "ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY", nullptr},
+    {ZE_RESULT_ERROR_MODULE_BUILD_FAILURE, "ZE_RESULT_ERROR_MODULE_BUILD_FAILURE", nullptr},
+    {ZE_RESULT_ERROR_INSUFFICIENT_PERMISSIONS, "ZE_RESULT_ERROR_INSUFFICIENT_PERMISSIONS", nullptr},
+    {ZE_RESULT_ERROR_NOT_AVAILABLE, "ZE_RESULT_ERROR_NOT_AVAILABLE", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_VERSION, "ZE_RESULT_ERROR_UNSUPPORTED_VERSION", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_FEATURE, "ZE_RESULT_ERROR_UNSUPPORTED_FEATURE", nullptr},
+    {ZE_RESULT_ERROR_INVALID_NULL_HANDLE, "ZE_RESULT_ERROR_INVALID_NULL_HANDLE", nullptr},
+    {ZE_RESULT_ERROR_HANDLE_OBJECT_IN_USE, "ZE_RESULT_ERROR_HANDLE_OBJECT_IN_USE", nullptr},
+    {ZE_RESULT_ERROR_INVALID_NULL_POINTER, "ZE_RESULT_ERROR_INVALID_NULL_POINTER", nullptr},
+    {ZE_RESULT_ERROR_INVALID_SIZE, "ZE_RESULT_ERROR_INVALID_SIZE", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_SIZE, "ZE_RESULT_ERROR_UNSUPPORTED_SIZE", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_ALIGNMENT, "ZE_RESULT_ERROR_UNSUPPORTED_ALIGNMENT", nullptr},
+    {ZE_RESULT_ERROR_INVALID_SYNCHRONIZATION_OBJECT, "ZE_RESULT_ERROR_INVALID_SYNCHRONIZATION_OBJECT", nullptr},
+    {ZE_RESULT_ERROR_INVALID_ENUMERATION, "ZE_RESULT_ERROR_INVALID_ENUMERATION", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_ENUMERATION, "ZE_RESULT_ERROR_UNSUPPORTED_ENUMERATION", nullptr},
+    {ZE_RESULT_ERROR_UNSUPPORTED_IMAGE_FORMAT, "ZE_RESULT_ERROR_UNSUPPORTED_IMAGE_FORMAT", nullptr},
+    {ZE_RESULT_ERROR_INVALID_NATIVE_BINARY, "ZE_RESULT_ERROR_INVALID_NATIVE_BINARY", nullptr},
+    {ZE_RESULT_ERROR_INVALID_GLOBAL_NAME, "ZE_RESULT_ERROR_INVALID_GLOBAL_NAME", nullptr},
+    {ZE_RESULT_ERROR_INVALID_KERNEL_NAME, "ZE_RESULT_ERROR_INVALID_KERNEL_NAME", nullptr},
+    {ZE_RESULT_ERROR_INVALID_FUNCTION_NAME, "ZE_RESULT_ERROR_INVALID_FUNCTION_NAME", nullptr},
+    {ZE_RESULT_ERROR_INVALID_GROUP_SIZE_DIMENSION, "ZE_RESULT_ERROR_INVALID_GROUP_SIZE_DIMENSION", nullptr},
+    {ZE_RESULT_ERROR_INVALID_GLOBAL_WIDTH_DIMENSION, "ZE_RESULT_ERROR_INVALID_GLOBAL_WIDTH_DIMENSION", nullptr},
+    {ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_INDEX, "ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_INDEX", nullptr},
+    {ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE, "ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE", nullptr},
+    {ZE_RESULT_ERROR_INVALID_KERNEL_ATTRIBUTE_VALUE, "ZE_RESULT_ERROR_INVALID_KERNEL_ATTRIBUTE_VALUE", nullptr},
+    {ZE_RESULT_ERROR_INVALID_COMMAND_LIST_TYPE, "ZE_RESULT_ERROR_INVALID_COMMAND_LIST_TYPE", nullptr},
+    {ZE_RESULT_ERROR_OVERLAPPING_REGIONS, "ZE_RESULT_ERROR_OVERLAPPING_REGIONS", nullptr},
+    {ZE_RESULT_ERROR_UNKNOWN, "ZE_RESULT_ERROR_UNKNOWN", nullptr},
+};
+
+static constexpr auto result_values =
+    make_enum_value_hash_table(result_entries);
+
+const char* result_name(const ze_result_t result) {
+  return enum_name(result_entries, result_values, result);
+}
+
 std::string to_string(const ze_result_t result) {
-  if (result == ZE_RESULT_SUCCESS) {
-    return "ZE_RESULT_SUCCESS";
-  } else if (result == ZE_RESULT_NOT_READY) {
-    return "ZE_RESULT_NOT_READY";
-  } else if (result == ZE_RESULT_ERROR_UNINITIALIZED) {
-    return "ZE_RESULT_ERROR_UNINITIALIZED";
-  } else if (result == ZE_RESULT_ERROR_DEVICE_LOST) {
-    return "ZE_RESULT_ERROR_DEVICE_LOST";
-  } else if (result == ZE_RESULT_ERROR_INVALID_ARGUMENT) {
-    return "ZE_RESULT_ERROR_INVALID_ARGUMENT";
-  } else if (result == ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY) {
-    return "ZE_RESULT_ERROR_OUT_OF_HOST_MEMORY";
-  } else if (result == ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY) {
-    return "ZE_RESULT_ERROR_OUT_OF_DEVICE_MEMORY";
-  } else if (result == ZE_RESULT_ERROR_MODULE_BUILD_FAILURE) {
-    return "ZE_RESULT_ERROR_MODULE_BUILD_FAILURE";
-  } else if (result == ZE_RESULT_ERROR_INSUFFICIENT_PERMISSIONS) {
-    return "ZE_RESULT_ERROR_INSUFFICIENT_PERMISSIONS";
-  } else if (result == ZE_RESULT_ERROR_NOT_AVAILABLE) {
-    return "ZE_RESULT_ERROR_NOT_AVAILABLE";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_VERSION) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_VERSION";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_FEATURE) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_FEATURE";
-  } else if (result == ZE_RESULT_ERROR_INVALID_NULL_HANDLE) {
-    return "ZE_RESULT_ERROR_INVALID_NULL_HANDLE";
-  } else if (result == ZE_RESULT_ERROR_HANDLE_OBJECT_IN_USE) {
-    return "ZE_RESULT_ERROR_HANDLE_OBJECT_IN_USE";
-  } else if (result == ZE_RESULT_ERROR_INVALID_NULL_POINTER) {
-    return "ZE_RESULT_ERROR_INVALID_NULL_POINTER";
-  } else if (result == ZE_RESULT_ERROR_INVALID_SIZE) {
-    return "ZE_RESULT_ERROR_INVALID_SIZE";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_SIZE) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_SIZE";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_ALIGNMENT) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_ALIGNMENT";
-  } else if (result == ZE_RESULT_ERROR_INVALID_SYNCHRONIZATION_OBJECT) {
-    return "ZE_RESULT_ERROR_INVALID_SYNCHRONIZATION_OBJECT";
-  } else if (result == ZE_RESULT_ERROR_INVALID_ENUMERATION) {
-    return "ZE_RESULT_ERROR_INVALID_ENUMERATION";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_ENUMERATION) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_ENUMERATION";
-  } else if (result == ZE_RESULT_ERROR_UNSUPPORTED_IMAGE_FORMAT) {
-    return "ZE_RESULT_ERROR_UNSUPPORTED_IMAGE_FORMAT";
-  } else if (result == ZE_RESULT_ERROR_INVALID_NATIVE_BINARY) {
-    return "ZE_RESULT_ERROR_INVALID_NATIVE_BINARY";
-  } else if (result == ZE_RESULT_ERROR_INVALID_GLOBAL_NAME) {
-    return "ZE_RESULT_ERROR_INVALID_GLOBAL_NAME";
-  } else if (result == ZE_RESULT_ERROR_INVALID_KERNEL_NAME) {
-    return "ZE_RESULT_ERROR_INVALID_KERNEL_NAME";
-  } else if (result == ZE_RESULT_ERROR_INVALID_FUNCTION_NAME) {
-    return "ZE_RESULT_ERROR_INVALID_FUNCTION_NAME";
-  } else if (result == ZE_RESULT_ERROR_INVALID_GROUP_SIZE_DIMENSION) {
-    return "ZE_RESULT_ERROR_INVALID_GROUP_SIZE_DIMENSION";
-  } else if (result == ZE_RESULT_ERROR_INVALID_GLOBAL_WIDTH_DIMENSION) {
-    return "ZE_RESULT_ERROR_INVALID_GLOBAL_WIDTH_DIMENSION";
-  } else if (result == ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_INDEX) {
-    return "ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_INDEX";
-  } else if (result == ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE) {
-    return "ZE_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE";
-  } else if (result == ZE_RESULT_ERROR_INVALID_KERNEL_ATTRIBUTE_VALUE) {
-    return "ZE_RESULT_ERROR_INVALID_KERNEL_ATTRIBUTE_VALUE";
-  } else if (result == ZE_RESULT_ERROR_INVALID_COMMAND_LIST_TYPE) {
-    return "ZE_RESULT_ERROR_INVALID_COMMAND_LIST_TYPE";
-  } else if (result == ZE_RESULT_ERROR_OVERLAPPING_REGIONS) {
-    return "ZE_RESULT_ERROR_OVERLAPPING_REGIONS";
-  } else if (result == ZE_RESULT_ERROR_UNKNOWN) {
-    return "ZE_RESULT_ERROR_UNKNOWN";
-  } else {
+  const char* name = result_name(result);
+  if (name == nullptr) {
     throw std::runtime_error("Unknown ze_result_t value: " +
                              std::to_string(static_cast<int>(result)));
   }
+  return name;
 }
 
 std::string to_string(const ze_bool_t ze_bool) {
@@ -759,211 +1070,183 @@ std::string to_string(const ze_command_queue_flag_t flags) {
   }
 }
 
+static constexpr enum_entry command_queue_mode_entries[] = {
+    {ZE_COMMAND_QUEUE_MODE_DEFAULT, "ZE_COMMAND_QUEUE_MODE_DEFAULT", nullptr},
+    {ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS, "ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS", nullptr},
+    {ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS, "ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS", nullptr},
+};
+
+static constexpr auto command_queue_mode_values =
+    make_enum_value_hash_table(command_queue_mode_entries);
+
+const char* command_queue_mode_name(const ze_command_queue_mode_t mode) {
+  return enum_name(command_queue_mode_entries, command_queue_mode_values, mode);
+}
+
 std::string to_string(const ze_command_queue_mode_t mode) {
-  if (mode == ZE_COMMAND_QUEUE_MODE_DEFAULT) {
-    return "ZE_COMMAND_QUEUE_MODE_DEFAULT";
-  } else if (mode == ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS) {
-    return "ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS";
-  } else if (mode == ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS) {
-    return "ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS";
-  } else {
+  const char* name = command_queue_mode_name(mode);
+  if (name == nullptr) {
     return "Unknown ze_command_queue_mode_t value: " +
            std::to_string(static_cast<int>(mode));
   }
+  return name;
+}
+
+static constexpr enum_entry command_queue_priority_entries[] = {
+    {ZE_COMMAND_QUEUE_PRIORITY_NORMAL, "ZE_COMMAND_QUEUE_PRIORITY_NORMAL", nullptr},
+    {ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_LOW, "ZE_COMMAND_QUEUE_PRIORITY_LOW", nullptr},
+    {ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_HIGH, "ZE_COMMAND_QUEUE_PRIORITY_HIGH", nullptr},
+};
+
+static constexpr auto command_queue_priority_values =
+    make_enum_value_hash_table(command_queue_priority_entries);
+
+const char* command_queue_priority_name(const ze_command_queue_priority_t priority) {
+  return enum_name(command_queue_priority_entries,
+                   command_queue_priority_values, priority);
 }
 
 std::string to_string(const ze_command_queue_priority_t priority) {
-  if (priority == ZE_COMMAND_QUEUE_PRIORITY_NORMAL) {
-    return "ZE_COMMAND_QUEUE_PRIORITY_NORMAL";
-  } else if (priority == ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_LOW) {
-    return "ZE_COMMAND_QUEUE_PRIORITY_LOW";
-  } else if (priority == ZE_COMMAND_QUEUE_PRIORITY_PRIORITY_HIGH) {
-    return "ZE_COMMAND_QUEUE_PRIORITY_HIGH";
-  } else {
+  const char* name = command_queue_priority_name(priority);
+  if (name == nullptr) {
     return "Unknown ze_command_queue_priority_t value: " +
            std::to_string(static_cast<int>(priority));
   }
+  return name;
+}
+
+static constexpr enum_entry image_format_layout_entries[] = {
+    {ZE_IMAGE_FORMAT_LAYOUT_8, "ZE_IMAGE_FORMAT_LAYOUT_8", "8"},
+    {ZE_IMAGE_FORMAT_LAYOUT_16, "ZE_IMAGE_FORMAT_LAYOUT_16", "16"},
+    {ZE_IMAGE_FORMAT_LAYOUT_32, "ZE_IMAGE_FORMAT_LAYOUT_32", "32"},
+    {ZE_IMAGE_FORMAT_LAYOUT_8_8, "ZE_IMAGE_FORMAT_LAYOUT_8_8", "8_8"},
+    {ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8, "ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8", "8_8_8_8"},
+    {ZE_IMAGE_FORMAT_LAYOUT_16_16, "ZE_IMAGE_FORMAT_LAYOUT_16_16", "16_16"},
+    {ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16, "ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16", "16_16_16_16"},
+    {ZE_IMAGE_FORMAT_LAYOUT_32_32, "ZE_IMAGE_FORMAT_LAYOUT_32_32", "32_32"},
+    {ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32, "ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32", "32_32_32_32"},
+    {ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2, "ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2", "10_10_10_2"},
+    {ZE_IMAGE_FORMAT_LAYOUT_11_11_10, "ZE_IMAGE_FORMAT_LAYOUT_11_11_10", "11_11_10"},
+    {ZE_IMAGE_FORMAT_LAYOUT_5_6_5, "ZE_IMAGE_FORMAT_LAYOUT_5_6_5", "5_6_5"},
+    {ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1, "ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1", "5_5_5_1"},
+    {ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4, "ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4", "4_4_4_4"},
+    {ZE_IMAGE_FORMAT_LAYOUT_Y8, "ZE_IMAGE_FORMAT_LAYOUT_Y8", "Y8"},
+    {ZE_IMAGE_FORMAT_LAYOUT_NV12, "ZE_IMAGE_FORMAT_LAYOUT_NV12", "NV12"},
+    {ZE_IMAGE_FORMAT_LAYOUT_YUYV, "ZE_IMAGE_FORMAT_LAYOUT_YUYV", "YUYV"},
+    {ZE_IMAGE_FORMAT_LAYOUT_VYUY, "ZE_IMAGE_FORMAT_LAYOUT_VYUY", "VYUY"},
+    {ZE_IMAGE_FORMAT_LAYOUT_YVYU, "ZE_IMAGE_FORMAT_LAYOUT_YVYU", "YVYU"},
+    {ZE_IMAGE_FORMAT_LAYOUT_UYVY, "ZE_IMAGE_FORMAT_LAYOUT_UYVY", "UYVY"},
+    {ZE_IMAGE_FORMAT_LAYOUT_AYUV, "ZE_IMAGE_FORMAT_LAYOUT_AYUV", "AYUV"},
+    {ZE_IMAGE_FORMAT_LAYOUT_P010, "ZE_IMAGE_FORMAT_LAYOUT_P010", "P010"},
+    {ZE_IMAGE_FORMAT_LAYOUT_Y410, "ZE_IMAGE_FORMAT_LAYOUT_Y410", "Y410"},
+    {ZE_IMAGE_FORMAT_LAYOUT_P012, "ZE_IMAGE_FORMAT_LAYOUT_P012", "P012"},
+    {ZE_IMAGE_FORMAT_LAYOUT_Y16, "ZE_IMAGE_FORMAT_LAYOUT_Y16", "Y16"},
+    {ZE_IMAGE_FORMAT_LAYOUT_P016, "ZE_IMAGE_FORMAT_LAYOUT_P016", "P016"},
+    {ZE_IMAGE_FORMAT_LAYOUT_Y216, "ZE_IMAGE_FORMAT_LAYOUT_Y216", "Y216"},
+    {ZE_IMAGE_FORMAT_LAYOUT_P216, "ZE_IMAGE_FORMAT_LAYOUT_P216", "P216"},
+};
+
+static constexpr auto image_format_layout_keys =
+    make_enum_key_hash_table(image_format_layout_entries);
+
+static constexpr auto image_format_layout_values =
+    make_enum_value_hash_table(image_format_layout_entries);
+
+const char* image_format_layout_name(const ze_image_format_layout_t layout) {
+  return enum_name(image_format_layout_entries,
+                   image_format_layout_values, layout);
 }
 
 std::string to_string(const ze_image_format_layout_t layout) {
-  if (layout == ZE_IMAGE_FORMAT_LAYOUT_8) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_8";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_16";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_32";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_8_8) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_8_8";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16_16) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_16_16";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32_32) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_32_32";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_11_11_10) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_11_11_10";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_5_6_5) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_5_6_5";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y8) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_Y8";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_NV12) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_NV12";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_YUYV) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_YUYV";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_VYUY) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_VYUY";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_YVYU) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_YVYU";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_UYVY) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_UYVY";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_AYUV) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_AYUV";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P010) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_P010";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y410) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_Y410";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P012) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_P012";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y16) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_Y16";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P016) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_P016";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y216) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_Y216";
-  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P216) {
-    return "ZE_IMAGE_FORMAT_LAYOUT_P216";
-  } else {
+  const char* name = image_format_layout_name(layout);
+  if (name == nullptr) {
     return "Unknown ze_image_format_layout_t value: " +
            std::to_string(static_cast<int>(layout));
   }
+  return name;
 }
 
-ze_image_format_layout_t to_layout(const std::string layout) {
-  if (layout == "8") {
-    return ZE_IMAGE_FORMAT_LAYOUT_8;
-  } else if (layout == "16") {
-    return ZE_IMAGE_FORMAT_LAYOUT_16;
-  } else if (layout == "32") {
-    return ZE_IMAGE_FORMAT_LAYOUT_32;
-  } else if (layout == "8_8") {
-    return ZE_IMAGE_FORMAT_LAYOUT_8_8;
-  } else if (layout == "8_8_8_8") {
-    return ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8;
-  } else if (layout == "16_16") {
-    return ZE_IMAGE_FORMAT_LAYOUT_16_16;
-  } else if (layout == "16_16_16_16") {
-    return ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16;
-  } else if (layout == "32_32") {
-    return ZE_IMAGE_FORMAT_LAYOUT_32_32;
-  } else if (layout == "32_32_32_32") {
-    return ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32;
-  } else if (layout == "10_10_10_2") {
-    return ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2;
-  } else if (layout == "11_11_10") {
-    return ZE_IMAGE_FORMAT_LAYOUT_11_11_10;
-  } else if (layout == "5_6_5") {
-    return ZE_IMAGE_FORMAT_LAYOUT_5_6_5;
-  } else if (layout == "5_5_5_1") {
-    return ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1;
-  } else if (layout == "4_4_4_4") {
-    return ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4;
-  } else if (layout == "Y8") {
-    return ZE_IMAGE_FORMAT_LAYOUT_Y8;
-  } else if (layout == "NV12") {
-    return ZE_IMAGE_FORMAT_LAYOUT_NV12;
-  } else if (layout == "YUYV") {
-    return ZE_IMAGE_FORMAT_LAYOUT_YUYV;
-  } else if (layout == "VYUY") {
-    return ZE_IMAGE_FORMAT_LAYOUT_VYUY;
-  } else if (layout == "YVYU") {
-    return ZE_IMAGE_FORMAT_LAYOUT_YVYU;
-  } else if (layout == "UYVY") {
-    return ZE_IMAGE_FORMAT_LAYOUT_UYVY;
-  } else if (layout == "AYUV") {
-    return ZE_IMAGE_FORMAT_LAYOUT_AYUV;
-  } else if (layout == "P010") {
-    return ZE_IMAGE_FORMAT_LAYOUT_P010;
-  } else if (layout == "Y410") {
-    return ZE_IMAGE_FORMAT_LAYOUT_Y410;
-  } else if (layout == "P012") {
-    return ZE_IMAGE_FORMAT_LAYOUT_P012;
-  } else if (layout == "Y16") {
-    return ZE_IMAGE_FORMAT_LAYOUT_Y16;
-  } else if (layout == "P016") {
-    return ZE_IMAGE_FORMAT_LAYOUT_P016;
-  } else if (layout == "Y216") {
-    return ZE_IMAGE_FORMAT_LAYOUT_Y216;
-  } else if (layout == "P216") {
-    return ZE_IMAGE_FORMAT_LAYOUT_P216;
-  } else {
-    std::cout << "Unknown ze_image_format_layout_t value: " << layout;
+ze_image_format_layout_t to_layout(const char* layout, size_t len) {
+  const enum_entry* e = find_enum_key(image_format_layout_entries,
+                                      image_format_layout_keys, layout, len);
+  if (e == nullptr) {
+    std::cout << "Unknown ze_image_format_layout_t value: ";
+    std::cout.write(layout, len);
     return static_cast<ze_image_format_layout_t>(-1);
   }
+  return static_cast<ze_image_format_layout_t>(e->value);
+}
+
+ze_image_format_layout_t to_layout(const std::string& layout) {
+  return to_layout(layout.data(), layout.size());
+}
+
+static constexpr enum_entry image_format_type_entries[] = {
+    {ZE_IMAGE_FORMAT_TYPE_UINT, "ZE_IMAGE_FORMAT_TYPE_UINT", "UINT"},
+    {ZE_IMAGE_FORMAT_TYPE_SINT, "ZE_IMAGE_FORMAT_TYPE_SINT", "SINT"},
+    {ZE_IMAGE_FORMAT_TYPE_UNORM, "ZE_IMAGE_FORMAT_TYPE_UNORM", "UNORM"},
+    {ZE_IMAGE_FORMAT_TYPE_SNORM, "ZE_IMAGE_FORMAT_TYPE_SNORM", "SNORM"},
+    {ZE_IMAGE_FORMAT_TYPE_FLOAT, "ZE_IMAGE_FORMAT_TYPE_FLOAT", "FLOAT"},
+};
+
+static constexpr auto image_format_type_keys =
+    make_enum_key_hash_table(image_format_type_entries);
+
+static constexpr auto image_format_type_values =
+    make_enum_value_hash_table(image_format_type_entries);
+
+const char* image_format_type_name(const ze_image_format_type_t type) {
+  return enum_name(image_format_type_entries, image_format_type_values, type);
 }
 
 std::string to_string(const ze_image_format_type_t type) {
-  if (type == ZE_IMAGE_FORMAT_TYPE_UINT) {
-    return "ZE_IMAGE_FORMAT_TYPE_UINT";
-  } else if (type == ZE_IMAGE_FORMAT_TYPE_SINT) {
-    return "ZE_IMAGE_FORMAT_TYPE_SINT";
-  } else if (type == ZE_IMAGE_FORMAT_TYPE_UNORM) {
-    return "ZE_IMAGE_FORMAT_TYPE_UNORM";
-  } else if (type == ZE_IMAGE_FORMAT_TYPE_SNORM) {
-    return "ZE_IMAGE_FORMAT_TYPE_SNORM";
-  } else if (type == ZE_IMAGE_FORMAT_TYPE_FLOAT) {
-    return "ZE_IMAGE_FORMAT_TYPE_FLOAT";
-  } else {
+  const char* name = image_format_type_name(type);
+  if (name == nullptr) {
     return "Unknown ze_image_format_type_t value: " +
            std::to_string(static_cast<int>(type));
   }
+  return name;
 }
 
-ze_image_format_type_t to_format_type(const std::string format_type) {
-  if (format_type == "UINT") {
-    return ZE_IMAGE_FORMAT_TYPE_UINT;
-  } else if (format_type == "SINT") {
-    return ZE_IMAGE_FORMAT_TYPE_SINT;
-  } else if (format_type == "UNORM") {
-    return ZE_IMAGE_FORMAT_TYPE_UNORM;
-  } else if (format_type == "SNORM") {
-    return ZE_IMAGE_FORMAT_TYPE_SNORM;
-  } else if (format_type == "FLOAT") {
-    return ZE_IMAGE_FORMAT_TYPE_FLOAT;
-  } else {
+ze_image_format_type_t to_format_type(const char* format_type, size_t len) {
+  const enum_entry* e = find_enum_key(image_format_type_entries,
+                                      image_format_type_keys, format_type, len);
+  if (e == nullptr) {
     std::cout << "Unknown ze_image_format_type_t value: ";
     return (static_cast<ze_image_format_type_t>(-1));
   }
+  return static_cast<ze_image_format_type_t>(e->value);
+}
+
+ze_image_format_type_t to_format_type(const std::string& format_type) {
+  return to_format_type(format_type.data(), format_type.size());
+}
+
+static constexpr enum_entry image_format_swizzle_entries[] = {
+    {ZE_IMAGE_FORMAT_SWIZZLE_R, "ZE_IMAGE_FORMAT_SWIZZLE_R", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_G, "ZE_IMAGE_FORMAT_SWIZZLE_G", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_B, "ZE_IMAGE_FORMAT_SWIZZLE_B", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_A, "ZE_IMAGE_FORMAT_SWIZZLE_A", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_0, "ZE_IMAGE_FORMAT_SWIZZLE_0", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_1, "ZE_IMAGE_FORMAT_SWIZZLE_1", nullptr},
+    {ZE_IMAGE_FORMAT_SWIZZLE_X, "ZE_IMAGE_FORMAT_SWIZZLE_X", nullptr},
+};
+
+static constexpr auto image_format_swizzle_values =
+    make_enum_value_hash_table(image_format_swizzle_entries);
+
+const char* image_format_swizzle_name(const ze_image_format_swizzle_t swizzle) {
+  return enum_name(image_format_swizzle_entries,
+                   image_format_swizzle_values, swizzle);
 }
 
 std::string to_string(const ze_image_format_swizzle_t swizzle) {
-  if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_R) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_R";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_G) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_G";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_B) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_B";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_A) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_A";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_0) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_0";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_1) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_1";
-  } else if (swizzle == ZE_IMAGE_FORMAT_SWIZZLE_X) {
-    return "ZE_IMAGE_FORMAT_SWIZZLE_X";
-  } else {
+  const char* name = image_format_swizzle_name(swizzle);
+  if (name == nullptr) {
     return "Unknown ze_image_format_swizzle_t value: " +
            std::to_string(static_cast<int>(swizzle));
   }
+  return name;
 }
 
 std::string to_string(const ze_image_flag_t flag) {
@@ -978,17 +1261,28 @@ std::string to_string(const ze_image_flag_t flag) {
   return flags;
 }
 
-ze_image_flag_t to_flag(const std::string flag) {
+// Searches for a substring within the first len characters of s.
+inline bool contains(const char* s, size_t len, const char* sub) {
+  const size_t sublen = strlen(sub);
+  for (size_t i = 0; i + sublen <= len; i++) {
+    if (memcmp(s + i, sub, sublen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ze_image_flag_t to_flag(const char* flag, size_t len) {
 
   // by default setting to READ
   ze_image_flag_t image_flags = {};
 
   // check if "READ" position is found in flag string
-  if (flag.find("WRITE") != std::string::npos) {
+  if (contains(flag, len, "WRITE")) {
     image_flags =
         static_cast<ze_image_flag_t>(image_flags | ZE_IMAGE_FLAG_KERNEL_WRITE);
   }
-  if (flag.find("UNCACHED") != std::string::npos) {
+  if (contains(flag, len, "UNCACHED")) {
     image_flags =
         static_cast<ze_image_flag_t>(image_flags | ZE_IMAGE_FLAG_BIAS_UNCACHED);
   }
@@ -996,38 +1290,49 @@ ze_image_flag_t to_flag(const std::string flag) {
   return image_flags;
 }
 
+ze_image_flag_t to_flag(const std::string& flag) {
+  return to_flag(flag.data(), flag.size());
+}
+
+static constexpr enum_entry image_type_entries[] = {
+    {ZE_IMAGE_TYPE_1D, "ZE_IMAGE_TYPE_1D", "1D"},
+    {ZE_IMAGE_TYPE_2D, "ZE_IMAGE_TYPE_2D", "2D"},
+    {ZE_IMAGE_TYPE_3D, "ZE_IMAGE_TYPE_3D", "3D"},
+    {ZE_IMAGE_TYPE_1DARRAY, "ZE_IMAGE_TYPE_1DARRAY", "1DARRAY"},
+    {ZE_IMAGE_TYPE_2DARRAY, "ZE_IMAGE_TYPE_2DARRAY", "2DARRAY"},
+};
+
+static constexpr auto image_type_keys =
+    make_enum_key_hash_table(image_type_entries);
+
+static constexpr auto image_type_values =
+    make_enum_value_hash_table(image_type_entries);
+
+const char* image_type_name(const ze_image_type_t type) {
+  return enum_name(image_type_entries, image_type_values, type);
+}
+
 std::string to_string(const ze_image_type_t type) {
-  if (type == ZE_IMAGE_TYPE_1D) {
-    return "ZE_IMAGE_TYPE_1D";
-  } else if (type == ZE_IMAGE_TYPE_2D) {
-    return "ZE_IMAGE_TYPE_2D";
-  } else if (type == ZE_IMAGE_TYPE_3D) {
-    return "ZE_IMAGE_TYPE_3D";
-  } else if (type == ZE_IMAGE_TYPE_1DARRAY) {
-    return "ZE_IMAGE_TYPE_1DARRAY";
-  } else if (type == ZE_IMAGE_TYPE_2DARRAY) {
-    return "ZE_IMAGE_TYPE_2DARRAY";
-  } else {
+  const char* name = image_type_name(type);
+  if (name == nullptr) {
     return "Unknown ze_image_type_t value: " +
            std::to_string(static_cast<int>(type));
   }
+  return name;
 }
 
-ze_image_type_t to_image_type(const std::string type) {
-  if (type == "1D") {
-    return ZE_IMAGE_TYPE_1D;
-  } else if (type == "2D") {
-    return ZE_IMAGE_TYPE_2D;
-  } else if (type == "3D") {
-    return ZE_IMAGE_TYPE_3D;
-  } else if (type == "1DARRAY") {
-    return ZE_IMAGE_TYPE_1DARRAY;
-  } else if (type == "2DARRAY") {
-    return ZE_IMAGE_TYPE_2DARRAY;
-  } else {
+ze_image_type_t to_image_type(const char* type, size_t len) {
+  const enum_entry* e = find_enum_key(image_type_entries, image_type_keys,
+                                      type, len);
+  if (e == nullptr) {
     std::cout << "Unknown ze_image_type_t value: ";
     return (static_cast<ze_image_type_t>(-1));
   }
+  return static_cast<ze_image_type_t>(e->value);
+}
+
+ze_image_type_t to_image_type(const std::string& type) {
+  return to_image_type(type.data(), type.size());
 }
 
 std::string to_string(const ze_driver_uuid_t uuid) {
@@ -1049,58 +1354,3 @@ std::string to_string(const ze_native_kernel_uuid_t uuid) {
   result << "\b}";
   return result.str();
 }
-
-std::string command_queue_group_property_flags_to_string(
-    const ze_command_queue_group_property_flags_t flags)
-{
-  std::string flags_str = "";
-  if (flags == 0) {
-    flags_str.append("|NONE|");
-    return flags_str;
-  }
-  if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) {
-    flags_str.append("|ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE|");
-  }
-  if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) {
-    flags_str.append("|ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY|");
-  }
-  if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COOPERATIVE_KERNELS) {
-    flags_str.append("|ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COOPERATIVE_KERNELS|");
-  }
-  if (flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_METRICS) {
-    flags_str.append("|ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_METRICS|");
-  }
-  return flags_str;
-}
-
-std::string to_string(const ze_command_queue_group_properties_t props)
-{
-    std::string str;
-
-    str += "ze_command_queue_group_properties_t.stype : ";
-    str += to_string(props.stype);
-    str += "\n";
-
-    str += "ze_command_queue_group_properties_t.pNext : ";
-    {
-        std::stringstream ss;
-        ss << "0x" << std::hex << reinterpret_cast<size_t>(props.pNext);
-        str += ss.str();
-    }
-    str += "\n";
-
-    str += "ze_command_queue_group_properties_t.flags : ";
-    str += command_queue_group_property_flags_to_string(props.flags);
-    str += "\n";
-
-    str += "ze_command_queue_group_properties_t.maxMemoryFillPatternSize : ";
-    str += std::to_string(props.maxMemoryFillPatternSize);
-    str += "\n";
-
-    str += "ze_command_queue_group_properties_t.numQueues : ";
-    str += std::to_string(props.numQueues);
-    str += "\n";
-
-    return str;
-}
-
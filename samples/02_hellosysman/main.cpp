@@ -22,10 +22,15 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
 #include <vector>
 #include <popl/popl.hpp>
 
 #include "zes_api.h"
+#include "lzutil/spsc_ring.hpp"
 
 #if defined(_WIN32)
 #define SETENV( _name, _value ) _putenv_s( _name, _value )
@@ -41,12 +46,263 @@
         }                                                                   \
     } while (0)
 
+using clk = std::chrono::steady_clock;
+
+enum Metric : uint32_t {
+    METRIC_MEM_STATE,       // value0 = free, value1 = size
+    METRIC_MEM_BANDWIDTH,   // value0 = readCounter, value1 = writeCounter, value2 = timestamp
+    METRIC_ENGINE,          // value0 = activeTime, value1 = timestamp, value2 = engine type
+    METRIC_FREQUENCY,       // value0 = actual MHz, value1 = request MHz, value2 = throttle reasons
+    METRIC_POWER,           // value0 = energy, value1 = timestamp
+    METRIC_COUNT,
+};
+
+static const char* metricNames[METRIC_COUNT] = {
+    "mem_state",
+    "mem_bandwidth",
+    "engine",
+    "frequency",
+    "power",
+};
+
+struct Sample {
+    uint64_t    hostNs;
+    uint32_t    device;
+    uint32_t    metric;
+    uint32_t    index;
+    uint64_t    value0;
+    uint64_t    value1;
+    uint64_t    value2;
+};
+
+struct SysmanDevice {
+    std::vector<zes_mem_handle_t>       memories;
+    std::vector<zes_engine_handle_t>    engines;
+    std::vector<zes_engine_group_t>     engineTypes;
+    std::vector<zes_freq_handle_t>      frequencies;
+    std::vector<zes_pwr_handle_t>       powers;
+};
+
+template<typename T, typename F>
+static std::vector<T> Enumerate(
+    zes_device_handle_t hSDevice,
+    F func )
+{
+    uint32_t count = 0;
+    func(hSDevice, &count, nullptr);
+    std::vector<T> handles(count);
+    func(hSDevice, &count, handles.data());
+    handles.resize(count);
+    return handles;
+}
+
+static SysmanDevice GetSysmanDevice(
+    zes_device_handle_t hSDevice )
+{
+    SysmanDevice dev;
+    dev.memories = Enumerate<zes_mem_handle_t>(hSDevice, zesDeviceEnumMemoryModules);
+    dev.engines = Enumerate<zes_engine_handle_t>(hSDevice, zesDeviceEnumEngineGroups);
+    dev.frequencies = Enumerate<zes_freq_handle_t>(hSDevice, zesDeviceEnumFrequencyDomains);
+    dev.powers = Enumerate<zes_pwr_handle_t>(hSDevice, zesDeviceEnumPowerDomains);
+
+    for (auto& engine : dev.engines) {
+        zes_engine_properties_t engineProps = {};
+        engineProps.stype = ZES_STRUCTURE_TYPE_ENGINE_PROPERTIES;
+        zesEngineGetProperties(engine, &engineProps);
+        dev.engineTypes.push_back(engineProps.type);
+    }
+
+    return dev;
+}
+
+struct SamplerStats {
+    uint64_t    polls = 0;
+    uint64_t    calls = 0;
+    uint64_t    failedCalls = 0;
+    clk::duration   pollTime = clk::duration(0);
+};
+
+// Polls every sysman handle once and pushes one sample per successful call.
+static void Poll(
+    const std::vector<SysmanDevice>& devices,
+    lzutil::SPSCRing<Sample>& ring,
+    SamplerStats& stats )
+{
+    auto start = clk::now();
+
+    Sample s = {};
+    auto push = [&](ze_result_t result) {
+        stats.calls++;
+        if (result == ZE_RESULT_SUCCESS) {
+            s.hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clk::now().time_since_epoch()).count();
+            ring.push(s);
+        } else {
+            stats.failedCalls++;
+        }
+    };
+
+    for (uint32_t d = 0; d < devices.size(); d++) {
+        const SysmanDevice& dev = devices[d];
+        s.device = d;
+
+        for (uint32_t m = 0; m < dev.memories.size(); m++) {
+            zes_mem_state_t memState = {};
+            memState.stype = ZES_STRUCTURE_TYPE_MEM_STATE;
+            ze_result_t result = zesMemoryGetState(dev.memories[m], &memState);
+            s.metric = METRIC_MEM_STATE;
+            s.index = m;
+            s.value0 = memState.free;
+            s.value1 = memState.size;
+            s.value2 = 0;
+            push(result);
+
+            zes_mem_bandwidth_t memBandwidth = {};
+            result = zesMemoryGetBandwidth(dev.memories[m], &memBandwidth);
+            s.metric = METRIC_MEM_BANDWIDTH;
+            s.value0 = memBandwidth.readCounter;
+            s.value1 = memBandwidth.writeCounter;
+            s.value2 = memBandwidth.timestamp;
+            push(result);
+        }
+
+        for (uint32_t e = 0; e < dev.engines.size(); e++) {
+            zes_engine_stats_t engineStats = {};
+            ze_result_t result = zesEngineGetActivity(dev.engines[e], &engineStats);
+            s.metric = METRIC_ENGINE;
+            s.index = e;
+            s.value0 = engineStats.activeTime;
+            s.value1 = engineStats.timestamp;
+            s.value2 = dev.engineTypes[e];
+            push(result);
+        }
+
+        for (uint32_t f = 0; f < dev.frequencies.size(); f++) {
+            zes_freq_state_t freqState = {};
+            freqState.stype = ZES_STRUCTURE_TYPE_FREQ_STATE;
+            ze_result_t result = zesFrequencyGetState(dev.frequencies[f], &freqState);
+            s.metric = METRIC_FREQUENCY;
+            s.index = f;
+            s.value0 = (uint64_t)freqState.actual;
+            s.value1 = (uint64_t)freqState.request;
+            s.value2 = freqState.throttleReasons;
+            push(result);
+        }
+
+        for (uint32_t p = 0; p < dev.powers.size(); p++) {
+            zes_power_energy_counter_t energy = {};
+            ze_result_t result = zesPowerGetEnergyCounter(dev.powers[p], &energy);
+            s.metric = METRIC_POWER;
+            s.index = p;
+            s.value0 = energy.energy;
+            s.value1 = energy.timestamp;
+            s.value2 = 0;
+            push(result);
+        }
+    }
+
+    stats.polls++;
+    stats.pollTime += clk::now() - start;
+}
+
+static size_t Drain(
+    lzutil::SPSCRing<Sample>& ring,
+    FILE* fp )
+{
+    size_t count = 0;
+    Sample s;
+    while (ring.pop(s)) {
+        fprintf(fp, "%" PRIu64 ",%u,%s,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+            s.hostNs, s.device, metricNames[s.metric], s.index,
+            s.value0, s.value1, s.value2);
+        count++;
+    }
+    return count;
+}
+
+static void RunSampler(
+    const std::vector<SysmanDevice>& devices,
+    int intervalUs,
+    int durationMs,
+    size_t ringSize,
+    const std::string& csvFileName )
+{
+    FILE* fp = stdout;
+    if (!csvFileName.empty()) {
+        fp = fopen(csvFileName.c_str(), "w");
+        if (fp == nullptr) {
+            printf("Couldn't open file '%s'!\n", csvFileName.c_str());
+            return;
+        }
+    }
+
+    lzutil::SPSCRing<Sample> ring(ringSize);
+    std::atomic<bool> stop(false);
+    SamplerStats stats;
+
+    fprintf(fp, "host_ns,device,metric,index,value0,value1,value2\n");
+
+    auto start = clk::now();
+    std::thread producer([&]() {
+        auto next = clk::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+            Poll(devices, ring, stats);
+            next += std::chrono::microseconds(intervalUs);
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    // The consumer wakes up at a fixed, low rate and writes everything the
+    // producer has pushed since the last wakeup.
+    size_t written = 0;
+    auto end = start + std::chrono::milliseconds(durationMs);
+    while (clk::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        written += Drain(ring, fp);
+    }
+    stop.store(true);
+    producer.join();
+    written += Drain(ring, fp);
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    const double wallUs = std::chrono::duration<double, std::micro>(clk::now() - start).count();
+    const double pollUs = std::chrono::duration<double, std::micro>(stats.pollTime).count();
+
+    printf("Sampler Statistics:\n");
+    printf("\tpolls:          %" PRIu64 "\n", stats.polls);
+    printf("\tcalls:          %" PRIu64 " (%" PRIu64 " failed)\n", stats.calls, stats.failedCalls);
+    printf("\tsamples:        %zu written, %zu dropped\n", written, ring.dropped());
+    if (stats.polls != 0) {
+        printf("\ttime per poll:  %.3f us\n", pollUs / stats.polls);
+    }
+    if (stats.calls != 0) {
+        printf("\ttime per call:  %.3f us\n", pollUs / stats.calls);
+    }
+    if (wallUs > 0.0) {
+        printf("\toverhead:       %.4f%% of one core\n", 100.0 * pollUs / wallUs);
+    }
+}
+
 int main(
     int argc,
     char** argv )
 {
+    bool sample = false;
+    int intervalUs = 10000;
+    int durationMs = 10000;
+    size_t ringSize = 65536;
+    std::string csvFileName;
+
     {
         popl::OptionParser op("Supported Options");
+        op.add<popl::Switch>("", "sample", "Continuously Sample Telemetry", &sample);
+        op.add<popl::Value<int>>("", "interval", "Sampling Interval (us)", intervalUs, &intervalUs);
+        op.add<popl::Value<int>>("", "duration", "Sampling Duration (ms)", durationMs, &durationMs);
+        op.add<popl::Value<size_t>>("", "ringsize", "Sample Ring Buffer Entries", ringSize, &ringSize);
+        op.add<popl::Value<std::string>>("", "csv", "CSV Output File (default: stdout)", csvFileName, &csvFileName);
 
         bool printUsage = false;
         try {
@@ -56,9 +312,10 @@ int main(
             printUsage = true;
         }
 
-        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            intervalUs <= 0 || durationMs < 0 || ringSize == 0) {
             fprintf(stderr,
-                "Usage: enumlevelzero [options]\n"
+                "Usage: hellosysman [options]\n"
                 "%s", op.help().c_str());
             return -1;
         }
@@ -75,6 +332,8 @@ int main(
     std::vector<ze_driver_handle_t> drivers(driverCount);
     CHECK_CALL( zeDriverGet(&driverCount, drivers.data()) );
 
+    std::vector<SysmanDevice> sysmanDevices;
+
     for (auto& driver : drivers) {
         printf("Driver:\n");
 
@@ -120,10 +379,18 @@ int main(
                 printf("\t\tsize = %" PRIu64 "\n", memState.size);
                 printf("\t\tfree = %" PRIu64 "\n", memState.free);
             }
+
+            if (sample) {
+                sysmanDevices.push_back(GetSysmanDevice(hSDevice));
+            }
         }
         printf("\n");
     }
 
+    if (sample) {
+        RunSampler(sysmanDevices, intervalUs, durationMs, ringSize, csvFileName);
+    }
+
     printf( "Done.\n" );
 
     return 0;
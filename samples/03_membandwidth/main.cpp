@@ -0,0 +1,302 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+enum CopyType {
+    COPY_H2D,
+    COPY_D2H,
+    COPY_D2D,
+    COPY_S2D,
+    COPY_TYPE_COUNT,
+};
+
+static const char* copyTypeNames[COPY_TYPE_COUNT] = {
+    "H2D",
+    "D2H",
+    "D2D",
+    "S2D",
+};
+
+struct Buffers {
+    void*   host = nullptr;
+    void*   shared = nullptr;
+    void*   device = nullptr;
+    void*   device2 = nullptr;
+};
+
+static void GetCopyPointers(
+    const Buffers& buffers,
+    CopyType type,
+    void*& dst,
+    const void*& src )
+{
+    switch (type) {
+    case COPY_H2D: dst = buffers.device; src = buffers.host; break;
+    case COPY_D2H: dst = buffers.host; src = buffers.device; break;
+    case COPY_D2D: dst = buffers.device2; src = buffers.device; break;
+    case COPY_S2D: dst = buffers.device; src = buffers.shared; break;
+    default: dst = nullptr; src = nullptr; break;
+    }
+}
+
+static double ComputeGBps(
+    size_t size,
+    int iterations,
+    std::chrono::high_resolution_clock::duration elapsed )
+{
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0.0 ?
+        (double)size * iterations / seconds / 1e9 :
+        0.0;
+}
+
+static double TimeRegularCopies(
+    ze_command_queue_handle_t queue,
+    ze_command_list_handle_t cmdList,
+    void* dst,
+    const void* src,
+    size_t size,
+    int iterations )
+{
+    CHECK_CALL( zeCommandListReset(cmdList) );
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+    }
+    CHECK_CALL( zeCommandListClose(cmdList) );
+
+    auto start = std::chrono::high_resolution_clock::now();
+    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return ComputeGBps(size, iterations, end - start);
+}
+
+static double TimeImmediateCopies(
+    ze_command_list_handle_t cmdList,
+    void* dst,
+    const void* src,
+    size_t size,
+    int iterations )
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return ComputeGBps(size, iterations, end - start);
+}
+
+static void PrintHeader(
+    const char* label )
+{
+    printf("\t%s (GB/s):\n", label);
+    printf("\t%12s", "Size");
+    for (int t = 0; t < COPY_TYPE_COUNT; t++) {
+        printf(" %10s", copyTypeNames[t]);
+    }
+    printf("\n");
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t minSize = 4 * 1024;
+    size_t maxSize = 64 * 1024 * 1024;
+    int iterations = 16;
+    uint32_t ordinal = 0;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("", "minsize", "Minimum Copy Size (bytes)", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "maxsize", "Maximum Copy Size (bytes)", maxSize, &maxSize);
+        op.add<popl::Value<int>>("i", "iterations", "Copies per Size", iterations, &iterations);
+        op.add<popl::Value<uint32_t>>("", "ordinal", "Command Queue Group Ordinal", ordinal, &ordinal);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            minSize == 0 || maxSize < minSize || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: membandwidth [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            Buffers buffers;
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, maxSize, 0, &buffers.host) );
+            CHECK_CALL( zeMemAllocShared(context, &deviceDesc, &hostDesc, maxSize, 0, devices[i], &buffers.shared) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, maxSize, 0, devices[i], &buffers.device) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, maxSize, 0, devices[i], &buffers.device2) );
+
+            if (buffers.host == nullptr || buffers.shared == nullptr ||
+                buffers.device == nullptr || buffers.device2 == nullptr) {
+                printf("\tSkipping device, allocation failed.\n");
+            } else {
+                ze_command_queue_desc_t queueDesc = {};
+                queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+                queueDesc.ordinal = ordinal;
+                queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+                ze_command_queue_handle_t queue = nullptr;
+                CHECK_CALL( zeCommandQueueCreate(context, devices[i], &queueDesc, &queue) );
+
+                ze_command_list_desc_t cmdListDesc = {};
+                cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+                cmdListDesc.commandQueueGroupOrdinal = ordinal;
+
+                ze_command_list_handle_t cmdList = nullptr;
+                CHECK_CALL( zeCommandListCreate(context, devices[i], &cmdListDesc, &cmdList) );
+
+                // Immediate command lists are synchronous so that each append
+                // includes the time to complete the copy.
+                queueDesc.mode = ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
+
+                ze_command_list_handle_t immCmdList = nullptr;
+                CHECK_CALL( zeCommandListCreateImmediate(context, devices[i], &queueDesc, &immCmdList) );
+
+                // Touch every buffer once so first-use costs are not measured.
+                for (int t = 0; t < COPY_TYPE_COUNT; t++) {
+                    void* dst = nullptr;
+                    const void* src = nullptr;
+                    GetCopyPointers(buffers, (CopyType)t, dst, src);
+                    TimeImmediateCopies(immCmdList, dst, src, maxSize, 1);
+                }
+
+                PrintHeader("Regular Command List");
+                for (size_t size = minSize; size <= maxSize; size *= 2) {
+                    printf("\t%12zu", size);
+                    for (int t = 0; t < COPY_TYPE_COUNT; t++) {
+                        void* dst = nullptr;
+                        const void* src = nullptr;
+                        GetCopyPointers(buffers, (CopyType)t, dst, src);
+                        printf(" %10.2f", TimeRegularCopies(queue, cmdList, dst, src, size, iterations));
+                    }
+                    printf("\n");
+                }
+
+                PrintHeader("Immediate Command List");
+                for (size_t size = minSize; size <= maxSize; size *= 2) {
+                    printf("\t%12zu", size);
+                    for (int t = 0; t < COPY_TYPE_COUNT; t++) {
+                        void* dst = nullptr;
+                        const void* src = nullptr;
+                        GetCopyPointers(buffers, (CopyType)t, dst, src);
+                        printf(" %10.2f", TimeImmediateCopies(immCmdList, dst, src, size, iterations));
+                    }
+                    printf("\n");
+                }
+
+                CHECK_CALL( zeCommandListDestroy(immCmdList) );
+                CHECK_CALL( zeCommandListDestroy(cmdList) );
+                CHECK_CALL( zeCommandQueueDestroy(queue) );
+            }
+
+            if (buffers.host) CHECK_CALL( zeMemFree(context, buffers.host) );
+            if (buffers.shared) CHECK_CALL( zeMemFree(context, buffers.shared) );
+            if (buffers.device) CHECK_CALL( zeMemFree(context, buffers.device) );
+            if (buffers.device2) CHECK_CALL( zeMemFree(context, buffers.device2) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
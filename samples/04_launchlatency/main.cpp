@@ -0,0 +1,294 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static void PrintStats(
+    const char* label,
+    std::vector<double>& samples )
+{
+    if (samples.empty()) {
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const size_t count = samples.size();
+    const double median = samples[count / 2];
+    const double p99 = samples[std::min(count - 1, count * 99 / 100)];
+
+    printf("\t%-24s median: %10.2f us  p99: %10.2f us  (%zu samples)\n",
+        label, median, p99, count);
+}
+
+static double ElapsedMicroseconds(
+    clk::time_point start,
+    clk::time_point end )
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 1000;
+    int batchSize = 16;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Mode", iterations, &iterations);
+        op.add<popl::Value<int>>("b", "batch", "Kernel Launches per Batch", batchSize, &batchSize);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0 || batchSize <= 0) {
+            fprintf(stderr,
+                "Usage: launchlatency [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+
+            ze_group_count_t groupCount = { 1, 1, 1 };
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_fence_desc_t fenceDesc = {};
+            fenceDesc.stype = ZE_STRUCTURE_TYPE_FENCE_DESC;
+
+            ze_fence_handle_t fence = nullptr;
+            CHECK_CALL( zeFenceCreate(queue, &fenceDesc, &fence) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            std::vector<double> samples;
+            samples.reserve(iterations);
+
+            // (a) One kernel per regular command list execution, waiting on a fence.
+            {
+                ze_command_list_handle_t cmdList = nullptr;
+                CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+                CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListClose(cmdList) );
+
+                // warmup
+                CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, fence) );
+                CHECK_CALL( zeFenceHostSynchronize(fence, UINT64_MAX) );
+                CHECK_CALL( zeFenceReset(fence) );
+
+                samples.clear();
+                for (int it = 0; it < iterations; it++) {
+                    auto start = clk::now();
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, fence) );
+                    CHECK_CALL( zeFenceHostSynchronize(fence, UINT64_MAX) );
+                    auto end = clk::now();
+                    CHECK_CALL( zeFenceReset(fence) );
+                    samples.push_back(ElapsedMicroseconds(start, end));
+                }
+                PrintStats("Regular + Fence:", samples);
+
+                CHECK_CALL( zeCommandListDestroy(cmdList) );
+            }
+
+            // (b) One kernel per immediate command list append, waiting on an event.
+            {
+                ze_event_pool_desc_t eventPoolDesc = {};
+                eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+                eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+                eventPoolDesc.count = 1;
+
+                ze_event_pool_handle_t eventPool = nullptr;
+                CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &eventPool) );
+
+                ze_event_desc_t eventDesc = {};
+                eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+                eventDesc.index = 0;
+                eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+                eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+                ze_event_handle_t event = nullptr;
+                CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &event) );
+
+                ze_command_list_handle_t immCmdList = nullptr;
+                CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &immCmdList) );
+
+                // warmup
+                CHECK_CALL( zeCommandListAppendLaunchKernel(immCmdList, kernel, &groupCount, event, 0, nullptr) );
+                CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+                CHECK_CALL( zeEventHostReset(event) );
+
+                samples.clear();
+                for (int it = 0; it < iterations; it++) {
+                    auto start = clk::now();
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(immCmdList, kernel, &groupCount, event, 0, nullptr) );
+                    CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+                    auto end = clk::now();
+                    CHECK_CALL( zeEventHostReset(event) );
+                    samples.push_back(ElapsedMicroseconds(start, end));
+                }
+                PrintStats("Immediate + Event:", samples);
+
+                CHECK_CALL( zeCommandListDestroy(immCmdList) );
+                CHECK_CALL( zeEventDestroy(event) );
+                CHECK_CALL( zeEventPoolDestroy(eventPool) );
+            }
+
+            // (c) Batches of kernels per regular command list execution.
+            // Each sample is the per-launch cost of one batch.
+            {
+                ze_command_list_handle_t cmdList = nullptr;
+                CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+                for (int b = 0; b < batchSize; b++) {
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                }
+                CHECK_CALL( zeCommandListClose(cmdList) );
+
+                // warmup
+                CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, fence) );
+                CHECK_CALL( zeFenceHostSynchronize(fence, UINT64_MAX) );
+                CHECK_CALL( zeFenceReset(fence) );
+
+                samples.clear();
+                for (int it = 0; it < iterations; it++) {
+                    auto start = clk::now();
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, fence) );
+                    CHECK_CALL( zeFenceHostSynchronize(fence, UINT64_MAX) );
+                    auto end = clk::now();
+                    CHECK_CALL( zeFenceReset(fence) );
+                    samples.push_back(ElapsedMicroseconds(start, end) / batchSize);
+                }
+
+                char label[64];
+                snprintf(label, sizeof(label), "Batch of %d + Fence:", batchSize);
+                PrintStats(label, samples);
+
+                CHECK_CALL( zeCommandListDestroy(cmdList) );
+            }
+
+            CHECK_CALL( zeFenceDestroy(fence) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/usm_pool.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static const char* MemoryTypeName(
+    ze_memory_type_t type )
+{
+    switch (type) {
+    case ZE_MEMORY_TYPE_HOST: return "host";
+    case ZE_MEMORY_TYPE_DEVICE: return "device";
+    case ZE_MEMORY_TYPE_SHARED: return "shared";
+    default: return "unknown";
+    }
+}
+
+static ze_result_t RawAllocate(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    ze_memory_type_t type,
+    size_t size,
+    void** pptr )
+{
+    ze_device_mem_alloc_desc_t deviceDesc = {};
+    deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+    ze_host_mem_alloc_desc_t hostDesc = {};
+    hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+    switch (type) {
+    case ZE_MEMORY_TYPE_HOST:
+        return zeMemAllocHost(context, &hostDesc, size, 0, pptr);
+    case ZE_MEMORY_TYPE_DEVICE:
+        return zeMemAllocDevice(context, &deviceDesc, size, 0, device, pptr);
+    case ZE_MEMORY_TYPE_SHARED:
+        return zeMemAllocShared(context, &deviceDesc, &hostDesc, size, 0, device, pptr);
+    default:
+        return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+    }
+}
+
+struct Timing {
+    double  allocNs = 0.0;
+    double  freeNs = 0.0;
+};
+
+// Each round allocates "count" blocks and then frees them all, so the pool
+// sees a realistic mix of live allocations rather than a single block
+// bouncing between allocate and free.
+static Timing TimeRaw(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    ze_memory_type_t type,
+    size_t size,
+    int count,
+    int rounds )
+{
+    std::vector<void*> ptrs(count);
+    clk::duration allocTime(0);
+    clk::duration freeTime(0);
+
+    for (int r = 0; r < rounds; r++) {
+        auto start = clk::now();
+        for (auto& ptr : ptrs) {
+            CHECK_CALL( RawAllocate(context, device, type, size, &ptr) );
+        }
+        auto mid = clk::now();
+        for (auto& ptr : ptrs) {
+            CHECK_CALL( zeMemFree(context, ptr) );
+        }
+        auto end = clk::now();
+
+        allocTime += mid - start;
+        freeTime += end - mid;
+    }
+
+    Timing t;
+    t.allocNs = std::chrono::duration<double, std::nano>(allocTime).count() / ((double)count * rounds);
+    t.freeNs = std::chrono::duration<double, std::nano>(freeTime).count() / ((double)count * rounds);
+    return t;
+}
+
+static Timing TimePool(
+    lzutil::USMPool& pool,
+    size_t size,
+    int count,
+    int rounds )
+{
+    std::vector<void*> ptrs(count);
+    clk::duration allocTime(0);
+    clk::duration freeTime(0);
+
+    for (int r = 0; r < rounds; r++) {
+        auto start = clk::now();
+        for (auto& ptr : ptrs) {
+            CHECK_CALL( pool.allocate(size, &ptr) );
+        }
+        auto mid = clk::now();
+        for (auto& ptr : ptrs) {
+            CHECK_CALL( pool.free(ptr) );
+        }
+        auto end = clk::now();
+
+        allocTime += mid - start;
+        freeTime += end - mid;
+    }
+
+    Timing t;
+    t.allocNs = std::chrono::duration<double, std::nano>(allocTime).count() / ((double)count * rounds);
+    t.freeNs = std::chrono::duration<double, std::nano>(freeTime).count() / ((double)count * rounds);
+    return t;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t minSize = 64;
+    size_t maxSize = 4 * 1024 * 1024;
+    int count = 64;
+    int rounds = 16;
+    size_t slabSize = lzutil::USMPool::defaultSlabSize;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("", "minsize", "Minimum Allocation Size (bytes)", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "maxsize", "Maximum Allocation Size (bytes)", maxSize, &maxSize);
+        op.add<popl::Value<int>>("c", "count", "Live Allocations per Round", count, &count);
+        op.add<popl::Value<int>>("r", "rounds", "Rounds per Size", rounds, &rounds);
+        op.add<popl::Value<size_t>>("", "slabsize", "Pool Slab Size (bytes)", slabSize, &slabSize);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            minSize == 0 || maxSize < minSize || count <= 0 || rounds <= 0) {
+            fprintf(stderr,
+                "Usage: usmpool [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+            printf("\tmemory size:    %llu\n",
+                (unsigned long long)lzutil::USMPool::getDeviceMemorySize(devices[i]));
+
+            const ze_memory_type_t types[] = {
+                ZE_MEMORY_TYPE_HOST,
+                ZE_MEMORY_TYPE_DEVICE,
+                ZE_MEMORY_TYPE_SHARED,
+            };
+            for (auto type : types) {
+                lzutil::USMPool pool(context, devices[i], type, slabSize);
+
+                printf("\t%s pool: slab size %zu, capacity %zu%s\n",
+                    MemoryTypeName(type),
+                    pool.slabSize(),
+                    pool.capacity(),
+                    pool.capacity() == 0 ? " (unbounded)" : "");
+                printf("\t%12s %14s %14s %14s %14s\n",
+                    "Size", "Raw Alloc ns", "Raw Free ns", "Pool Alloc ns", "Pool Free ns");
+
+                for (size_t size = minSize; size <= maxSize; size *= 4) {
+                    Timing raw = TimeRaw(context, devices[i], type, size, count, rounds);
+                    Timing pooled = TimePool(pool, size, count, rounds);
+                    printf("\t%12zu %14.1f %14.1f %14.1f %14.1f\n",
+                        size, raw.allocNs, raw.freeNs, pooled.allocNs, pooled.freeNs);
+                }
+
+                printf("\t%s pool: %zu bytes reserved, %zu bytes in use\n",
+                    MemoryTypeName(type), pool.bytesReserved(), pool.bytesInUse());
+            }
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+#include "lzutil/module_cache.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static std::vector<uint8_t> readSPIRVFromFile(
+    const std::string& filename )
+{
+    std::vector<uint8_t> ret;
+
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (fp == nullptr) {
+        printf("Couldn't open file '%s'!\n", filename.c_str());
+        return ret;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long filesize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (filesize > 0) {
+        ret.resize(filesize);
+        if (fread(ret.data(), 1, ret.size(), fp) != ret.size()) {
+            printf("Couldn't read file '%s'!\n", filename.c_str());
+            ret.clear();
+        }
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+struct Stats {
+    double  minMs = 0.0;
+    double  avgMs = 0.0;
+    int     hits = 0;
+};
+
+static Stats TimeCreateModule(
+    lzutil::ModuleCache& cache,
+    ze_driver_handle_t driver,
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    const std::vector<uint8_t>& spirv,
+    const char* buildFlags,
+    int iterations,
+    bool evict )
+{
+    Stats stats;
+    double totalMs = 0.0;
+
+    for (int i = 0; i < iterations; i++) {
+        if (evict) {
+            cache.evict(driver, device, spirv.data(), spirv.size(), buildFlags);
+        }
+
+        ze_module_handle_t module = nullptr;
+        ze_module_build_log_handle_t buildLog = nullptr;
+        bool hit = false;
+
+        auto start = clk::now();
+        ze_result_t result = cache.createModule(
+            driver, context, device,
+            spirv.data(), spirv.size(), buildFlags,
+            &module, &buildLog, &hit);
+        auto end = clk::now();
+
+        if (result != ZE_RESULT_SUCCESS && buildLog != nullptr) {
+            size_t logSize = 0;
+            zeModuleBuildLogGetString(buildLog, &logSize, nullptr);
+            std::string log(logSize, '\0');
+            zeModuleBuildLogGetString(buildLog, &logSize, &log[0]);
+            printf("Build failed (%u):\n%s\n", result, log.c_str());
+        }
+        if (buildLog != nullptr) {
+            zeModuleBuildLogDestroy(buildLog);
+        }
+        if (module != nullptr) {
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        stats.minMs = (i == 0) ? ms : std::min(stats.minMs, ms);
+        totalMs += ms;
+        stats.hits += hit ? 1 : 0;
+    }
+
+    stats.avgMs = totalMs / iterations;
+    return stats;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    std::string fileName;
+    std::string buildOptions;
+    std::string cacheDir("lz_module_cache");
+    int iterations = 5;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<std::string>>("f", "file", "SPIR-V Module File Name (default: built-in empty kernel)", fileName, &fileName);
+        op.add<popl::Value<std::string>>("", "options", "Module Build Flags", buildOptions, &buildOptions);
+        op.add<popl::Value<std::string>>("", "cachedir", "Module Cache Directory", cacheDir, &cacheDir);
+        op.add<popl::Value<int>>("i", "iterations", "Module Builds per Measurement", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0) {
+            fprintf(stderr,
+                "Usage: modulecache [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    std::vector<uint8_t> spirv;
+    if (fileName.empty()) {
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+        spirv.assign(begin, begin + sizeof(lzutil::emptyKernelSPIRV));
+    } else {
+        spirv = readSPIRVFromFile(fileName);
+        if (spirv.empty()) {
+            return -1;
+        }
+    }
+
+    const char* buildFlags = buildOptions.empty() ? nullptr : buildOptions.c_str();
+
+    lzutil::ModuleCache cache(cacheDir);
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+            printf("\tcache entry:    %s\n",
+                cache.getCachePath(driver, devices[i], spirv.data(), spirv.size(), buildFlags).c_str());
+
+            // Cold builds evict the cache entry first, so each one compiles
+            // from SPIR-V and then stores the native binary.  Warm builds load
+            // the native binary stored by the last cold build.
+            Stats cold = TimeCreateModule(cache, driver, context, devices[i],
+                spirv, buildFlags, iterations, true);
+            Stats warm = TimeCreateModule(cache, driver, context, devices[i],
+                spirv, buildFlags, iterations, false);
+
+            printf("\tcold: min %10.3f ms, avg %10.3f ms (%d/%d cache hits)\n",
+                cold.minMs, cold.avgMs, cold.hits, iterations);
+            printf("\twarm: min %10.3f ms, avg %10.3f ms (%d/%d cache hits)\n",
+                warm.minMs, warm.avgMs, warm.hits, iterations);
+            if (warm.avgMs > 0.0) {
+                printf("\tspeedup:        %.2fx\n", cold.avgMs / warm.avgMs);
+            }
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+#include "lzutil/timestamp_profiler.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static void PrintHostStats(
+    const char* label,
+    std::vector<double>& samples )
+{
+    if (samples.empty()) {
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    printf("\t%-32s %8zu %12.3f %12.3f %12.3f\n",
+        label,
+        samples.size(),
+        samples.front(),
+        samples[samples.size() / 2],
+        samples.back());
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t size = 16 * 1024 * 1024;
+    int iterations = 16;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("s", "size", "Copy Size (bytes)", size, &size);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            size == 0 || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: kernelprofile [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            lzutil::TimestampProfiler profiler(context, device);
+            printf("\ttimer:          %.3f ns/tick, %u valid bits\n",
+                profiler.nsPerTick(), profiler.validBits());
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            void* host = nullptr;
+            void* dev0 = nullptr;
+            void* dev1 = nullptr;
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, size, 0, &host) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &dev0) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &dev1) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+
+            ze_group_count_t groupCount = { 1, 1, 1 };
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+            std::vector<double> appendUs;
+            std::vector<double> executeUs;
+
+            for (int it = 0; it < iterations; it++) {
+                auto start = clk::now();
+                CHECK_CALL( zeCommandListReset(cmdList) );
+                CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dev0, host, size,
+                    profiler.signal("copy host to device"), 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dev1, dev0, size,
+                    profiler.signal("copy device to device"), 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, host, dev1, size,
+                    profiler.signal("copy device to host"), 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+                    profiler.signal("kernel empty"), 0, nullptr) );
+                CHECK_CALL( zeCommandListClose(cmdList) );
+                auto mid = clk::now();
+                CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+                auto end = clk::now();
+
+                profiler.collect();
+
+                appendUs.push_back(std::chrono::duration<double, std::micro>(mid - start).count());
+                executeUs.push_back(std::chrono::duration<double, std::micro>(end - mid).count());
+            }
+
+            printf("\tDevice execution time:\n");
+            profiler.print();
+
+            printf("\tHost time:\n");
+            printf("\t%-32s %8s %12s %12s %12s\n",
+                "Region", "Count", "Min (us)", "Median (us)", "Max (us)");
+            PrintHostStats("host record command list", appendUs);
+            PrintHostStats("host execute and synchronize", executeUs);
+
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            CHECK_CALL( zeMemFree(context, dev1) );
+            CHECK_CALL( zeMemFree(context, dev0) );
+            CHECK_CALL( zeMemFree(context, host) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,527 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "zello_log.h"
+
+using clk = std::chrono::high_resolution_clock;
+
+// Counts heap allocations so the benchmark can report allocations per call.
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// This is how structures were formatted before the field descriptor tables:
+// one std::string append per label, value, and newline.
+static std::string LegacyToString(
+    const ze_device_properties_t& val )
+{
+    std::string str;
+
+    str += "Device::properties_t::stype : ";
+    str += to_string(val.stype);
+    str += "\n";
+
+    str += "Device::properties_t::pNext : ";
+    {
+        std::stringstream ss;
+        ss << "0x" << std::hex << reinterpret_cast<size_t>(val.pNext);
+        str += ss.str();
+    }
+    str += "\n";
+
+    str += "Device::properties_t::type : ";
+    str += to_string(val.type);
+    str += "\n";
+
+    str += "Device::properties_t::vendorId : ";
+    str += std::to_string(val.vendorId);
+    str += "\n";
+
+    str += "Device::properties_t::deviceId : ";
+    str += std::to_string(val.deviceId);
+    str += "\n";
+
+    str += "Device::properties_t::flags : ";
+    str += to_string((ze_device_property_flag_t)val.flags);
+    str += "\n";
+
+    str += "Device::properties_t::subdeviceId : ";
+    str += std::to_string(val.subdeviceId);
+    str += "\n";
+
+    str += "Device::properties_t::coreClockRate : ";
+    str += std::to_string(val.coreClockRate);
+    str += "\n";
+
+    str += "Device::properties_t::maxMemAllocSize : ";
+    str += std::to_string(val.maxMemAllocSize);
+    str += "\n";
+
+    str += "Device::properties_t::maxHardwareContexts : ";
+    str += std::to_string(val.maxHardwareContexts);
+    str += "\n";
+
+    str += "Device::properties_t::maxCommandQueuePriority : ";
+    str += std::to_string(val.maxCommandQueuePriority);
+    str += "\n";
+
+    str += "Device::properties_t::numThreadsPerEU : ";
+    str += std::to_string(val.numThreadsPerEU);
+    str += "\n";
+
+    str += "Device::properties_t::physicalEUSimdWidth : ";
+    str += std::to_string(val.physicalEUSimdWidth);
+    str += "\n";
+
+    str += "Device::properties_t::numEUsPerSubslice : ";
+    str += std::to_string(val.numEUsPerSubslice);
+    str += "\n";
+
+    str += "Device::properties_t::numSubslicesPerSlice : ";
+    str += std::to_string(val.numSubslicesPerSlice);
+    str += "\n";
+
+    str += "Device::properties_t::numSlices : ";
+    str += std::to_string(val.numSlices);
+    str += "\n";
+
+    str += "Device::properties_t::timerResolution : ";
+    str += std::to_string(val.timerResolution);
+    str += "\n";
+
+    str += "Device::properties_t::timestampValidBits : ";
+    str += std::to_string(val.timestampValidBits);
+    str += "\n";
+
+    str += "Device::properties_t::kernelTimestampValidBits : ";
+    str += std::to_string(val.kernelTimestampValidBits);
+    str += "\n";
+
+    str += "Device::properties_t::uuid : ";
+    str += to_string(val.uuid);
+    str += "\n";
+
+    str += "Device::properties_t::name : ";
+    str += val.name;
+    str += "\n";
+
+    return str;
+}
+
+// These are how enums were formatted and parsed before the enum tables:
+// chains of comparisons, returning or taking a std::string.
+static std::string LegacyLayoutToString(const ze_image_format_layout_t layout) {
+  if (layout == ZE_IMAGE_FORMAT_LAYOUT_8) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_8";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_16";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_32";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_8_8) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_8_8";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16_16) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_16_16";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32_32) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_32_32";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_11_11_10) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_11_11_10";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_5_6_5) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_5_6_5";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y8) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_Y8";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_NV12) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_NV12";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_YUYV) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_YUYV";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_VYUY) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_VYUY";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_YVYU) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_YVYU";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_UYVY) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_UYVY";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_AYUV) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_AYUV";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P010) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_P010";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y410) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_Y410";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P012) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_P012";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y16) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_Y16";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P016) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_P016";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_Y216) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_Y216";
+  } else if (layout == ZE_IMAGE_FORMAT_LAYOUT_P216) {
+    return "ZE_IMAGE_FORMAT_LAYOUT_P216";
+  } else {
+    return "Unknown ze_image_format_layout_t value: " +
+           std::to_string(static_cast<int>(layout));
+  }
+}
+
+static ze_image_format_layout_t LegacyToLayout(const std::string layout) {
+  if (layout == "8") {
+    return ZE_IMAGE_FORMAT_LAYOUT_8;
+  } else if (layout == "16") {
+    return ZE_IMAGE_FORMAT_LAYOUT_16;
+  } else if (layout == "32") {
+    return ZE_IMAGE_FORMAT_LAYOUT_32;
+  } else if (layout == "8_8") {
+    return ZE_IMAGE_FORMAT_LAYOUT_8_8;
+  } else if (layout == "8_8_8_8") {
+    return ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8;
+  } else if (layout == "16_16") {
+    return ZE_IMAGE_FORMAT_LAYOUT_16_16;
+  } else if (layout == "16_16_16_16") {
+    return ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16;
+  } else if (layout == "32_32") {
+    return ZE_IMAGE_FORMAT_LAYOUT_32_32;
+  } else if (layout == "32_32_32_32") {
+    return ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32;
+  } else if (layout == "10_10_10_2") {
+    return ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2;
+  } else if (layout == "11_11_10") {
+    return ZE_IMAGE_FORMAT_LAYOUT_11_11_10;
+  } else if (layout == "5_6_5") {
+    return ZE_IMAGE_FORMAT_LAYOUT_5_6_5;
+  } else if (layout == "5_5_5_1") {
+    return ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1;
+  } else if (layout == "4_4_4_4") {
+    return ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4;
+  } else if (layout == "Y8") {
+    return ZE_IMAGE_FORMAT_LAYOUT_Y8;
+  } else if (layout == "NV12") {
+    return ZE_IMAGE_FORMAT_LAYOUT_NV12;
+  } else if (layout == "YUYV") {
+    return ZE_IMAGE_FORMAT_LAYOUT_YUYV;
+  } else if (layout == "VYUY") {
+    return ZE_IMAGE_FORMAT_LAYOUT_VYUY;
+  } else if (layout == "YVYU") {
+    return ZE_IMAGE_FORMAT_LAYOUT_YVYU;
+  } else if (layout == "UYVY") {
+    return ZE_IMAGE_FORMAT_LAYOUT_UYVY;
+  } else if (layout == "AYUV") {
+    return ZE_IMAGE_FORMAT_LAYOUT_AYUV;
+  } else if (layout == "P010") {
+    return ZE_IMAGE_FORMAT_LAYOUT_P010;
+  } else if (layout == "Y410") {
+    return ZE_IMAGE_FORMAT_LAYOUT_Y410;
+  } else if (layout == "P012") {
+    return ZE_IMAGE_FORMAT_LAYOUT_P012;
+  } else if (layout == "Y16") {
+    return ZE_IMAGE_FORMAT_LAYOUT_Y16;
+  } else if (layout == "P016") {
+    return ZE_IMAGE_FORMAT_LAYOUT_P016;
+  } else if (layout == "Y216") {
+    return ZE_IMAGE_FORMAT_LAYOUT_Y216;
+  } else if (layout == "P216") {
+    return ZE_IMAGE_FORMAT_LAYOUT_P216;
+  } else {
+    std::cout << "Unknown ze_image_format_layout_t value: " << layout;
+    return static_cast<ze_image_format_layout_t>(-1);
+  }
+}
+
+static ze_image_format_type_t LegacyToFormatType(const std::string format_type) {
+  if (format_type == "UINT") {
+    return ZE_IMAGE_FORMAT_TYPE_UINT;
+  } else if (format_type == "SINT") {
+    return ZE_IMAGE_FORMAT_TYPE_SINT;
+  } else if (format_type == "UNORM") {
+    return ZE_IMAGE_FORMAT_TYPE_UNORM;
+  } else if (format_type == "SNORM") {
+    return ZE_IMAGE_FORMAT_TYPE_SNORM;
+  } else if (format_type == "FLOAT") {
+    return ZE_IMAGE_FORMAT_TYPE_FLOAT;
+  } else {
+    std::cout << "Unknown ze_image_format_type_t value: ";
+    return (static_cast<ze_image_format_type_t>(-1));
+  }
+}
+
+static ze_image_type_t LegacyToImageType(const std::string type) {
+  if (type == "1D") {
+    return ZE_IMAGE_TYPE_1D;
+  } else if (type == "2D") {
+    return ZE_IMAGE_TYPE_2D;
+  } else if (type == "3D") {
+    return ZE_IMAGE_TYPE_3D;
+  } else if (type == "1DARRAY") {
+    return ZE_IMAGE_TYPE_1DARRAY;
+  } else if (type == "2DARRAY") {
+    return ZE_IMAGE_TYPE_2DARRAY;
+  } else {
+    std::cout << "Unknown ze_image_type_t value: ";
+    return (static_cast<ze_image_type_t>(-1));
+  }
+}
+
+static ze_device_properties_t GetDeviceProperties()
+{
+    ze_device_properties_t props = {};
+    props.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+
+    if (zeInit(0) == ZE_RESULT_SUCCESS) {
+        uint32_t driverCount = 0;
+        zeDriverGet(&driverCount, nullptr);
+
+        std::vector<ze_driver_handle_t> drivers(driverCount);
+        zeDriverGet(&driverCount, drivers.data());
+
+        for (auto& driver : drivers) {
+            uint32_t deviceCount = 0;
+            zeDeviceGet(driver, &deviceCount, nullptr);
+
+            std::vector<ze_device_handle_t> devices(deviceCount);
+            zeDeviceGet(driver, &deviceCount, devices.data());
+
+            if (!devices.empty()) {
+                zeDeviceGetProperties(devices[0], &props);
+                printf("Using properties from device: %s\n", props.name);
+                return props;
+            }
+        }
+    }
+
+    // No device is available, so format representative values instead.
+    printf("No devices found, using synthetic properties.\n");
+    props.type = ZE_DEVICE_TYPE_GPU;
+    props.vendorId = 0x8086;
+    props.deviceId = 0x4905;
+    props.flags = ZE_DEVICE_PROPERTY_FLAG_INTEGRATED;
+    props.coreClockRate = 1650;
+    props.maxMemAllocSize = 4ull * 1024 * 1024 * 1024;
+    props.numThreadsPerEU = 7;
+    props.physicalEUSimdWidth = 8;
+    props.numEUsPerSubslice = 16;
+    props.numSubslicesPerSlice = 6;
+    props.numSlices = 1;
+    props.timerResolution = 52;
+    props.timestampValidBits = 36;
+    props.kernelTimestampValidBits = 32;
+    for (uint32_t i = 0; i < ZE_MAX_DEVICE_UUID_SIZE; i++) {
+        props.uuid.id[i] = static_cast<uint8_t>(i);
+    }
+    snprintf(props.name, sizeof(props.name), "Synthetic Device");
+    return props;
+}
+
+// Image format specs, as they would appear in a job config:
+// layout:type:image type.
+static const char* imageFormatSpecs[] = {
+    "8_8_8_8:UNORM:2D",
+    "32:FLOAT:1D",
+    "16_16:SINT:2DARRAY",
+    "NV12:UNORM:2D",
+    "10_10_10_2:UNORM:3D",
+    "32_32_32_32:UINT:1DARRAY",
+    "P216:SNORM:2D",
+    "5_6_5:UNORM:2D",
+};
+
+static const size_t imageFormatSpecCount =
+    sizeof(imageFormatSpecs) / sizeof(imageFormatSpecs[0]);
+
+static uint32_t LegacyParseSpec(
+    const std::string& spec )
+{
+    const size_t first = spec.find(':');
+    const size_t second = spec.find(':', first + 1);
+    return LegacyToLayout(spec.substr(0, first)) +
+        LegacyToFormatType(spec.substr(first + 1, second - first - 1)) +
+        LegacyToImageType(spec.substr(second + 1));
+}
+
+static uint32_t ParseSpec(
+    const char* spec )
+{
+    const char* first = strchr(spec, ':');
+    const char* second = strchr(first + 1, ':');
+    return to_layout(spec, first - spec) +
+        to_format_type(first + 1, second - first - 1) +
+        to_image_type(second + 1, strlen(second + 1));
+}
+
+// Runs func repeatedly and reports time and heap allocations per call.  The
+// values returned by func are summed so the work cannot be optimized away.
+template<typename F>
+static void Bench(
+    const char* label,
+    int iterations,
+    F&& func )
+{
+    size_t checksum = 0;
+
+    // Warm up, so reused buffers have reached their final size.
+    checksum += func();
+
+    const uint64_t startAllocations = allocationCount;
+    auto start = clk::now();
+    for (int i = 0; i < iterations; i++) {
+        checksum += func();
+    }
+    auto end = clk::now();
+    const uint64_t allocations = allocationCount - startAllocations;
+
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    printf("%-24s %10.1f ns/call %8.2f allocs/call (checksum %zu)\n",
+        label,
+        elapsed.count() / iterations,
+        (double)allocations / iterations,
+        checksum);
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 100000;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Iterations", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: formatbench [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    const ze_device_properties_t props = GetDeviceProperties();
+
+    if (LegacyToString(props) != to_string(props)) {
+        printf("Error: table-driven output does not match the legacy output!\n");
+        return -1;
+    }
+
+    printf("Formatting ze_device_properties_t, %d iterations:\n", iterations);
+
+    Bench("legacy to_string", iterations, [&]() {
+        return LegacyToString(props).size();
+    });
+    Bench("to_string", iterations, [&]() {
+        return to_string(props).size();
+    });
+
+    log_writer text(log_writer::TEXT);
+    Bench("reused writer (text)", iterations, [&]() {
+        text.clear();
+        log_struct(text, props);
+        return text.size();
+    });
+
+    log_writer json(log_writer::JSON);
+    Bench("reused writer (json)", iterations, [&]() {
+        json.clear();
+        log_struct(json, props);
+        return json.size();
+    });
+
+    printf("Parsing image format specs, %d iterations:\n", iterations);
+
+    for (size_t i = 0; i < imageFormatSpecCount; i++) {
+        if (LegacyParseSpec(imageFormatSpecs[i]) != ParseSpec(imageFormatSpecs[i])) {
+            printf("Error: parsed %s differently than the legacy parser!\n",
+                imageFormatSpecs[i]);
+            return -1;
+        }
+    }
+
+    size_t spec = 0;
+    Bench("legacy parser", iterations, [&]() {
+        spec = (spec + 1) % imageFormatSpecCount;
+        return (size_t)LegacyParseSpec(imageFormatSpecs[spec]);
+    });
+    Bench("perfect hash parser", iterations, [&]() {
+        spec = (spec + 1) % imageFormatSpecCount;
+        return (size_t)ParseSpec(imageFormatSpecs[spec]);
+    });
+
+    printf("Naming image format layouts, %d iterations:\n", iterations);
+
+    uint32_t layout = 0;
+    Bench("legacy to_string", iterations, [&]() {
+        layout = (layout + 1) % (ZE_IMAGE_FORMAT_LAYOUT_P216 + 1);
+        return LegacyLayoutToString((ze_image_format_layout_t)layout).size();
+    });
+    Bench("enum table", iterations, [&]() {
+        layout = (layout + 1) % (ZE_IMAGE_FORMAT_LAYOUT_P216 + 1);
+        return strlen(image_format_layout_name((ze_image_format_layout_t)layout));
+    });
+
+    printf("Done.\n");
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/copy_striper.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static double TimeStripedCopies(
+    lzutil::CopyStriper& striper,
+    void* dst,
+    const void* src,
+    size_t size,
+    size_t engines,
+    int iterations )
+{
+    auto start = clk::now();
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( striper.copy(dst, src, size, engines) );
+    }
+    auto end = clk::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return seconds > 0.0 ?
+        (double)size * iterations / seconds / 1e9 :
+        0.0;
+}
+
+// Copies a pattern to the device and back using all engines, and checks that
+// every chunk arrived in the right place.
+static bool Validate(
+    lzutil::CopyStriper& striper,
+    void* host,
+    void* device,
+    size_t size )
+{
+    std::vector<uint32_t> pattern(size / sizeof(uint32_t));
+    for (size_t i = 0; i < pattern.size(); i++) {
+        pattern[i] = (uint32_t)i;
+    }
+
+    memcpy(host, pattern.data(), pattern.size() * sizeof(uint32_t));
+    CHECK_CALL( striper.copy(device, host, size) );
+    memset(host, 0, size);
+    CHECK_CALL( striper.copy(host, device, size) );
+
+    return memcmp(host, pattern.data(), pattern.size() * sizeof(uint32_t)) == 0;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t size = 256 * 1024 * 1024;
+    int iterations = 8;
+    bool useCompute = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("s", "size", "Copy Size (bytes)", size, &size);
+        op.add<popl::Value<int>>("i", "iterations", "Copies per Engine Count", iterations, &iterations);
+        op.add<popl::Switch>("", "compute", "Also Copy Using the Compute Engine", &useCompute);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            size == 0 || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: copystripe [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+    bool failed = false;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            lzutil::CopyStriper striper(context, devices[i], useCompute);
+
+            printf("\tCopy Engines:   %zu\n", striper.engines().size());
+            for (auto& engine : striper.engines()) {
+                printf("\t\tordinal %u index %u%s\n",
+                    engine.ordinal, engine.index,
+                    engine.compute ? " (compute)" : "");
+            }
+
+            void* host = nullptr;
+            void* device = nullptr;
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, size, 0, &host) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, devices[i], &device) );
+
+            if (host == nullptr || device == nullptr || striper.engines().empty()) {
+                printf("\tSkipping device, setup failed.\n");
+            } else {
+                const bool valid = Validate(striper, host, device, size);
+                printf("\tValidation:     %s\n", valid ? "passed" : "FAILED");
+                if (!valid) {
+                    failed = true;
+                }
+
+                printf("\t%8s %10s %10s (GB/s, %zu bytes)\n", "Engines", "H2D", "D2H", size);
+                for (size_t engines = 1; engines <= striper.engines().size(); engines++) {
+                    const double h2d = TimeStripedCopies(striper, device, host, size, engines, iterations);
+                    const double d2h = TimeStripedCopies(striper, host, device, size, engines, iterations);
+                    printf("\t%8zu %10.2f %10.2f\n", engines, h2d, d2h);
+                }
+            }
+
+            if (host) CHECK_CALL( zeMemFree(context, host) );
+            if (device) CHECK_CALL( zeMemFree(context, device) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,419 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "zello_log.h"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// A pair is only measured if the driver reports peer access and the source
+// and destination buffers were allocated, but the two are reported
+// separately.
+struct PairResult {
+    bool    canAccessPeer = false;
+    bool    allocated = false;
+    uint32_t p2pFlags = 0;
+    double  bandwidthGBps = 0.0;
+    double  latencyUs = 0.0;
+
+    bool measured() const
+    {
+        return canAccessPeer && allocated;
+    }
+};
+
+// Prefers a copy-only queue group, since that is what peer transfers would
+// normally use, and falls back to the first group that supports copies.
+static uint32_t FindCopyOrdinal(
+    ze_device_handle_t device )
+{
+    uint32_t groupCount = 0;
+    zeDeviceGetCommandQueueGroupProperties(device, &groupCount, nullptr);
+
+    std::vector<ze_command_queue_group_properties_t> groups(groupCount);
+    for (auto& group : groups) {
+        group.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+    }
+    zeDeviceGetCommandQueueGroupProperties(device, &groupCount, groups.data());
+
+    uint32_t fallback = 0;
+    bool haveFallback = false;
+    for (uint32_t ordinal = 0; ordinal < groupCount; ordinal++) {
+        const auto flags = groups[ordinal].flags;
+        if ((flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) &&
+            !(flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE)) {
+            return ordinal;
+        }
+        if ((flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) && !haveFallback) {
+            fallback = ordinal;
+            haveFallback = true;
+        }
+    }
+    return fallback;
+}
+
+// Times iterations copies of size bytes submitted as one command list, so
+// submission overhead is amortized and the result reflects the link.
+static double MeasureBandwidth(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    uint32_t ordinal,
+    void* dst,
+    const void* src,
+    size_t size,
+    int iterations )
+{
+    ze_command_queue_desc_t queueDesc = {};
+    queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+    queueDesc.ordinal = ordinal;
+    queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+    ze_command_queue_handle_t queue = nullptr;
+    CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+    ze_command_list_desc_t cmdListDesc = {};
+    cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+    cmdListDesc.commandQueueGroupOrdinal = ordinal;
+
+    ze_command_list_handle_t cmdList = nullptr;
+    CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+    // Warm up the path once before timing it.
+    CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+    CHECK_CALL( zeCommandListClose(cmdList) );
+    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+    CHECK_CALL( zeCommandListReset(cmdList) );
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+    }
+    CHECK_CALL( zeCommandListClose(cmdList) );
+
+    auto start = clk::now();
+    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+    auto end = clk::now();
+
+    CHECK_CALL( zeCommandListDestroy(cmdList) );
+    CHECK_CALL( zeCommandQueueDestroy(queue) );
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return seconds > 0.0 ?
+        (double)size * iterations / seconds / 1e9 :
+        0.0;
+}
+
+// Times small copies on a synchronous immediate command list, so each copy
+// includes the full round trip to the peer and back to the host.
+static double MeasureLatency(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    uint32_t ordinal,
+    void* dst,
+    const void* src,
+    size_t size,
+    int iterations )
+{
+    ze_command_queue_desc_t queueDesc = {};
+    queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+    queueDesc.ordinal = ordinal;
+    queueDesc.mode = ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
+
+    ze_command_list_handle_t cmdList = nullptr;
+    CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &cmdList) );
+
+    CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+
+    auto start = clk::now();
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, dst, src, size, nullptr, 0, nullptr) );
+    }
+    auto end = clk::now();
+
+    CHECK_CALL( zeCommandListDestroy(cmdList) );
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+static void PrintMatrix(
+    const char* title,
+    const std::vector<std::vector<PairResult>>& results,
+    double PairResult::* value )
+{
+    const size_t count = results.size();
+    printf("%s (rows: source, columns: destination):\n", title);
+    printf("%10s", "");
+    for (size_t d = 0; d < count; d++) {
+        printf(" %10s", ("Device[" + std::to_string(d) + "]").c_str());
+    }
+    printf("\n");
+    for (size_t s = 0; s < count; s++) {
+        printf("%10s", ("Device[" + std::to_string(s) + "]").c_str());
+        for (size_t d = 0; d < count; d++) {
+            if (results[s][d].measured()) {
+                printf(" %10.2f", results[s][d].*value);
+            } else {
+                printf(" %10s", "-");
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+static void WriteMatrix(
+    log_writer& w,
+    const char* key,
+    const std::vector<std::vector<PairResult>>& results,
+    double PairResult::* value )
+{
+    w.key("", key);
+    w.begin_array();
+    for (auto& row : results) {
+        w.begin_array();
+        for (auto& r : row) {
+            if (r.measured()) {
+                w.decimal(r.*value);
+            } else {
+                w.raw_value("null");
+            }
+        }
+        w.end_array();
+    }
+    w.end_array();
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t size = 64 * 1024 * 1024;
+    size_t latencySize = 64;
+    int iterations = 8;
+    int latencyIterations = 1000;
+    bool json = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("s", "size", "Bandwidth Copy Size (bytes)", size, &size);
+        op.add<popl::Value<int>>("i", "iterations", "Bandwidth Copies per Pair", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "latsize", "Latency Copy Size (bytes)", latencySize, &latencySize);
+        op.add<popl::Value<int>>("", "latiterations", "Latency Copies per Pair", latencyIterations, &latencyIterations);
+        op.add<popl::Switch>("", "json", "Print Results as JSON", &json);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            size == 0 || latencySize == 0 || latencySize > size ||
+            iterations <= 0 || latencyIterations <= 0) {
+            fprintf(stderr,
+                "Usage: p2pmatrix [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    // In JSON mode status messages go to stderr so they do not mix with the
+    // JSON document on stdout.  Failed calls are still reported on stdout by
+    // CHECK_CALL, as in the other samples.
+    FILE* status = json ? stderr : stdout;
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        fprintf(status, "zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    fprintf(status, "Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    log_writer doc(log_writer::JSON);
+    doc.begin_object();
+    doc.key("", "drivers");
+    doc.begin_array();
+
+    for (auto& driver : drivers) {
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        fprintf(status, "Driver:\n");
+        fprintf(status, "\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        std::vector<std::string> names(deviceCount);
+        std::vector<uint32_t> ordinals(deviceCount);
+        std::vector<void*> srcBuffers(deviceCount);
+        std::vector<void*> dstBuffers(deviceCount);
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(devices[i], &deviceProps);
+            names[i] = deviceProps.name;
+
+            fprintf(status, "Device[%u]: %s\n", i, deviceProps.name);
+
+            ordinals[i] = FindCopyOrdinal(devices[i]);
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, devices[i], &srcBuffers[i]) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, devices[i], &dstBuffers[i]) );
+        }
+        fprintf(status, "\n");
+
+        // The diagonal is a local device-to-device copy, for reference.
+        // Copies are submitted by the source device, pushing to the peer.
+        std::vector<std::vector<PairResult>> results(
+            deviceCount, std::vector<PairResult>(deviceCount));
+        for (uint32_t s = 0; s < deviceCount; s++) {
+            for (uint32_t d = 0; d < deviceCount; d++) {
+                PairResult& r = results[s][d];
+
+                ze_bool_t canAccess = (s == d);
+                if (s != d) {
+                    CHECK_CALL( zeDeviceCanAccessPeer(devices[s], devices[d], &canAccess) );
+
+                    ze_device_p2p_properties_t p2pProps = {};
+                    p2pProps.stype = ZE_STRUCTURE_TYPE_DEVICE_P2P_PROPERTIES;
+                    CHECK_CALL( zeDeviceGetP2PProperties(devices[s], devices[d], &p2pProps) );
+                    r.p2pFlags = p2pProps.flags;
+                }
+                r.canAccessPeer = canAccess != 0;
+                r.allocated = srcBuffers[s] != nullptr && dstBuffers[d] != nullptr;
+
+                if (r.measured()) {
+                    r.bandwidthGBps = MeasureBandwidth(
+                        context, devices[s], ordinals[s],
+                        dstBuffers[d], srcBuffers[s], size, iterations);
+                    r.latencyUs = MeasureLatency(
+                        context, devices[s], ordinals[s],
+                        dstBuffers[d], srcBuffers[s], latencySize, latencyIterations);
+                }
+            }
+        }
+
+        if (json) {
+            doc.begin_object();
+            doc.key("", "driverVersion");
+            doc.number(driverProps.driverVersion);
+            doc.key("", "devices");
+            doc.begin_array();
+            for (auto& name : names) {
+                doc.string(name.c_str());
+            }
+            doc.end_array();
+            doc.key("", "p2pProperties");
+            doc.begin_array();
+            for (auto& row : results) {
+                doc.begin_array();
+                for (auto& r : row) {
+                    doc.begin_object();
+                    doc.key("", "canAccessPeer");
+                    doc.raw_value(r.canAccessPeer ? "true" : "false");
+                    doc.key("", "allocated");
+                    doc.raw_value(r.allocated ? "true" : "false");
+                    doc.key("", "flags");
+                    log_flags(doc, r.p2pFlags, device_p2p_property_flags, FLAG_STYLE_BRACES);
+                    doc.end_object();
+                }
+                doc.end_array();
+            }
+            doc.end_array();
+            WriteMatrix(doc, "bandwidthGBps", results, &PairResult::bandwidthGBps);
+            WriteMatrix(doc, "latencyUs", results, &PairResult::latencyUs);
+            doc.end_object();
+        } else {
+            printf("P2P Properties:\n");
+            for (uint32_t s = 0; s < deviceCount; s++) {
+                for (uint32_t d = 0; d < deviceCount; d++) {
+                    if (s != d) {
+                        printf("\tDevice[%u] -> Device[%u]: canAccessPeer %s, buffers %s, flags %s\n",
+                            s, d,
+                            results[s][d].canAccessPeer ? "yes" : "no",
+                            results[s][d].allocated ? "allocated" : "not allocated",
+                            to_string((ze_device_p2p_property_flag_t)results[s][d].p2pFlags).c_str());
+                    }
+                }
+            }
+            printf("\n");
+
+            PrintMatrix("Bandwidth (GB/s)", results, &PairResult::bandwidthGBps);
+            PrintMatrix("Latency (us)", results, &PairResult::latencyUs);
+        }
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            if (srcBuffers[i]) CHECK_CALL( zeMemFree(context, srcBuffers[i]) );
+            if (dstBuffers[i]) CHECK_CALL( zeMemFree(context, dstBuffers[i]) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+    }
+
+    doc.end_array();
+    doc.end_object();
+    if (json) {
+        printf("%s\n", doc.c_str());
+    }
+
+    fprintf(status, "Done.\n");
+
+    return 0;
+}
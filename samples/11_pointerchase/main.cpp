@@ -0,0 +1,391 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/timestamp_profiler.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void pointer_chase(global uint* buf, uint steps, global uint* out)
+//   {
+//       uint idx = 0;
+//       for (uint i = 0; i < steps; i++) {
+//           idx = buf[idx];
+//       }
+//       out[0] = idx;
+//   }
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %chase "pointer_chase"
+//   %void = OpTypeVoid
+//   %bool = OpTypeBool
+//   %uint = OpTypeInt 32 0
+//   %ulong = OpTypeInt 64 0
+//   %ptr = OpTypePointer CrossWorkgroup %uint
+//   %fnty = OpTypeFunction %void %ptr %uint %ptr
+//   %c0 = OpConstant %uint 0
+//   %c1 = OpConstant %uint 1
+//   %chase = OpFunction %void None %fnty
+//   %buf = OpFunctionParameter %ptr
+//   %steps = OpFunctionParameter %uint
+//   %out = OpFunctionParameter %ptr
+//   %entry = OpLabel
+//   OpBranch %header
+//   %header = OpLabel
+//   %i = OpPhi %uint %c0 %entry %inext %body
+//   %idx = OpPhi %uint %c0 %entry %next %body
+//   %cond = OpULessThan %bool %i %steps
+//   OpBranchConditional %cond %body %exit
+//   %body = OpLabel
+//   %idx64 = OpUConvert %ulong %idx
+//   %addr = OpInBoundsPtrAccessChain %ptr %buf %idx64
+//   %next = OpLoad %uint %addr Aligned 4
+//   %inext = OpIAdd %uint %i %c1
+//   OpBranch %header
+//   %exit = OpLabel
+//   OpStore %out %idx Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t pointerChaseSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000018, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0007000F, 0x00000006, 0x00000009, 0x6E696F70, 0x5F726574, 0x73616863, 0x00000065,
+    0x00020013, 0x00000001,
+    0x00020014, 0x00000002,
+    0x00040015, 0x00000003, 0x00000020, 0x00000000,
+    0x00040015, 0x00000004, 0x00000040, 0x00000000,
+    0x00040020, 0x00000005, 0x00000005, 0x00000003,
+    0x00060021, 0x00000006, 0x00000001, 0x00000005, 0x00000003, 0x00000005,
+    0x0004002B, 0x00000003, 0x00000007, 0x00000000,
+    0x0004002B, 0x00000003, 0x00000008, 0x00000001,
+    0x00050036, 0x00000001, 0x00000009, 0x00000000, 0x00000006,
+    0x00030037, 0x00000005, 0x0000000A,
+    0x00030037, 0x00000003, 0x0000000B,
+    0x00030037, 0x00000005, 0x0000000C,
+    0x000200F8, 0x0000000D,
+    0x000200F9, 0x0000000E,
+    0x000200F8, 0x0000000E,
+    0x000700F5, 0x00000003, 0x0000000F, 0x00000007, 0x0000000D, 0x00000016, 0x00000012,
+    0x000700F5, 0x00000003, 0x00000010, 0x00000007, 0x0000000D, 0x00000015, 0x00000012,
+    0x000500B0, 0x00000002, 0x00000011, 0x0000000F, 0x0000000B,
+    0x000400FA, 0x00000011, 0x00000012, 0x00000017,
+    0x000200F8, 0x00000012,
+    0x00040071, 0x00000004, 0x00000013, 0x00000010,
+    0x00050046, 0x00000005, 0x00000014, 0x0000000A, 0x00000013,
+    0x0006003D, 0x00000003, 0x00000015, 0x00000014, 0x00000002, 0x00000004,
+    0x00050080, 0x00000003, 0x00000016, 0x0000000F, 0x00000008,
+    0x000200F9, 0x0000000E,
+    0x000200F8, 0x00000017,
+    0x0005003E, 0x0000000C, 0x00000010, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char pointerChaseName[] = "pointer_chase";
+
+// Builds a single random cycle through size / stride slots, with one index
+// per slot.  The random order defeats hardware prefetchers, and visiting
+// each slot once per lap makes the working set exactly size bytes.
+static void BuildChain(
+    std::vector<uint32_t>& chain,
+    size_t size,
+    size_t stride,
+    std::mt19937& rng )
+{
+    const uint32_t strideElements = (uint32_t)(stride / sizeof(uint32_t));
+    const uint32_t slots = (uint32_t)(size / stride);
+
+    std::vector<uint32_t> order(slots);
+    for (uint32_t i = 0; i < slots; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin() + 1, order.end(), rng);
+
+    chain.assign((size_t)slots * strideElements, 0);
+    for (uint32_t i = 0; i < slots; i++) {
+        const uint32_t from = order[i] * strideElements;
+        const uint32_t to = order[(i + 1) % slots] * strideElements;
+        chain[from] = to;
+    }
+}
+
+static std::vector<size_t> GetCacheSizes(
+    ze_device_handle_t device )
+{
+    uint32_t cacheCount = 0;
+    zeDeviceGetCacheProperties(device, &cacheCount, nullptr);
+
+    std::vector<ze_device_cache_properties_t> cacheProps(cacheCount);
+    for (auto& prop : cacheProps) {
+        prop.stype = ZE_STRUCTURE_TYPE_DEVICE_CACHE_PROPERTIES;
+    }
+    zeDeviceGetCacheProperties(device, &cacheCount, cacheProps.data());
+
+    std::vector<size_t> sizes;
+    for (auto& prop : cacheProps) {
+        if (prop.cacheSize != 0) {
+            sizes.push_back(prop.cacheSize);
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    return sizes;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t minSize = 4 * 1024;
+    size_t maxSize = 0;
+    size_t stride = 64;
+    uint32_t steps = 1024 * 1024;
+    int iterations = 3;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("", "minsize", "Minimum Working Set (bytes, multiple of stride)", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "maxsize", "Maximum Working Set (bytes, default: 4x largest cache)", maxSize, &maxSize);
+        op.add<popl::Value<size_t>>("", "stride", "Distance Between Chased Elements (bytes)", stride, &stride);
+        op.add<popl::Value<uint32_t>>("", "steps", "Dependent Loads per Measurement", steps, &steps);
+        op.add<popl::Value<int>>("i", "iterations", "Measurements per Working Set", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            stride < sizeof(uint32_t) || stride % sizeof(uint32_t) != 0 ||
+            minSize < stride || minSize % stride != 0 ||
+            (maxSize != 0 && maxSize < minSize) ||
+            steps == 0 || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: pointerchase [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    std::mt19937 rng(1234);
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            const std::vector<size_t> cacheSizes = GetCacheSizes(device);
+            for (size_t c = 0; c < cacheSizes.size(); c++) {
+                printf("\tcache[%zu]:       %zu bytes\n", c, cacheSizes[c]);
+            }
+
+            size_t deviceMaxSize = maxSize;
+            if (deviceMaxSize == 0) {
+                deviceMaxSize = cacheSizes.empty() ?
+                    256 * 1024 * 1024 :
+                    std::max<size_t>(cacheSizes.back() * 4, minSize);
+            }
+            deviceMaxSize = std::min<size_t>(deviceMaxSize, deviceProps.maxMemAllocSize);
+            deviceMaxSize = std::min<size_t>(deviceMaxSize, (size_t)UINT32_MAX);
+
+            lzutil::TimestampProfiler profiler(context, device);
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            void* host = nullptr;
+            void* buf = nullptr;
+            void* out = nullptr;
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, deviceMaxSize, 0, &host) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, deviceMaxSize, 0, device, &buf) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, sizeof(uint32_t), 0, device, &out) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(pointerChaseSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(pointerChaseSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = pointerChaseName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+            CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(buf), &buf) );
+            CHECK_CALL( zeKernelSetArgumentValue(kernel, 1, sizeof(steps), &steps) );
+            CHECK_CALL( zeKernelSetArgumentValue(kernel, 2, sizeof(out), &out) );
+
+            // A single work-item chases the chain, so every load depends on
+            // the previous one and the time per step is the load latency.
+            ze_group_count_t groupCount = { 1, 1, 1 };
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+            if (host == nullptr || buf == nullptr || out == nullptr || kernel == nullptr) {
+                printf("\tSkipping device, setup failed.\n");
+            } else {
+                printf("\t%16s %12s\n", "Working Set", "ns/access");
+
+                std::vector<uint32_t> chain;
+                size_t nextCache = 0;
+                for (size_t size = minSize; size <= deviceMaxSize; ) {
+                    while (nextCache < cacheSizes.size() && cacheSizes[nextCache] < size) {
+                        printf("\t---- cache[%zu]: %zu bytes ----\n", nextCache, cacheSizes[nextCache]);
+                        nextCache++;
+                    }
+
+                    BuildChain(chain, size, stride, rng);
+                    const size_t chainBytes = chain.size() * sizeof(uint32_t);
+                    memcpy(host, chain.data(), chainBytes);
+
+                    // The first launch warms the caches with the chain, and
+                    // each later launch is one measurement.
+                    CHECK_CALL( zeCommandListReset(cmdList) );
+                    CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, buf, host, chainBytes, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                    for (int it = 0; it < iterations; it++) {
+                        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                        CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+                            profiler.signal("chase"), 0, nullptr) );
+                    }
+                    CHECK_CALL( zeCommandListClose(cmdList) );
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+                    profiler.clear();
+                    profiler.collect();
+
+                    auto summary = profiler.summarize();
+                    if (summary.count("chase")) {
+                        printf("\t%16zu %12.2f\n", size, summary["chase"].minNs / steps);
+                    } else {
+                        printf("\t%16zu %12s\n", size, "?");
+                    }
+
+                    // Sweep in steps of 1.5x and 2x, so cache boundaries that
+                    // are not powers of two are still resolved.
+                    const size_t next = (size & (size - 1)) == 0 ? size + size / 2 : (size / 3) * 4;
+                    size = std::max(next / stride * stride, size + stride);
+                }
+            }
+
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            if (host) CHECK_CALL( zeMemFree(context, host) );
+            if (buf) CHECK_CALL( zeMemFree(context, buf) );
+            if (out) CHECK_CALL( zeMemFree(context, out) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
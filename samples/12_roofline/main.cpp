@@ -0,0 +1,445 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/timestamp_profiler.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void roofline(global float* buf, uint n)
+//   {
+//       size_t gid = get_global_id(0);
+//       float a0 = buf[gid];
+//       float a1 = a0 + 1.0f;
+//       float a2 = a0 + 2.0f;
+//       float a3 = a0 + 3.0f;
+//       for (uint i = 0; i < n; i++) {
+//           a0 = fma(a0, 0.999f, 0.001f);
+//           a1 = fma(a1, 0.999f, 0.001f);
+//           a2 = fma(a2, 0.999f, 0.001f);
+//           a3 = fma(a3, 0.999f, 0.001f);
+//       }
+//       buf[gid] = (a0 + a1) + (a2 + a3);
+//   }
+//
+// Each element is read and written once (8 bytes) and each loop iteration
+// performs four independent FMAs (8 FLOPs), so n sets the arithmetic
+// intensity to n FLOPs per byte.  The four chains give the compiler
+// independent FMAs to schedule back to back.
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   %ext = OpExtInstImport "OpenCL.std"
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %roofline "roofline" %gid_var
+//   OpDecorate %gid_var BuiltIn GlobalInvocationId
+//   OpDecorate %gid_var Constant
+//   %void = OpTypeVoid
+//   %bool = OpTypeBool
+//   %uint = OpTypeInt 32 0
+//   %ulong = OpTypeInt 64 0
+//   %float = OpTypeFloat 32
+//   %v3ulong = OpTypeVector %ulong 3
+//   %ptr_in = OpTypePointer Input %v3ulong
+//   %ptr = OpTypePointer CrossWorkgroup %float
+//   %fnty = OpTypeFunction %void %ptr %uint
+//   %c0 = OpConstant %uint 0
+//   %c1 = OpConstant %uint 1
+//   %f1 = OpConstant %float 1.0
+//   %f2 = OpConstant %float 2.0
+//   %f3 = OpConstant %float 3.0
+//   %fa = OpConstant %float 0.999
+//   %fb = OpConstant %float 0.001
+//   %gid_var = OpVariable %ptr_in Input
+//   %roofline = OpFunction %void None %fnty
+//   %buf = OpFunctionParameter %ptr
+//   %n = OpFunctionParameter %uint
+//   %entry = OpLabel
+//   %gid3 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gid = OpCompositeExtract %ulong %gid3 0
+//   %addr = OpInBoundsPtrAccessChain %ptr %buf %gid
+//   %x = OpLoad %float %addr Aligned 4
+//   %x1 = OpFAdd %float %x %f1
+//   %x2 = OpFAdd %float %x %f2
+//   %x3 = OpFAdd %float %x %f3
+//   OpBranch %header
+//   %header = OpLabel
+//   %i = OpPhi %uint %c0 %entry %inext %body
+//   %a0 = OpPhi %float %x %entry %b0 %body
+//   %a1 = OpPhi %float %x1 %entry %b1 %body
+//   %a2 = OpPhi %float %x2 %entry %b2 %body
+//   %a3 = OpPhi %float %x3 %entry %b3 %body
+//   %cond = OpULessThan %bool %i %n
+//   OpBranchConditional %cond %body %exit
+//   %body = OpLabel
+//   %b0 = OpExtInst %float %ext 26 %a0 %fa %fb
+//   %b1 = OpExtInst %float %ext 26 %a1 %fa %fb
+//   %b2 = OpExtInst %float %ext 26 %a2 %fa %fb
+//   %b3 = OpExtInst %float %ext 26 %a3 %fa %fb
+//   %inext = OpIAdd %uint %i %c1
+//   OpBranch %header
+//   %exit = OpLabel
+//   %s01 = OpFAdd %float %a0 %a1
+//   %s23 = OpFAdd %float %a2 %a3
+//   %s = OpFAdd %float %s01 %s23
+//   OpStore %addr %s Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t rooflineSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000002F, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0005000B, 0x00000001, 0x6E65704F, 0x732E4C43, 0x00006474,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0007000F, 0x00000006, 0x00000013, 0x666F6F72, 0x656E696C, 0x00000000, 0x00000012,
+    0x00040047, 0x00000012, 0x0000000B, 0x0000001C,
+    0x00030047, 0x00000012, 0x00000016,
+    0x00020013, 0x00000002,
+    0x00020014, 0x00000003,
+    0x00040015, 0x00000004, 0x00000020, 0x00000000,
+    0x00040015, 0x00000005, 0x00000040, 0x00000000,
+    0x00030016, 0x00000006, 0x00000020,
+    0x00040017, 0x00000007, 0x00000005, 0x00000003,
+    0x00040020, 0x00000008, 0x00000001, 0x00000007,
+    0x00040020, 0x00000009, 0x00000005, 0x00000006,
+    0x00050021, 0x0000000A, 0x00000002, 0x00000009, 0x00000004,
+    0x0004002B, 0x00000004, 0x0000000B, 0x00000000,
+    0x0004002B, 0x00000004, 0x0000000C, 0x00000001,
+    0x0004002B, 0x00000006, 0x0000000D, 0x3F800000,
+    0x0004002B, 0x00000006, 0x0000000E, 0x40000000,
+    0x0004002B, 0x00000006, 0x0000000F, 0x40400000,
+    0x0004002B, 0x00000006, 0x00000010, 0x3F7FBE77,
+    0x0004002B, 0x00000006, 0x00000011, 0x3A83126F,
+    0x0004003B, 0x00000008, 0x00000012, 0x00000001,
+    0x00050036, 0x00000002, 0x00000013, 0x00000000, 0x0000000A,
+    0x00030037, 0x00000009, 0x00000014,
+    0x00030037, 0x00000004, 0x00000015,
+    0x000200F8, 0x00000016,
+    0x0006003D, 0x00000007, 0x00000017, 0x00000012, 0x00000002, 0x00000020,
+    0x00050051, 0x00000005, 0x00000018, 0x00000017, 0x00000000,
+    0x00050046, 0x00000009, 0x00000019, 0x00000014, 0x00000018,
+    0x0006003D, 0x00000006, 0x0000001A, 0x00000019, 0x00000002, 0x00000004,
+    0x00050081, 0x00000006, 0x0000001B, 0x0000001A, 0x0000000D,
+    0x00050081, 0x00000006, 0x0000001C, 0x0000001A, 0x0000000E,
+    0x00050081, 0x00000006, 0x0000001D, 0x0000001A, 0x0000000F,
+    0x000200F9, 0x0000001E,
+    0x000200F8, 0x0000001E,
+    0x000700F5, 0x00000004, 0x0000001F, 0x0000000B, 0x00000016, 0x0000002A, 0x00000025,
+    0x000700F5, 0x00000006, 0x00000020, 0x0000001A, 0x00000016, 0x00000026, 0x00000025,
+    0x000700F5, 0x00000006, 0x00000021, 0x0000001B, 0x00000016, 0x00000027, 0x00000025,
+    0x000700F5, 0x00000006, 0x00000022, 0x0000001C, 0x00000016, 0x00000028, 0x00000025,
+    0x000700F5, 0x00000006, 0x00000023, 0x0000001D, 0x00000016, 0x00000029, 0x00000025,
+    0x000500B0, 0x00000003, 0x00000024, 0x0000001F, 0x00000015,
+    0x000400FA, 0x00000024, 0x00000025, 0x0000002B,
+    0x000200F8, 0x00000025,
+    0x0008000C, 0x00000006, 0x00000026, 0x00000001, 0x0000001A, 0x00000020, 0x00000010, 0x00000011,
+    0x0008000C, 0x00000006, 0x00000027, 0x00000001, 0x0000001A, 0x00000021, 0x00000010, 0x00000011,
+    0x0008000C, 0x00000006, 0x00000028, 0x00000001, 0x0000001A, 0x00000022, 0x00000010, 0x00000011,
+    0x0008000C, 0x00000006, 0x00000029, 0x00000001, 0x0000001A, 0x00000023, 0x00000010, 0x00000011,
+    0x00050080, 0x00000004, 0x0000002A, 0x0000001F, 0x0000000C,
+    0x000200F9, 0x0000001E,
+    0x000200F8, 0x0000002B,
+    0x00050081, 0x00000006, 0x0000002C, 0x00000020, 0x00000021,
+    0x00050081, 0x00000006, 0x0000002D, 0x00000022, 0x00000023,
+    0x00050081, 0x00000006, 0x0000002E, 0x0000002C, 0x0000002D,
+    0x0005003E, 0x00000019, 0x0000002E, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char rooflineName[] = "roofline";
+
+static const double bytesPerElement = 2 * sizeof(float);
+static const double flopsPerIteration = 8;
+
+// Peak FP32 throughput, assuming every SIMD lane of every EU completes one
+// FMA (two FLOPs) per clock.
+static double ComputePeakGFlops(
+    const ze_device_properties_t& props )
+{
+    const double eus = (double)props.numSlices *
+        props.numSubslicesPerSlice *
+        props.numEUsPerSubslice;
+    return eus * props.physicalEUSimdWidth * 2 * props.coreClockRate / 1e3;
+}
+
+// Peak memory bandwidth from the fastest memory's clock rate (MHz) and bus
+// width (bits).  Returns zero if the driver does not report them.
+static double ComputePeakGBps(
+    ze_device_handle_t device )
+{
+    uint32_t memoryCount = 0;
+    zeDeviceGetMemoryProperties(device, &memoryCount, nullptr);
+
+    std::vector<ze_device_memory_properties_t> memoryProps(memoryCount);
+    for (auto& prop : memoryProps) {
+        prop.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_PROPERTIES;
+    }
+    zeDeviceGetMemoryProperties(device, &memoryCount, memoryProps.data());
+
+    double peak = 0.0;
+    for (auto& prop : memoryProps) {
+        peak = std::max(peak, (double)prop.maxClockRate * prop.maxBusWidth / 8 / 1e3);
+    }
+    return peak;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t size = 256 * 1024 * 1024;
+    uint32_t maxIntensity = 256;
+    int iterations = 4;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("s", "size", "Buffer Size (bytes)", size, &size);
+        op.add<popl::Value<uint32_t>>("", "maxintensity", "Maximum Arithmetic Intensity (FLOPs/byte)", maxIntensity, &maxIntensity);
+        op.add<popl::Value<int>>("i", "iterations", "Measurements per Intensity", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            size < sizeof(float) || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: roofline [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            const double peakGFlops = ComputePeakGFlops(deviceProps);
+            const double peakGBps = ComputePeakGBps(device);
+
+            printf("\tname:           %s\n", deviceProps.name);
+            printf("\tEUs:            %u (%u slices x %u subslices x %u EUs), %u threads/EU, SIMD%u\n",
+                deviceProps.numSlices * deviceProps.numSubslicesPerSlice * deviceProps.numEUsPerSubslice,
+                deviceProps.numSlices, deviceProps.numSubslicesPerSlice, deviceProps.numEUsPerSubslice,
+                deviceProps.numThreadsPerEU, deviceProps.physicalEUSimdWidth);
+            printf("\tclock:          %u MHz\n", deviceProps.coreClockRate);
+            printf("\tpeak compute:   %.1f GFLOPS (FP32 FMA)\n", peakGFlops);
+            if (peakGBps > 0.0) {
+                printf("\tpeak bandwidth: %.1f GB/s\n", peakGBps);
+                printf("\tridge point:    %.2f FLOPs/byte\n", peakGFlops / peakGBps);
+            } else {
+                printf("\tpeak bandwidth: unknown, using measured stream bandwidth\n");
+            }
+
+            const size_t deviceSize = std::min<size_t>(size, deviceProps.maxMemAllocSize);
+            const uint32_t elements = (uint32_t)std::min<size_t>(deviceSize / sizeof(float), UINT32_MAX);
+
+            lzutil::TimestampProfiler profiler(context, device);
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            void* buf = nullptr;
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, elements * sizeof(float), 0, device, &buf) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(rooflineSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(rooflineSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = rooflineName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+
+            uint32_t groupSizeX = 1;
+            uint32_t groupSizeY = 1;
+            uint32_t groupSizeZ = 1;
+            CHECK_CALL( zeKernelSuggestGroupSize(kernel, elements, 1, 1, &groupSizeX, &groupSizeY, &groupSizeZ) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, groupSizeX, groupSizeY, groupSizeZ) );
+            CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(buf), &buf) );
+
+            // Only whole work-groups are launched; the tail is not used.
+            ze_group_count_t groupCount = { elements / std::max(groupSizeX, 1u), 1, 1 };
+            const double launched = (double)groupCount.groupCountX * groupSizeX;
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+            if (buf == nullptr || kernel == nullptr || groupCount.groupCountX == 0) {
+                printf("\tSkipping device, setup failed.\n");
+            } else {
+                const float zero = 0.0f;
+                CHECK_CALL( zeCommandListAppendMemoryFill(cmdList, buf, &zero, sizeof(zero),
+                    elements * sizeof(float), nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListClose(cmdList) );
+                CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+                printf("\t%12s %12s %12s %12s %12s %8s\n",
+                    "FLOPs/byte", "Time (us)", "GFLOPS", "GB/s", "Roof GFLOPS", "% Roof");
+
+                // Without a reported peak bandwidth, the measured stream
+                // bandwidth (n = 0) is used for the memory roof.
+                double roofGBps = peakGBps;
+                double bestGFlops = 0.0;
+                double bestGBps = 0.0;
+                for (uint32_t n = 0; n <= maxIntensity; n = (n == 0) ? 1 : n * 2) {
+                    CHECK_CALL( zeKernelSetArgumentValue(kernel, 1, sizeof(n), &n) );
+
+                    // One untimed launch first, so the kernel is resident and
+                    // the clocks have ramped up.
+                    CHECK_CALL( zeCommandListReset(cmdList) );
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                    for (int it = 0; it < iterations; it++) {
+                        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                        CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount,
+                            profiler.signal("roofline"), 0, nullptr) );
+                    }
+                    CHECK_CALL( zeCommandListClose(cmdList) );
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+                    profiler.clear();
+                    profiler.collect();
+
+                    auto summary = profiler.summarize();
+                    const double ns = summary.count("roofline") ? summary["roofline"].minNs : 0.0;
+
+                    const double intensity = flopsPerIteration * n / bytesPerElement;
+                    const double gflops = ns > 0.0 ? launched * flopsPerIteration * n / ns : 0.0;
+                    const double gbps = ns > 0.0 ? launched * bytesPerElement / ns : 0.0;
+                    bestGFlops = std::max(bestGFlops, gflops);
+                    bestGBps = std::max(bestGBps, gbps);
+
+                    if (roofGBps == 0.0) {
+                        roofGBps = gbps;
+                    }
+
+                    const double roof = n == 0 ?
+                        0.0 :
+                        std::min(peakGFlops, intensity * roofGBps);
+                    printf("\t%12.2f %12.2f %12.2f %12.2f %12.2f %8.1f\n",
+                        intensity, ns / 1e3, gflops, gbps, roof,
+                        roof > 0.0 ? 100.0 * gflops / roof : 100.0 * gbps / roofGBps);
+                }
+
+                printf("\tachieved roofline: %.1f GFLOPS (%.1f%% of peak), %.1f GB/s",
+                    bestGFlops, peakGFlops > 0.0 ? 100.0 * bestGFlops / peakGFlops : 0.0,
+                    bestGBps);
+                if (peakGBps > 0.0) {
+                    printf(" (%.1f%% of peak)", 100.0 * bestGBps / peakGBps);
+                }
+                printf("\n");
+            }
+
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            if (buf) CHECK_CALL( zeMemFree(context, buf) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
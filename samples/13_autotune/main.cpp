@@ -0,0 +1,394 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/group_size_tuner.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void transpose(global float* dst, global const float* src)
+//   {
+//       size_t x = get_global_id(0);
+//       size_t y = get_global_id(1);
+//       size_t w = get_global_size(0);
+//       size_t h = get_global_size(1);
+//       dst[x * h + y] = src[y * w + x];
+//   }
+//
+// The reads and writes are coalesced along different dimensions, so the
+// work-group shape matters much more than for a purely 1D kernel.
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %transpose "transpose" %gid_var %gsz_var
+//   OpDecorate %gid_var BuiltIn GlobalInvocationId
+//   OpDecorate %gid_var Constant
+//   OpDecorate %gsz_var BuiltIn GlobalSize
+//   OpDecorate %gsz_var Constant
+//   %void = OpTypeVoid
+//   %ulong = OpTypeInt 64 0
+//   %float = OpTypeFloat 32
+//   %v3ulong = OpTypeVector %ulong 3
+//   %ptr_in = OpTypePointer Input %v3ulong
+//   %ptr = OpTypePointer CrossWorkgroup %float
+//   %fnty = OpTypeFunction %void %ptr %ptr
+//   %gid_var = OpVariable %ptr_in Input
+//   %gsz_var = OpVariable %ptr_in Input
+//   %transpose = OpFunction %void None %fnty
+//   %dst = OpFunctionParameter %ptr
+//   %src = OpFunctionParameter %ptr
+//   %entry = OpLabel
+//   %gid3 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gsz3 = OpLoad %v3ulong %gsz_var Aligned 32
+//   %x = OpCompositeExtract %ulong %gid3 0
+//   %y = OpCompositeExtract %ulong %gid3 1
+//   %w = OpCompositeExtract %ulong %gsz3 0
+//   %h = OpCompositeExtract %ulong %gsz3 1
+//   %yw = OpIMul %ulong %y %w
+//   %si = OpIAdd %ulong %yw %x
+//   %xh = OpIMul %ulong %x %h
+//   %di = OpIAdd %ulong %xh %y
+//   %saddr = OpInBoundsPtrAccessChain %ptr %src %si
+//   %v = OpLoad %float %saddr Aligned 4
+//   %daddr = OpInBoundsPtrAccessChain %ptr %dst %di
+//   OpStore %daddr %v Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t transposeSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001B, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0008000F, 0x00000006, 0x0000000A, 0x6E617274, 0x736F7073, 0x00000065, 0x00000008, 0x00000009,
+    0x00040047, 0x00000008, 0x0000000B, 0x0000001C,
+    0x00030047, 0x00000008, 0x00000016,
+    0x00040047, 0x00000009, 0x0000000B, 0x0000001F,
+    0x00030047, 0x00000009, 0x00000016,
+    0x00020013, 0x00000001,
+    0x00040015, 0x00000002, 0x00000040, 0x00000000,
+    0x00030016, 0x00000003, 0x00000020,
+    0x00040017, 0x00000004, 0x00000002, 0x00000003,
+    0x00040020, 0x00000005, 0x00000001, 0x00000004,
+    0x00040020, 0x00000006, 0x00000005, 0x00000003,
+    0x00050021, 0x00000007, 0x00000001, 0x00000006, 0x00000006,
+    0x0004003B, 0x00000005, 0x00000008, 0x00000001,
+    0x0004003B, 0x00000005, 0x00000009, 0x00000001,
+    0x00050036, 0x00000001, 0x0000000A, 0x00000000, 0x00000007,
+    0x00030037, 0x00000006, 0x0000000B,
+    0x00030037, 0x00000006, 0x0000000C,
+    0x000200F8, 0x0000000D,
+    0x0006003D, 0x00000004, 0x0000000E, 0x00000008, 0x00000002, 0x00000020,
+    0x0006003D, 0x00000004, 0x0000000F, 0x00000009, 0x00000002, 0x00000020,
+    0x00050051, 0x00000002, 0x00000010, 0x0000000E, 0x00000000,
+    0x00050051, 0x00000002, 0x00000011, 0x0000000E, 0x00000001,
+    0x00050051, 0x00000002, 0x00000012, 0x0000000F, 0x00000000,
+    0x00050051, 0x00000002, 0x00000013, 0x0000000F, 0x00000001,
+    0x00050084, 0x00000002, 0x00000014, 0x00000011, 0x00000012,
+    0x00050080, 0x00000002, 0x00000015, 0x00000014, 0x00000010,
+    0x00050084, 0x00000002, 0x00000016, 0x00000010, 0x00000013,
+    0x00050080, 0x00000002, 0x00000017, 0x00000016, 0x00000011,
+    0x00050046, 0x00000006, 0x00000018, 0x0000000C, 0x00000015,
+    0x0006003D, 0x00000003, 0x00000019, 0x00000018, 0x00000002, 0x00000004,
+    0x00050046, 0x00000006, 0x0000001A, 0x0000000B, 0x00000017,
+    0x0005003E, 0x0000001A, 0x00000019, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char transposeName[] = "transpose";
+
+// Returns a copy of a SPIR-V module with a required sub-group size, which is
+// what intel_reqd_sub_group_size produces.  The execution mode needs SPIR-V
+// 1.1 and the SubgroupDispatch capability; drivers that reject the module
+// simply skip that sub-group size.
+static std::vector<uint32_t> SetRequiredSubGroupSize(
+    const uint32_t* spirv,
+    size_t numWords,
+    uint32_t subGroupSize )
+{
+    const uint32_t opEntryPoint = 15;
+    const uint32_t opExecutionMode = 16;
+    const uint32_t opCapability = 17;
+    const uint32_t capabilitySubgroupDispatch = 58;
+    const uint32_t executionModeSubgroupSize = 35;
+    const size_t headerWords = 5;
+
+    std::vector<uint32_t> ret(spirv, spirv + headerWords);
+    ret[1] = std::max<uint32_t>(ret[1], 0x00010100);
+    ret.push_back((2 << 16) | opCapability);
+    ret.push_back(capabilitySubgroupDispatch);
+
+    size_t i = headerWords;
+    while (i < numWords) {
+        const uint32_t wordCount = spirv[i] >> 16;
+        const uint32_t opCode = spirv[i] & 0xFFFF;
+        if (wordCount == 0 || i + wordCount > numWords) {
+            break;
+        }
+        ret.insert(ret.end(), spirv + i, spirv + i + wordCount);
+        if (opCode == opEntryPoint) {
+            ret.push_back((4 << 16) | opExecutionMode);
+            ret.push_back(spirv[i + 2]);
+            ret.push_back(executionModeSubgroupSize);
+            ret.push_back(subGroupSize);
+        }
+        i += wordCount;
+    }
+
+    return ret;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    uint32_t width = 2048;
+    uint32_t height = 2048;
+    uint32_t iterations = 5;
+    std::string dbPath("autotune.db");
+    bool force = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<uint32_t>>("", "width", "Matrix Width", width, &width);
+        op.add<popl::Value<uint32_t>>("", "height", "Matrix Height", height, &height);
+        op.add<popl::Value<uint32_t>>("i", "iterations", "Measurements per Configuration", iterations, &iterations);
+        op.add<popl::Value<std::string>>("", "db", "Tuning Database File", dbPath, &dbPath);
+        op.add<popl::Switch>("f", "force", "Retune Even if Cached", &force);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            width == 0 || height == 0 || iterations == 0) {
+            fprintf(stderr,
+                "Usage: autotune [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    lzutil::GroupSizeTuner tuner(dbPath, iterations);
+
+    const size_t elements = (size_t)width * height;
+
+    std::vector<float> hostSrc(elements);
+    for (size_t e = 0; e < elements; e++) {
+        hostSrc[e] = (float)e;
+    }
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            void* src = nullptr;
+            void* dst = nullptr;
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, elements * sizeof(float), 0, device, &src) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, elements * sizeof(float), 0, device, &dst) );
+
+            // Modules must outlive the kernels created from them, so they
+            // are kept until the device is done.
+            std::vector<ze_module_handle_t> modules;
+            auto createKernel = [&](uint32_t subGroupSize) -> ze_kernel_handle_t {
+                std::vector<uint32_t> spirv(transposeSPIRV,
+                    transposeSPIRV + sizeof(transposeSPIRV) / sizeof(transposeSPIRV[0]));
+                if (subGroupSize != 0) {
+                    spirv = SetRequiredSubGroupSize(spirv.data(), spirv.size(), subGroupSize);
+                }
+
+                ze_module_desc_t moduleDesc = {};
+                moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+                moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+                moduleDesc.inputSize = spirv.size() * sizeof(uint32_t);
+                moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(spirv.data());
+
+                ze_module_handle_t module = nullptr;
+                if (zeModuleCreate(context, device, &moduleDesc, &module, nullptr) != ZE_RESULT_SUCCESS) {
+                    return nullptr;
+                }
+                modules.push_back(module);
+
+                ze_kernel_desc_t kernelDesc = {};
+                kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+                kernelDesc.pKernelName = transposeName;
+
+                ze_kernel_handle_t kernel = nullptr;
+                if (zeKernelCreate(module, &kernelDesc, &kernel) != ZE_RESULT_SUCCESS) {
+                    return nullptr;
+                }
+                zeKernelSetArgumentValue(kernel, 0, sizeof(dst), &dst);
+                zeKernelSetArgumentValue(kernel, 1, sizeof(src), &src);
+                return kernel;
+            };
+
+            lzutil::GroupSizeTuner::Result tuned;
+            result = tuner.tune(driver, context, device, transposeName,
+                width, height, 1, createKernel, tuned, force);
+            if (result != ZE_RESULT_SUCCESS) {
+                printf("\tTuning failed (%u)!\n", result);
+            } else {
+                const auto& b = tuned.best;
+                const auto& s = tuned.suggested;
+                if (tuned.cached) {
+                    printf("\ttuning:         cached in %s\n", tuner.dbPath().c_str());
+                } else {
+                    printf("\ttuning:         measured %zu configurations\n", tuned.measured);
+                }
+                printf("\tsuggested:      %4u x %4u x %4u, %-8s %10.2f us\n",
+                    s.groupSizeX, s.groupSizeY, s.groupSizeZ, "default", s.ns / 1e3);
+                printf("\ttuned:          %4u x %4u x %4u, %-8s %10.2f us (%.2fx)\n",
+                    b.groupSizeX, b.groupSizeY, b.groupSizeZ,
+                    b.subGroupSize ? ("SIMD" + std::to_string(b.subGroupSize)).c_str() : "default",
+                    b.ns / 1e3, b.ns > 0.0 ? s.ns / b.ns : 1.0);
+
+                // Apply the tuned configuration and check the result.
+                ze_kernel_handle_t kernel = createKernel(b.subGroupSize);
+
+                ze_command_queue_desc_t queueDesc = {};
+                queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+                queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+                ze_command_queue_handle_t queue = nullptr;
+                CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+                ze_command_list_desc_t cmdListDesc = {};
+                cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+                ze_command_list_handle_t cmdList = nullptr;
+                CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+                std::vector<float> hostDst(elements, -1.0f);
+                if (kernel != nullptr) {
+                    ze_group_count_t groupCount = {
+                        width / b.groupSizeX, height / b.groupSizeY, 1 / b.groupSizeZ };
+
+                    CHECK_CALL( zeKernelSetGroupSize(kernel, b.groupSizeX, b.groupSizeY, b.groupSizeZ) );
+                    CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, src, hostSrc.data(),
+                        elements * sizeof(float), nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, hostDst.data(), dst,
+                        elements * sizeof(float), nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListClose(cmdList) );
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+                    CHECK_CALL( zeKernelDestroy(kernel) );
+                }
+
+                size_t mismatches = 0;
+                for (uint32_t y = 0; y < height; y++) {
+                    for (uint32_t x = 0; x < width; x++) {
+                        if (hostDst[(size_t)x * height + y] != hostSrc[(size_t)y * width + x]) {
+                            mismatches++;
+                        }
+                    }
+                }
+                printf("\tvalidation:     %s (%zu mismatches)\n",
+                    mismatches ? "FAILED" : "passed", mismatches);
+
+                CHECK_CALL( zeCommandListDestroy(cmdList) );
+                CHECK_CALL( zeCommandQueueDestroy(queue) );
+            }
+
+            for (auto module : modules) {
+                CHECK_CALL( zeModuleDestroy(module) );
+            }
+            CHECK_CALL( zeMemFree(context, dst) );
+            CHECK_CALL( zeMemFree(context, src) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,423 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// SPIR-V for the OpenCL C kernel:
+//
+//   kernel void touch(global uint* buf)
+//   {
+//       buf[get_global_id(0)] += 1;
+//   }
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %touch "touch" %gid_var
+//   OpDecorate %gid_var BuiltIn GlobalInvocationId
+//   OpDecorate %gid_var Constant
+//   %void = OpTypeVoid
+//   %uint = OpTypeInt 32 0
+//   %ulong = OpTypeInt 64 0
+//   %v3ulong = OpTypeVector %ulong 3
+//   %ptr_in = OpTypePointer Input %v3ulong
+//   %ptr = OpTypePointer CrossWorkgroup %uint
+//   %fnty = OpTypeFunction %void %ptr
+//   %c1 = OpConstant %uint 1
+//   %gid_var = OpVariable %ptr_in Input
+//   %touch = OpFunction %void None %fnty
+//   %buf = OpFunctionParameter %ptr
+//   %entry = OpLabel
+//   %gid3 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gid = OpCompositeExtract %ulong %gid3 0
+//   %addr = OpInBoundsPtrAccessChain %ptr %buf %gid
+//   %x = OpLoad %uint %addr Aligned 4
+//   %y = OpIAdd %uint %x %c1
+//   OpStore %addr %y Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t touchSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000012, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0006000F, 0x00000006, 0x0000000A, 0x63756F74, 0x00000068, 0x00000009,
+    0x00040047, 0x00000009, 0x0000000B, 0x0000001C,
+    0x00030047, 0x00000009, 0x00000016,
+    0x00020013, 0x00000001,
+    0x00040015, 0x00000002, 0x00000020, 0x00000000,
+    0x00040015, 0x00000003, 0x00000040, 0x00000000,
+    0x00040017, 0x00000004, 0x00000003, 0x00000003,
+    0x00040020, 0x00000005, 0x00000001, 0x00000004,
+    0x00040020, 0x00000006, 0x00000005, 0x00000002,
+    0x00040021, 0x00000007, 0x00000001, 0x00000006,
+    0x0004002B, 0x00000002, 0x00000008, 0x00000001,
+    0x0004003B, 0x00000005, 0x00000009, 0x00000001,
+    0x00050036, 0x00000001, 0x0000000A, 0x00000000, 0x00000007,
+    0x00030037, 0x00000006, 0x0000000B,
+    0x000200F8, 0x0000000C,
+    0x0006003D, 0x00000004, 0x0000000D, 0x00000009, 0x00000002, 0x00000020,
+    0x00050051, 0x00000003, 0x0000000E, 0x0000000D, 0x00000000,
+    0x00050046, 0x00000006, 0x0000000F, 0x0000000B, 0x0000000E,
+    0x0006003D, 0x00000002, 0x00000010, 0x0000000F, 0x00000002, 0x00000004,
+    0x00050080, 0x00000002, 0x00000011, 0x00000010, 0x00000008,
+    0x0005003E, 0x0000000F, 0x00000011, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char touchName[] = "touch";
+
+struct Variant {
+    const char*         name;
+    bool                shared;
+    bool                prefetch;
+    bool                advise;
+    ze_memory_advice_t  advice;
+};
+
+static const Variant variants[] = {
+    { "device",             false,  false,  false,  ZE_MEMORY_ADVICE_SET_READ_MOSTLY },
+    { "shared",             true,   false,  false,  ZE_MEMORY_ADVICE_SET_READ_MOSTLY },
+    { "prefetch",           true,   true,   false,  ZE_MEMORY_ADVICE_SET_READ_MOSTLY },
+    { "preferred",          true,   false,  true,   ZE_MEMORY_ADVICE_SET_PREFERRED_LOCATION },
+    { "preferred+prefetch", true,   true,   true,   ZE_MEMORY_ADVICE_SET_PREFERRED_LOCATION },
+    { "read-mostly",        true,   false,  true,   ZE_MEMORY_ADVICE_SET_READ_MOSTLY },
+    { "bias-cached",        true,   false,  true,   ZE_MEMORY_ADVICE_BIAS_CACHED },
+};
+
+// All times are in microseconds.  Negative times were not measured.
+struct Timings {
+    double  first;          // first device access after host initialization
+    double  resident;       // device access with no host access in between
+    double  hostToDevice;   // device access right after a host access
+    double  deviceToHost;   // host access right after a device access
+};
+
+static double Execute(
+    ze_command_queue_handle_t queue,
+    ze_command_list_handle_t cmdList )
+{
+    auto start = clk::now();
+    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+    auto end = clk::now();
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static double TouchOnHost(
+    uint32_t* buf,
+    size_t count )
+{
+    auto start = clk::now();
+    for (size_t i = 0; i < count; i++) {
+        buf[i] += 1;
+    }
+    auto end = clk::now();
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static Timings MeasureVariant(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    ze_command_queue_handle_t queue,
+    ze_command_list_handle_t cmdList,
+    ze_kernel_handle_t kernel,
+    uint32_t groupSizeX,
+    size_t count,
+    const Variant& variant,
+    int iterations )
+{
+    Timings t = { -1.0, -1.0, -1.0, -1.0 };
+    const size_t size = count * sizeof(uint32_t);
+
+    ze_device_mem_alloc_desc_t deviceDesc = {};
+    deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+    ze_host_mem_alloc_desc_t hostDesc = {};
+    hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+    void* buf = nullptr;
+    if (variant.shared) {
+        CHECK_CALL( zeMemAllocShared(context, &deviceDesc, &hostDesc, size, 0, device, &buf) );
+    } else {
+        CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &buf) );
+    }
+    if (buf == nullptr) {
+        return t;
+    }
+
+    // The memory advice is applied once, before the allocation is touched.
+    if (variant.advise) {
+        CHECK_CALL( zeCommandListReset(cmdList) );
+        CHECK_CALL( zeCommandListAppendMemAdvise(cmdList, device, buf, size, variant.advice) );
+        CHECK_CALL( zeCommandListClose(cmdList) );
+        Execute(queue, cmdList);
+    }
+
+    if (variant.shared) {
+        memset(buf, 0, size);
+    } else {
+        const uint32_t zero = 0;
+        CHECK_CALL( zeCommandListReset(cmdList) );
+        CHECK_CALL( zeCommandListAppendMemoryFill(cmdList, buf, &zero, sizeof(zero), size, nullptr, 0, nullptr) );
+        CHECK_CALL( zeCommandListClose(cmdList) );
+        Execute(queue, cmdList);
+    }
+
+    ze_group_count_t groupCount = { (uint32_t)(count / groupSizeX), 1, 1 };
+
+    CHECK_CALL( zeCommandListReset(cmdList) );
+    if (variant.prefetch) {
+        CHECK_CALL( zeCommandListAppendMemoryPrefetch(cmdList, buf, size) );
+        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+    }
+    CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(buf), &buf) );
+    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+    CHECK_CALL( zeCommandListClose(cmdList) );
+
+    t.first = Execute(queue, cmdList);
+
+    for (int i = 0; i < iterations; i++) {
+        const double us = Execute(queue, cmdList);
+        t.resident = (i == 0) ? us : std::min(t.resident, us);
+    }
+
+    if (variant.shared) {
+        for (int i = 0; i < iterations; i++) {
+            const double d2h = TouchOnHost(static_cast<uint32_t*>(buf), count);
+            const double h2d = Execute(queue, cmdList);
+            t.deviceToHost = (i == 0) ? d2h : std::min(t.deviceToHost, d2h);
+            t.hostToDevice = (i == 0) ? h2d : std::min(t.hostToDevice, h2d);
+        }
+    }
+
+    CHECK_CALL( zeMemFree(context, buf) );
+    return t;
+}
+
+static void PrintTime(
+    double us )
+{
+    if (us < 0.0) {
+        printf(" %12s", "-");
+    } else {
+        printf(" %12.2f", us);
+    }
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t minSize = 64 * 1024;
+    size_t maxSize = 64 * 1024 * 1024;
+    int iterations = 8;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("", "minsize", "Minimum Allocation Size (bytes, multiple of 4)", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "maxsize", "Maximum Allocation Size (bytes)", maxSize, &maxSize);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations", iterations, &iterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            minSize < sizeof(uint32_t) || minSize % sizeof(uint32_t) != 0 ||
+            maxSize < minSize || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: usmmigrate [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_device_memory_access_properties_t accessProps = {};
+            accessProps.stype = ZE_STRUCTURE_TYPE_DEVICE_MEMORY_ACCESS_PROPERTIES;
+            zeDeviceGetMemoryAccessProperties(device, &accessProps);
+
+            const bool sharedSupported =
+                (accessProps.sharedSingleDeviceAllocCapabilities & ZE_MEMORY_ACCESS_CAP_FLAG_RW) != 0;
+            if (!sharedSupported) {
+                printf("\tShared allocations are not supported, measuring device allocations only.\n");
+            }
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(touchSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(touchSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = touchName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+
+            // Sizes are rounded to whole work-groups, so the suggestion for
+            // the smallest size is used for all of them.
+            uint32_t groupSizeX = 1;
+            uint32_t groupSizeY = 1;
+            uint32_t groupSizeZ = 1;
+            CHECK_CALL( zeKernelSuggestGroupSize(kernel, (uint32_t)(minSize / sizeof(uint32_t)), 1, 1,
+                &groupSizeX, &groupSizeY, &groupSizeZ) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, groupSizeX, groupSizeY, groupSizeZ) );
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+            printf("\tAll times in microseconds, minimum of %d iterations:\n", iterations);
+            printf("\t  first:    first device access after host initialization\n");
+            printf("\t  resident: device access with no host access in between\n");
+            printf("\t  h->d:     device access right after a host access\n");
+            printf("\t  d->h:     host access right after a device access\n");
+
+            const size_t granularity = sizeof(uint32_t) * groupSizeX;
+            for (size_t size = minSize; size <= maxSize; size *= 2) {
+                const size_t count = std::max<size_t>(size / granularity, 1) * groupSizeX;
+                printf("\n\t%zu bytes:\n", count * sizeof(uint32_t));
+                printf("\t%-20s %12s %12s %12s %12s %12s\n",
+                    "", "first", "resident", "h->d", "d->h", "h->d GB/s");
+
+                for (auto& variant : variants) {
+                    if (variant.shared && !sharedSupported) {
+                        continue;
+                    }
+                    Timings t = MeasureVariant(context, device, queue, cmdList, kernel,
+                        groupSizeX, count, variant, iterations);
+
+                    printf("\t%-20s", variant.name);
+                    PrintTime(t.first);
+                    PrintTime(t.resident);
+                    PrintTime(t.hostToDevice);
+                    PrintTime(t.deviceToHost);
+
+                    // Effective migration bandwidth, excluding the kernel.
+                    const double migrateUs = t.hostToDevice - t.resident;
+                    if (t.hostToDevice >= 0.0 && migrateUs > 0.0) {
+                        printf(" %12.2f", count * sizeof(uint32_t) / migrateUs / 1e3);
+                    } else {
+                        printf(" %12s", "-");
+                    }
+                    printf("\n");
+                }
+            }
+
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
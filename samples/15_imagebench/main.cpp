@@ -0,0 +1,791 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "zello_log.h"
+#include "lzutil/timestamp_profiler.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+// SPIR-V for the OpenCL C kernels:
+//
+//   kernel void sample1d(read_only image1d_t img, sampler_t s, global float* out)
+//   {
+//       size_t x = get_global_id(0);
+//       float u = (x + 0.5f) / get_global_size(0);
+//       float4 v = read_imagef(img, s, u);
+//       out[x] = v.x + v.y + v.z + v.w;
+//   }
+//
+//   kernel void sample2d(read_only image2d_t img, sampler_t s, global float* out)
+//   {
+//       size_t x = get_global_id(0);
+//       size_t y = get_global_id(1);
+//       float2 uv = (float2)((x + 0.5f) / get_global_size(0),
+//                            (y + 0.5f) / get_global_size(1));
+//       float4 v = read_imagef(img, s, uv);
+//       out[y * get_global_size(0) + x] = v.x + v.y + v.z + v.w;
+//   }
+//
+//   kernel void sample3d(read_only image3d_t img, sampler_t s, global float* out)
+//   {
+//       size_t x = get_global_id(0);
+//       size_t y = get_global_id(1);
+//       size_t z = get_global_id(2);
+//       float4 uvw = (float4)((x + 0.5f) / get_global_size(0),
+//                             (y + 0.5f) / get_global_size(1),
+//                             (z + 0.5f) / get_global_size(2), 0.0f);
+//       float4 v = read_imagef(img, s, uvw);
+//       out[(z * get_global_size(1) + y) * get_global_size(0) + x] =
+//           v.x + v.y + v.z + v.w;
+//   }
+//
+// Each work-item writes a single float, so the kernel time is dominated by
+// the image reads.
+//
+//   OpCapability Addresses
+//   OpCapability Kernel
+//   OpCapability Int64
+//   OpCapability ImageBasic
+//   OpMemoryModel Physical64 OpenCL
+//   OpEntryPoint Kernel %sample1d "sample1d" %gid_var %gsz_var
+//   OpEntryPoint Kernel %sample2d "sample2d" %gid_var %gsz_var
+//   OpEntryPoint Kernel %sample3d "sample3d" %gid_var %gsz_var
+//   OpDecorate %gid_var BuiltIn GlobalInvocationId
+//   OpDecorate %gid_var Constant
+//   OpDecorate %gsz_var BuiltIn GlobalSize
+//   OpDecorate %gsz_var Constant
+//   %void = OpTypeVoid
+//   %ulong = OpTypeInt 64 0
+//   %float = OpTypeFloat 32
+//   %v2float = OpTypeVector %float 2
+//   %v4float = OpTypeVector %float 4
+//   %v3ulong = OpTypeVector %ulong 3
+//   %ptr_in = OpTypePointer Input %v3ulong
+//   %ptr = OpTypePointer CrossWorkgroup %float
+//   %img1d = OpTypeImage %void 0 0 0 0 0 0 0
+//   %img2d = OpTypeImage %void 1 0 0 0 0 0 0
+//   %img3d = OpTypeImage %void 2 0 0 0 0 0 0
+//   %sampler = OpTypeSampler
+//   %simg1d = OpTypeSampledImage %img1d
+//   %simg2d = OpTypeSampledImage %img2d
+//   %simg3d = OpTypeSampledImage %img3d
+//   %fn1d = OpTypeFunction %void %img1d %sampler %ptr
+//   %fn2d = OpTypeFunction %void %img2d %sampler %ptr
+//   %fn3d = OpTypeFunction %void %img3d %sampler %ptr
+//   %half = OpConstant %float 0.5
+//   %f0 = OpConstant %float 0.0
+//   %gid_var = OpVariable %ptr_in Input
+//   %gsz_var = OpVariable %ptr_in Input
+//   %sample1d = OpFunction %void None %fn1d
+//   %img_1d = OpFunctionParameter %img1d
+//   %smp_1d = OpFunctionParameter %sampler
+//   %out_1d = OpFunctionParameter %ptr
+//   %entry_1d = OpLabel
+//   %gid3_1 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gsz3_1 = OpLoad %v3ulong %gsz_var Aligned 32
+//   %gi1_0 = OpCompositeExtract %ulong %gid3_1 0
+//   %gs1_0 = OpCompositeExtract %ulong %gsz3_1 0
+//   %gif1_0 = OpConvertUToF %float %gi1_0
+//   %gsf1_0 = OpConvertUToF %float %gs1_0
+//   %c1_0 = OpFAdd %float %gif1_0 %half
+//   %u1_0 = OpFDiv %float %c1_0 %gsf1_0
+//   %si_1d = OpSampledImage %simg1d %img_1d %smp_1d
+//   %v_1d = OpImageSampleExplicitLod %v4float %si_1d %u1_0 2 %f0
+//   %vx_1d = OpCompositeExtract %float %v_1d 0
+//   %vy_1d = OpCompositeExtract %float %v_1d 1
+//   %vz_1d = OpCompositeExtract %float %v_1d 2
+//   %vw_1d = OpCompositeExtract %float %v_1d 3
+//   %sxy_1d = OpFAdd %float %vx_1d %vy_1d
+//   %szw_1d = OpFAdd %float %vz_1d %vw_1d
+//   %s_1d = OpFAdd %float %sxy_1d %szw_1d
+//   %addr_1d = OpInBoundsPtrAccessChain %ptr %out_1d %gi1_0
+//   OpStore %addr_1d %s_1d Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+//   %sample2d = OpFunction %void None %fn2d
+//   %img_2d = OpFunctionParameter %img2d
+//   %smp_2d = OpFunctionParameter %sampler
+//   %out_2d = OpFunctionParameter %ptr
+//   %entry_2d = OpLabel
+//   %gid3_2 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gsz3_2 = OpLoad %v3ulong %gsz_var Aligned 32
+//   %gi2_0 = OpCompositeExtract %ulong %gid3_2 0
+//   %gs2_0 = OpCompositeExtract %ulong %gsz3_2 0
+//   %gif2_0 = OpConvertUToF %float %gi2_0
+//   %gsf2_0 = OpConvertUToF %float %gs2_0
+//   %c2_0 = OpFAdd %float %gif2_0 %half
+//   %u2_0 = OpFDiv %float %c2_0 %gsf2_0
+//   %gi2_1 = OpCompositeExtract %ulong %gid3_2 1
+//   %gs2_1 = OpCompositeExtract %ulong %gsz3_2 1
+//   %gif2_1 = OpConvertUToF %float %gi2_1
+//   %gsf2_1 = OpConvertUToF %float %gs2_1
+//   %c2_1 = OpFAdd %float %gif2_1 %half
+//   %u2_1 = OpFDiv %float %c2_1 %gsf2_1
+//   %uv_2 = OpCompositeConstruct %v2float %u2_0 %u2_1
+//   %row_2 = OpIMul %ulong %gi2_1 %gs2_0
+//   %idx_2 = OpIAdd %ulong %row_2 %gi2_0
+//   %si_2d = OpSampledImage %simg2d %img_2d %smp_2d
+//   %v_2d = OpImageSampleExplicitLod %v4float %si_2d %uv_2 2 %f0
+//   %vx_2d = OpCompositeExtract %float %v_2d 0
+//   %vy_2d = OpCompositeExtract %float %v_2d 1
+//   %vz_2d = OpCompositeExtract %float %v_2d 2
+//   %vw_2d = OpCompositeExtract %float %v_2d 3
+//   %sxy_2d = OpFAdd %float %vx_2d %vy_2d
+//   %szw_2d = OpFAdd %float %vz_2d %vw_2d
+//   %s_2d = OpFAdd %float %sxy_2d %szw_2d
+//   %addr_2d = OpInBoundsPtrAccessChain %ptr %out_2d %idx_2
+//   OpStore %addr_2d %s_2d Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+//   %sample3d = OpFunction %void None %fn3d
+//   %img_3d = OpFunctionParameter %img3d
+//   %smp_3d = OpFunctionParameter %sampler
+//   %out_3d = OpFunctionParameter %ptr
+//   %entry_3d = OpLabel
+//   %gid3_3 = OpLoad %v3ulong %gid_var Aligned 32
+//   %gsz3_3 = OpLoad %v3ulong %gsz_var Aligned 32
+//   %gi3_0 = OpCompositeExtract %ulong %gid3_3 0
+//   %gs3_0 = OpCompositeExtract %ulong %gsz3_3 0
+//   %gif3_0 = OpConvertUToF %float %gi3_0
+//   %gsf3_0 = OpConvertUToF %float %gs3_0
+//   %c3_0 = OpFAdd %float %gif3_0 %half
+//   %u3_0 = OpFDiv %float %c3_0 %gsf3_0
+//   %gi3_1 = OpCompositeExtract %ulong %gid3_3 1
+//   %gs3_1 = OpCompositeExtract %ulong %gsz3_3 1
+//   %gif3_1 = OpConvertUToF %float %gi3_1
+//   %gsf3_1 = OpConvertUToF %float %gs3_1
+//   %c3_1 = OpFAdd %float %gif3_1 %half
+//   %u3_1 = OpFDiv %float %c3_1 %gsf3_1
+//   %gi3_2 = OpCompositeExtract %ulong %gid3_3 2
+//   %gs3_2 = OpCompositeExtract %ulong %gsz3_3 2
+//   %gif3_2 = OpConvertUToF %float %gi3_2
+//   %gsf3_2 = OpConvertUToF %float %gs3_2
+//   %c3_2 = OpFAdd %float %gif3_2 %half
+//   %u3_2 = OpFDiv %float %c3_2 %gsf3_2
+//   %uv_3 = OpCompositeConstruct %v4float %u3_0 %u3_1 %u3_2 %f0
+//   %pl_3 = OpIMul %ulong %gi3_2 %gs3_1
+//   %pr_3 = OpIAdd %ulong %pl_3 %gi3_1
+//   %row_3 = OpIMul %ulong %pr_3 %gs3_0
+//   %idx_3 = OpIAdd %ulong %row_3 %gi3_0
+//   %si_3d = OpSampledImage %simg3d %img_3d %smp_3d
+//   %v_3d = OpImageSampleExplicitLod %v4float %si_3d %uv_3 2 %f0
+//   %vx_3d = OpCompositeExtract %float %v_3d 0
+//   %vy_3d = OpCompositeExtract %float %v_3d 1
+//   %vz_3d = OpCompositeExtract %float %v_3d 2
+//   %vw_3d = OpCompositeExtract %float %v_3d 3
+//   %sxy_3d = OpFAdd %float %vx_3d %vy_3d
+//   %szw_3d = OpFAdd %float %vz_3d %vw_3d
+//   %s_3d = OpFAdd %float %sxy_3d %szw_3d
+//   %addr_3d = OpInBoundsPtrAccessChain %ptr %out_3d %idx_3
+//   OpStore %addr_3d %s_3d Aligned 4
+//   OpReturn
+//   OpFunctionEnd
+static const uint32_t sampleSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000076, 0x00000000,
+    0x00020011, 0x00000004,
+    0x00020011, 0x00000006,
+    0x00020011, 0x0000000B,
+    0x00020011, 0x0000000D,
+    0x0003000E, 0x00000002, 0x00000002,
+    0x0008000F, 0x00000006, 0x00000017, 0x706D6173, 0x6431656C, 0x00000000, 0x00000015, 0x00000016,
+    0x0008000F, 0x00000006, 0x0000002E, 0x706D6173, 0x6432656C, 0x00000000, 0x00000015, 0x00000016,
+    0x0008000F, 0x00000006, 0x0000004E, 0x706D6173, 0x6433656C, 0x00000000, 0x00000015, 0x00000016,
+    0x00040047, 0x00000015, 0x0000000B, 0x0000001C,
+    0x00030047, 0x00000015, 0x00000016,
+    0x00040047, 0x00000016, 0x0000000B, 0x0000001F,
+    0x00030047, 0x00000016, 0x00000016,
+    0x00020013, 0x00000001,
+    0x00040015, 0x00000002, 0x00000040, 0x00000000,
+    0x00030016, 0x00000003, 0x00000020,
+    0x00040017, 0x00000004, 0x00000003, 0x00000002,
+    0x00040017, 0x00000005, 0x00000003, 0x00000004,
+    0x00040017, 0x00000006, 0x00000002, 0x00000003,
+    0x00040020, 0x00000007, 0x00000001, 0x00000006,
+    0x00040020, 0x00000008, 0x00000005, 0x00000003,
+    0x000A0019, 0x00000009, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x000A0019, 0x0000000A, 0x00000001, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x000A0019, 0x0000000B, 0x00000001, 0x00000002, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x0002001A, 0x0000000C,
+    0x0003001B, 0x0000000D, 0x00000009,
+    0x0003001B, 0x0000000E, 0x0000000A,
+    0x0003001B, 0x0000000F, 0x0000000B,
+    0x00060021, 0x00000010, 0x00000001, 0x00000009, 0x0000000C, 0x00000008,
+    0x00060021, 0x00000011, 0x00000001, 0x0000000A, 0x0000000C, 0x00000008,
+    0x00060021, 0x00000012, 0x00000001, 0x0000000B, 0x0000000C, 0x00000008,
+    0x0004002B, 0x00000003, 0x00000013, 0x3F000000,
+    0x0004002B, 0x00000003, 0x00000014, 0x00000000,
+    0x0004003B, 0x00000007, 0x00000015, 0x00000001,
+    0x0004003B, 0x00000007, 0x00000016, 0x00000001,
+    0x00050036, 0x00000001, 0x00000017, 0x00000000, 0x00000010,
+    0x00030037, 0x00000009, 0x00000018,
+    0x00030037, 0x0000000C, 0x00000019,
+    0x00030037, 0x00000008, 0x0000001A,
+    0x000200F8, 0x0000001B,
+    0x0006003D, 0x00000006, 0x0000001C, 0x00000015, 0x00000002, 0x00000020,
+    0x0006003D, 0x00000006, 0x0000001D, 0x00000016, 0x00000002, 0x00000020,
+    0x00050051, 0x00000002, 0x0000001E, 0x0000001C, 0x00000000,
+    0x00050051, 0x00000002, 0x0000001F, 0x0000001D, 0x00000000,
+    0x00040070, 0x00000003, 0x00000020, 0x0000001E,
+    0x00040070, 0x00000003, 0x00000021, 0x0000001F,
+    0x00050081, 0x00000003, 0x00000022, 0x00000020, 0x00000013,
+    0x00050088, 0x00000003, 0x00000023, 0x00000022, 0x00000021,
+    0x00050056, 0x0000000D, 0x00000024, 0x00000018, 0x00000019,
+    0x00070058, 0x00000005, 0x00000025, 0x00000024, 0x00000023, 0x00000002, 0x00000014,
+    0x00050051, 0x00000003, 0x00000026, 0x00000025, 0x00000000,
+    0x00050051, 0x00000003, 0x00000027, 0x00000025, 0x00000001,
+    0x00050051, 0x00000003, 0x00000028, 0x00000025, 0x00000002,
+    0x00050051, 0x00000003, 0x00000029, 0x00000025, 0x00000003,
+    0x00050081, 0x00000003, 0x0000002A, 0x00000026, 0x00000027,
+    0x00050081, 0x00000003, 0x0000002B, 0x00000028, 0x00000029,
+    0x00050081, 0x00000003, 0x0000002C, 0x0000002A, 0x0000002B,
+    0x00050046, 0x00000008, 0x0000002D, 0x0000001A, 0x0000001E,
+    0x0005003E, 0x0000002D, 0x0000002C, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+    0x00050036, 0x00000001, 0x0000002E, 0x00000000, 0x00000011,
+    0x00030037, 0x0000000A, 0x0000002F,
+    0x00030037, 0x0000000C, 0x00000030,
+    0x00030037, 0x00000008, 0x00000031,
+    0x000200F8, 0x00000032,
+    0x0006003D, 0x00000006, 0x00000033, 0x00000015, 0x00000002, 0x00000020,
+    0x0006003D, 0x00000006, 0x00000034, 0x00000016, 0x00000002, 0x00000020,
+    0x00050051, 0x00000002, 0x00000035, 0x00000033, 0x00000000,
+    0x00050051, 0x00000002, 0x00000036, 0x00000034, 0x00000000,
+    0x00040070, 0x00000003, 0x00000037, 0x00000035,
+    0x00040070, 0x00000003, 0x00000038, 0x00000036,
+    0x00050081, 0x00000003, 0x00000039, 0x00000037, 0x00000013,
+    0x00050088, 0x00000003, 0x0000003A, 0x00000039, 0x00000038,
+    0x00050051, 0x00000002, 0x0000003B, 0x00000033, 0x00000001,
+    0x00050051, 0x00000002, 0x0000003C, 0x00000034, 0x00000001,
+    0x00040070, 0x00000003, 0x0000003D, 0x0000003B,
+    0x00040070, 0x00000003, 0x0000003E, 0x0000003C,
+    0x00050081, 0x00000003, 0x0000003F, 0x0000003D, 0x00000013,
+    0x00050088, 0x00000003, 0x00000040, 0x0000003F, 0x0000003E,
+    0x00050050, 0x00000004, 0x00000041, 0x0000003A, 0x00000040,
+    0x00050084, 0x00000002, 0x00000042, 0x0000003B, 0x00000036,
+    0x00050080, 0x00000002, 0x00000043, 0x00000042, 0x00000035,
+    0x00050056, 0x0000000E, 0x00000044, 0x0000002F, 0x00000030,
+    0x00070058, 0x00000005, 0x00000045, 0x00000044, 0x00000041, 0x00000002, 0x00000014,
+    0x00050051, 0x00000003, 0x00000046, 0x00000045, 0x00000000,
+    0x00050051, 0x00000003, 0x00000047, 0x00000045, 0x00000001,
+    0x00050051, 0x00000003, 0x00000048, 0x00000045, 0x00000002,
+    0x00050051, 0x00000003, 0x00000049, 0x00000045, 0x00000003,
+    0x00050081, 0x00000003, 0x0000004A, 0x00000046, 0x00000047,
+    0x00050081, 0x00000003, 0x0000004B, 0x00000048, 0x00000049,
+    0x00050081, 0x00000003, 0x0000004C, 0x0000004A, 0x0000004B,
+    0x00050046, 0x00000008, 0x0000004D, 0x00000031, 0x00000043,
+    0x0005003E, 0x0000004D, 0x0000004C, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+    0x00050036, 0x00000001, 0x0000004E, 0x00000000, 0x00000012,
+    0x00030037, 0x0000000B, 0x0000004F,
+    0x00030037, 0x0000000C, 0x00000050,
+    0x00030037, 0x00000008, 0x00000051,
+    0x000200F8, 0x00000052,
+    0x0006003D, 0x00000006, 0x00000053, 0x00000015, 0x00000002, 0x00000020,
+    0x0006003D, 0x00000006, 0x00000054, 0x00000016, 0x00000002, 0x00000020,
+    0x00050051, 0x00000002, 0x00000055, 0x00000053, 0x00000000,
+    0x00050051, 0x00000002, 0x00000056, 0x00000054, 0x00000000,
+    0x00040070, 0x00000003, 0x00000057, 0x00000055,
+    0x00040070, 0x00000003, 0x00000058, 0x00000056,
+    0x00050081, 0x00000003, 0x00000059, 0x00000057, 0x00000013,
+    0x00050088, 0x00000003, 0x0000005A, 0x00000059, 0x00000058,
+    0x00050051, 0x00000002, 0x0000005B, 0x00000053, 0x00000001,
+    0x00050051, 0x00000002, 0x0000005C, 0x00000054, 0x00000001,
+    0x00040070, 0x00000003, 0x0000005D, 0x0000005B,
+    0x00040070, 0x00000003, 0x0000005E, 0x0000005C,
+    0x00050081, 0x00000003, 0x0000005F, 0x0000005D, 0x00000013,
+    0x00050088, 0x00000003, 0x00000060, 0x0000005F, 0x0000005E,
+    0x00050051, 0x00000002, 0x00000061, 0x00000053, 0x00000002,
+    0x00050051, 0x00000002, 0x00000062, 0x00000054, 0x00000002,
+    0x00040070, 0x00000003, 0x00000063, 0x00000061,
+    0x00040070, 0x00000003, 0x00000064, 0x00000062,
+    0x00050081, 0x00000003, 0x00000065, 0x00000063, 0x00000013,
+    0x00050088, 0x00000003, 0x00000066, 0x00000065, 0x00000064,
+    0x00070050, 0x00000005, 0x00000067, 0x0000005A, 0x00000060, 0x00000066, 0x00000014,
+    0x00050084, 0x00000002, 0x00000068, 0x00000061, 0x0000005C,
+    0x00050080, 0x00000002, 0x00000069, 0x00000068, 0x0000005B,
+    0x00050084, 0x00000002, 0x0000006A, 0x00000069, 0x00000056,
+    0x00050080, 0x00000002, 0x0000006B, 0x0000006A, 0x00000055,
+    0x00050056, 0x0000000F, 0x0000006C, 0x0000004F, 0x00000050,
+    0x00070058, 0x00000005, 0x0000006D, 0x0000006C, 0x00000067, 0x00000002, 0x00000014,
+    0x00050051, 0x00000003, 0x0000006E, 0x0000006D, 0x00000000,
+    0x00050051, 0x00000003, 0x0000006F, 0x0000006D, 0x00000001,
+    0x00050051, 0x00000003, 0x00000070, 0x0000006D, 0x00000002,
+    0x00050051, 0x00000003, 0x00000071, 0x0000006D, 0x00000003,
+    0x00050081, 0x00000003, 0x00000072, 0x0000006E, 0x0000006F,
+    0x00050081, 0x00000003, 0x00000073, 0x00000070, 0x00000071,
+    0x00050081, 0x00000003, 0x00000074, 0x00000072, 0x00000073,
+    0x00050046, 0x00000008, 0x00000075, 0x00000051, 0x0000006B,
+    0x0005003E, 0x00000075, 0x00000074, 0x00000002, 0x00000004,
+    0x000100FD,
+    0x00010038,
+};
+
+static const char* sampleNames[] = { "sample1d", "sample2d", "sample3d" };
+
+static const char* defaultSpecs[] = {
+    "8:UNORM:2D",
+    "8_8_8_8:UNORM:2D",
+    "16_16_16_16:FLOAT:2D",
+    "32:FLOAT:2D",
+    "32_32_32_32:FLOAT:2D",
+    "8_8_8_8:UNORM:3D",
+    "32_32_32_32:FLOAT:3D",
+};
+
+struct FormatSpec {
+    std::string                 spec;
+    ze_image_format_layout_t    layout;
+    ze_image_format_type_t      type;
+    ze_image_type_t             imageType;
+};
+
+// Parses "layout:type:imagetype", e.g. "8_8_8_8:UNORM:2D".
+static bool ParseSpec(
+    const std::string& spec,
+    FormatSpec& format )
+{
+    const size_t first = spec.find(':');
+    const size_t second = first == std::string::npos ?
+        std::string::npos :
+        spec.find(':', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+
+    const char* s = spec.c_str();
+    format.spec = spec;
+    format.layout = to_layout(s, first);
+    format.type = to_format_type(s + first + 1, second - first - 1);
+    format.imageType = to_image_type(s + second + 1, spec.size() - second - 1);
+
+    return format.layout != static_cast<ze_image_format_layout_t>(-1) &&
+        format.type != static_cast<ze_image_format_type_t>(-1) &&
+        format.imageType != static_cast<ze_image_type_t>(-1);
+}
+
+// Returns the number of channels and the bytes per pixel for the layouts
+// this benchmark supports, or zero channels for packed YUV and other
+// layouts.
+static uint32_t GetPixelInfo(
+    ze_image_format_layout_t layout,
+    uint32_t& bytesPerPixel )
+{
+    switch (layout) {
+    case ZE_IMAGE_FORMAT_LAYOUT_8:              bytesPerPixel = 1;  return 1;
+    case ZE_IMAGE_FORMAT_LAYOUT_16:             bytesPerPixel = 2;  return 1;
+    case ZE_IMAGE_FORMAT_LAYOUT_32:             bytesPerPixel = 4;  return 1;
+    case ZE_IMAGE_FORMAT_LAYOUT_8_8:            bytesPerPixel = 2;  return 2;
+    case ZE_IMAGE_FORMAT_LAYOUT_16_16:          bytesPerPixel = 4;  return 2;
+    case ZE_IMAGE_FORMAT_LAYOUT_32_32:          bytesPerPixel = 8;  return 2;
+    case ZE_IMAGE_FORMAT_LAYOUT_5_6_5:          bytesPerPixel = 2;  return 3;
+    case ZE_IMAGE_FORMAT_LAYOUT_11_11_10:       bytesPerPixel = 4;  return 3;
+    case ZE_IMAGE_FORMAT_LAYOUT_8_8_8_8:        bytesPerPixel = 4;  return 4;
+    case ZE_IMAGE_FORMAT_LAYOUT_16_16_16_16:    bytesPerPixel = 8;  return 4;
+    case ZE_IMAGE_FORMAT_LAYOUT_32_32_32_32:    bytesPerPixel = 16; return 4;
+    case ZE_IMAGE_FORMAT_LAYOUT_10_10_10_2:     bytesPerPixel = 4;  return 4;
+    case ZE_IMAGE_FORMAT_LAYOUT_5_5_5_1:        bytesPerPixel = 2;  return 4;
+    case ZE_IMAGE_FORMAT_LAYOUT_4_4_4_4:        bytesPerPixel = 2;  return 4;
+    default:                                    bytesPerPixel = 0;  return 0;
+    }
+}
+
+// Runs the commands appended by append() once untimed and then iterations
+// times, and returns the minimum device time in nanoseconds.
+template<typename F>
+static double TimeCommand(
+    ze_command_queue_handle_t queue,
+    ze_command_list_handle_t cmdList,
+    lzutil::TimestampProfiler& profiler,
+    int iterations,
+    F&& append )
+{
+    CHECK_CALL( zeCommandListReset(cmdList) );
+    append(nullptr);
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+        append(profiler.signal("op"));
+    }
+    CHECK_CALL( zeCommandListClose(cmdList) );
+    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+    profiler.clear();
+    profiler.collect();
+
+    auto summary = profiler.summarize();
+    auto it = summary.find("op");
+    return it == summary.end() ? 0.0 : it->second.minNs;
+}
+
+static void PrintRate(
+    double units,
+    double ns )
+{
+    if (ns > 0.0) {
+        printf(" %14.2f", units / ns);
+    } else {
+        printf(" %14s", "-");
+    }
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    uint32_t size = 2048;
+    uint32_t size3D = 256;
+    int iterations = 8;
+    bool nearest = false;
+    std::vector<std::string> specs;
+
+    {
+        popl::OptionParser op("Supported Options");
+        auto formatOption = op.add<popl::Value<std::string>>("f", "format", "Format Spec layout:type:imagetype (repeatable)");
+        op.add<popl::Value<uint32_t>>("s", "size", "Image Width and Height (1D and 2D)", size, &size);
+        op.add<popl::Value<uint32_t>>("", "size3d", "Image Width, Height and Depth (3D)", size3D, &size3D);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations", iterations, &iterations);
+        op.add<popl::Switch>("", "nearest", "Sample with Nearest Filtering", &nearest);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        for (size_t f = 0; f < formatOption->count(); f++) {
+            specs.push_back(formatOption->value(f));
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            size == 0 || size3D == 0 || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: imagebench [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    if (specs.empty()) {
+        specs.assign(defaultSpecs, defaultSpecs + sizeof(defaultSpecs) / sizeof(defaultSpecs[0]));
+    }
+
+    std::vector<FormatSpec> formats;
+    for (auto& spec : specs) {
+        FormatSpec format;
+        if (!ParseSpec(spec, format)) {
+            printf("\nInvalid format spec %s, expected layout:type:imagetype!\n",
+                spec.c_str());
+            return -1;
+        }
+        formats.push_back(format);
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            ze_device_image_properties_t imageProps = {};
+            imageProps.stype = ZE_STRUCTURE_TYPE_DEVICE_IMAGE_PROPERTIES;
+            zeDeviceGetImageProperties(device, &imageProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+            printf("\tmax image dims: 1D %u, 2D %u, 3D %u\n",
+                imageProps.maxImageDims1D, imageProps.maxImageDims2D, imageProps.maxImageDims3D);
+
+            if (imageProps.maxImageDims2D == 0) {
+                printf("\tImages are not supported.\n");
+                continue;
+            }
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(sampleSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(sampleSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_handle_t kernels[3] = {};
+            for (int k = 0; k < 3; k++) {
+                ze_kernel_desc_t kernelDesc = {};
+                kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+                kernelDesc.pKernelName = sampleNames[k];
+                CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernels[k]) );
+            }
+
+            ze_sampler_handle_t samplers[2] = {};
+            for (int s = 0; s < 2; s++) {
+                ze_sampler_desc_t samplerDesc = {};
+                samplerDesc.stype = ZE_STRUCTURE_TYPE_SAMPLER_DESC;
+                samplerDesc.addressMode = ZE_SAMPLER_ADDRESS_MODE_CLAMP;
+                samplerDesc.filterMode = s == 0 ?
+                    ZE_SAMPLER_FILTER_MODE_NEAREST :
+                    ZE_SAMPLER_FILTER_MODE_LINEAR;
+                samplerDesc.isNormalized = true;
+                CHECK_CALL( zeSamplerCreate(context, device, &samplerDesc, &samplers[s]) );
+            }
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_queue_handle_t queue = nullptr;
+            CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &queue) );
+
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, &cmdList) );
+
+            lzutil::TimestampProfiler profiler(context, device);
+
+            printf("\t%-24s %-20s %8s %14s %14s %14s %14s %8s\n",
+                "format", "dimensions", "MB",
+                "copy GB/s", "to buf GB/s", "from buf GB/s", "sample GT/s", "filter");
+
+            for (auto& format : formats) {
+                printf("\t%-24s", format.spec.c_str());
+
+                uint32_t bytesPerPixel = 0;
+                const uint32_t channels = GetPixelInfo(format.layout, bytesPerPixel);
+
+                ze_image_desc_t imageDesc = {};
+                imageDesc.stype = ZE_STRUCTURE_TYPE_IMAGE_DESC;
+                imageDesc.type = format.imageType;
+                imageDesc.format.layout = format.layout;
+                imageDesc.format.type = format.type;
+                imageDesc.format.x = ZE_IMAGE_FORMAT_SWIZZLE_R;
+                imageDesc.format.y = channels >= 2 ? ZE_IMAGE_FORMAT_SWIZZLE_G : ZE_IMAGE_FORMAT_SWIZZLE_0;
+                imageDesc.format.z = channels >= 3 ? ZE_IMAGE_FORMAT_SWIZZLE_B : ZE_IMAGE_FORMAT_SWIZZLE_0;
+                imageDesc.format.w = channels >= 4 ? ZE_IMAGE_FORMAT_SWIZZLE_A : ZE_IMAGE_FORMAT_SWIZZLE_1;
+                imageDesc.height = 1;
+                imageDesc.depth = 1;
+
+                int dims = 0;
+                switch (format.imageType) {
+                case ZE_IMAGE_TYPE_1D:
+                    dims = 1;
+                    imageDesc.width = std::min<uint64_t>((uint64_t)size * size, imageProps.maxImageDims1D);
+                    break;
+                case ZE_IMAGE_TYPE_2D:
+                    dims = 2;
+                    imageDesc.width = std::min(size, imageProps.maxImageDims2D);
+                    imageDesc.height = std::min(size, imageProps.maxImageDims2D);
+                    break;
+                case ZE_IMAGE_TYPE_3D:
+                    dims = 3;
+                    imageDesc.width = std::min(size3D, imageProps.maxImageDims3D);
+                    imageDesc.height = std::min(size3D, imageProps.maxImageDims3D);
+                    imageDesc.depth = std::min(size3D, imageProps.maxImageDims3D);
+                    break;
+                default:
+                    break;
+                }
+
+                if (channels == 0 || dims == 0) {
+                    printf(" unsupported by this benchmark\n");
+                    continue;
+                }
+
+                char dimensions[64];
+                snprintf(dimensions, sizeof(dimensions), "%llux%ux%u",
+                    (unsigned long long)imageDesc.width, imageDesc.height, imageDesc.depth);
+                printf(" %-20s", dimensions);
+
+                const uint64_t pixels = imageDesc.width * imageDesc.height * imageDesc.depth;
+                const uint64_t imageBytes = pixels * bytesPerPixel;
+                printf(" %8.1f", imageBytes / (1024.0 * 1024.0));
+
+                ze_image_handle_t src = nullptr;
+                ze_image_handle_t dst = nullptr;
+                zeImageCreate(context, device, &imageDesc, &src);
+                zeImageCreate(context, device, &imageDesc, &dst);
+
+                ze_device_mem_alloc_desc_t deviceDesc = {};
+                deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+                void* buf = nullptr;
+                void* out = nullptr;
+                zeMemAllocDevice(context, &deviceDesc, imageBytes, 0, device, &buf);
+                zeMemAllocDevice(context, &deviceDesc, pixels * sizeof(float), 0, device, &out);
+
+                if (src == nullptr || dst == nullptr || buf == nullptr || out == nullptr) {
+                    printf(" not supported\n");
+                } else {
+                    // Initialize the source image.
+                    const uint8_t zero = 0;
+                    CHECK_CALL( zeCommandListReset(cmdList) );
+                    CHECK_CALL( zeCommandListAppendMemoryFill(cmdList, buf, &zero, sizeof(zero), imageBytes, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendBarrier(cmdList, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListAppendImageCopyFromMemory(cmdList, src, buf, nullptr, nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListClose(cmdList) );
+                    CHECK_CALL( zeCommandQueueExecuteCommandLists(queue, 1, &cmdList, nullptr) );
+                    CHECK_CALL( zeCommandQueueSynchronize(queue, UINT64_MAX) );
+
+                    const double copyNs = TimeCommand(queue, cmdList, profiler, iterations,
+                        [&](ze_event_handle_t event) {
+                            CHECK_CALL( zeCommandListAppendImageCopy(cmdList, dst, src, event, 0, nullptr) );
+                        });
+                    const double toBufferNs = TimeCommand(queue, cmdList, profiler, iterations,
+                        [&](ze_event_handle_t event) {
+                            CHECK_CALL( zeCommandListAppendImageCopyToMemory(cmdList, buf, src, nullptr, event, 0, nullptr) );
+                        });
+                    const double fromBufferNs = TimeCommand(queue, cmdList, profiler, iterations,
+                        [&](ze_event_handle_t event) {
+                            CHECK_CALL( zeCommandListAppendImageCopyFromMemory(cmdList, dst, buf, nullptr, event, 0, nullptr) );
+                        });
+
+                    // Copies read and write the image, so count both.
+                    PrintRate(2.0 * imageBytes, copyNs);
+                    PrintRate(2.0 * imageBytes, toBufferNs);
+                    PrintRate(2.0 * imageBytes, fromBufferNs);
+
+                    // read_imagef is only defined for normalized and float
+                    // formats.
+                    const bool sampled =
+                        format.type == ZE_IMAGE_FORMAT_TYPE_UNORM ||
+                        format.type == ZE_IMAGE_FORMAT_TYPE_SNORM ||
+                        format.type == ZE_IMAGE_FORMAT_TYPE_FLOAT;
+
+                    ze_image_properties_t formatProps = {};
+                    formatProps.stype = ZE_STRUCTURE_TYPE_IMAGE_PROPERTIES;
+                    zeImageGetProperties(device, &imageDesc, &formatProps);
+
+                    const bool linear = !nearest &&
+                        (formatProps.samplerFilterFlags & ZE_IMAGE_SAMPLER_FILTER_FLAG_LINEAR) != 0;
+
+                    ze_kernel_handle_t kernel = kernels[dims - 1];
+                    if (sampled && kernel != nullptr) {
+                        const uint32_t globalSize[3] = {
+                            (uint32_t)imageDesc.width, imageDesc.height, imageDesc.depth };
+
+                        uint32_t groupSize[3] = { 1, 1, 1 };
+                        CHECK_CALL( zeKernelSuggestGroupSize(kernel, globalSize[0], globalSize[1], globalSize[2],
+                            &groupSize[0], &groupSize[1], &groupSize[2]) );
+                        CHECK_CALL( zeKernelSetGroupSize(kernel, groupSize[0], groupSize[1], groupSize[2]) );
+                        CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(src), &src) );
+                        CHECK_CALL( zeKernelSetArgumentValue(kernel, 1, sizeof(ze_sampler_handle_t), &samplers[linear ? 1 : 0]) );
+                        CHECK_CALL( zeKernelSetArgumentValue(kernel, 2, sizeof(out), &out) );
+
+                        ze_group_count_t groupCount = {
+                            globalSize[0] / groupSize[0],
+                            globalSize[1] / groupSize[1],
+                            globalSize[2] / groupSize[2] };
+                        const double texels = (double)groupCount.groupCountX * groupSize[0] *
+                            groupCount.groupCountY * groupSize[1] *
+                            groupCount.groupCountZ * groupSize[2];
+
+                        const double sampleNs = TimeCommand(queue, cmdList, profiler, iterations,
+                            [&](ze_event_handle_t event) {
+                                CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, event, 0, nullptr) );
+                            });
+                        PrintRate(texels, sampleNs);
+                        printf(" %8s\n", linear ? "linear" : "nearest");
+                    } else {
+                        printf(" %14s %8s\n", "-", "-");
+                    }
+                }
+
+                if (out) CHECK_CALL( zeMemFree(context, out) );
+                if (buf) CHECK_CALL( zeMemFree(context, buf) );
+                if (dst) CHECK_CALL( zeImageDestroy(dst) );
+                if (src) CHECK_CALL( zeImageDestroy(src) );
+            }
+
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+            CHECK_CALL( zeCommandQueueDestroy(queue) );
+            for (auto sampler : samplers) {
+                CHECK_CALL( zeSamplerDestroy(sampler) );
+            }
+            for (auto kernel : kernels) {
+                CHECK_CALL( zeKernelDestroy(kernel) );
+            }
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,455 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <popl/popl.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+enum WaitMethod {
+    WAIT_QUEUE_SYNCHRONIZE,
+    WAIT_FENCE_HOST_SYNCHRONIZE,
+    WAIT_EVENT_HOST_SYNCHRONIZE,
+    WAIT_EVENT_QUERY_STATUS,
+};
+
+static const char* methodNames[] = {
+    "zeCommandQueueSynchronize",
+    "zeFenceHostSynchronize",
+    "zeEventHostSynchronize",
+    "zeEventQueryStatus poll",
+};
+
+// Each worker thread has its own queue, so waits on different threads are
+// independent.
+struct Worker {
+    ze_command_queue_handle_t   queue;
+    ze_command_list_handle_t    cmdList;        // does not signal an event
+    ze_command_list_handle_t    cmdListEvent;   // signals event
+    ze_fence_handle_t           fence;
+    ze_event_handle_t           event;
+    void*                       buf;
+
+    std::vector<double>         latencies;      // microseconds
+    double                      wallUs;         // around the CPU time reads
+    double                      cpuUs;
+};
+
+// Returns the CPU time consumed by the calling thread, in microseconds.
+static double ThreadCpuMicroseconds()
+{
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernelTime.dwLowDateTime;
+    k.HighPart = kernelTime.dwHighDateTime;
+    u.LowPart = userTime.dwLowDateTime;
+    u.HighPart = userTime.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10.0;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#endif
+}
+
+static double ElapsedMicroseconds(
+    clk::time_point start,
+    clk::time_point end )
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// Submits the workload and waits for it using the given method.  Finite
+// timeouts are retried until the wait succeeds, the way a caller that wakes
+// up periodically to do other work would.
+static void SubmitAndWait(
+    Worker& w,
+    WaitMethod method,
+    uint64_t timeout )
+{
+    switch (method) {
+    case WAIT_QUEUE_SYNCHRONIZE:
+        CHECK_CALL( zeCommandQueueExecuteCommandLists(w.queue, 1, &w.cmdList, nullptr) );
+        while (zeCommandQueueSynchronize(w.queue, timeout) == ZE_RESULT_NOT_READY) {
+        }
+        break;
+    case WAIT_FENCE_HOST_SYNCHRONIZE:
+        CHECK_CALL( zeCommandQueueExecuteCommandLists(w.queue, 1, &w.cmdList, w.fence) );
+        while (zeFenceHostSynchronize(w.fence, timeout) == ZE_RESULT_NOT_READY) {
+        }
+        break;
+    case WAIT_EVENT_HOST_SYNCHRONIZE:
+        CHECK_CALL( zeCommandQueueExecuteCommandLists(w.queue, 1, &w.cmdListEvent, nullptr) );
+        while (zeEventHostSynchronize(w.event, timeout) == ZE_RESULT_NOT_READY) {
+        }
+        break;
+    case WAIT_EVENT_QUERY_STATUS:
+        CHECK_CALL( zeCommandQueueExecuteCommandLists(w.queue, 1, &w.cmdListEvent, nullptr) );
+        while (zeEventQueryStatus(w.event) == ZE_RESULT_NOT_READY) {
+        }
+        break;
+    }
+}
+
+// Resets the synchronization object for the next iteration.  This is not
+// part of the measured latency.
+static void Reset(
+    Worker& w,
+    WaitMethod method )
+{
+    switch (method) {
+    case WAIT_FENCE_HOST_SYNCHRONIZE:
+        CHECK_CALL( zeFenceReset(w.fence) );
+        break;
+    case WAIT_EVENT_HOST_SYNCHRONIZE:
+    case WAIT_EVENT_QUERY_STATUS:
+        // The queue must be idle before the event is reused.
+        CHECK_CALL( zeCommandQueueSynchronize(w.queue, UINT64_MAX) );
+        CHECK_CALL( zeEventHostReset(w.event) );
+        break;
+    default:
+        break;
+    }
+}
+
+static void RunWorker(
+    Worker& w,
+    WaitMethod method,
+    uint64_t timeout,
+    int iterations,
+    const std::atomic<bool>& go )
+{
+    // warmup
+    SubmitAndWait(w, method, timeout);
+    Reset(w, method);
+
+    while (!go.load()) {
+        std::this_thread::yield();
+    }
+
+    w.latencies.clear();
+    w.wallUs = 0.0;
+    w.cpuUs = 0.0;
+    for (int i = 0; i < iterations; i++) {
+        // The thread CPU clock is comparatively slow to read, so it gets
+        // its own wall clock window and the latency window excludes it.
+        auto cpuWindowStart = clk::now();
+        const double cpuStart = ThreadCpuMicroseconds();
+        auto start = clk::now();
+        SubmitAndWait(w, method, timeout);
+        auto end = clk::now();
+        const double cpuEnd = ThreadCpuMicroseconds();
+        auto cpuWindowEnd = clk::now();
+
+        w.latencies.push_back(ElapsedMicroseconds(start, end));
+        w.wallUs += ElapsedMicroseconds(cpuWindowStart, cpuWindowEnd);
+        w.cpuUs += cpuEnd - cpuStart;
+
+        Reset(w, method);
+    }
+}
+
+static std::string TimeoutToString(
+    uint64_t timeout )
+{
+    return timeout == UINT64_MAX ? "infinite" : std::to_string(timeout) + " ns";
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 1000;
+    size_t size = 4 * 1024 * 1024;
+    std::vector<int> threadCounts;
+    std::vector<uint64_t> timeouts;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Thread", iterations, &iterations);
+        op.add<popl::Value<size_t>>("s", "size", "Memory Fill Size per Submission (bytes)", size, &size);
+        auto threadsOption = op.add<popl::Value<int>>("t", "threads", "Thread Count (repeatable, default 1, 2, 4)");
+        auto timeoutOption = op.add<popl::Value<std::string>>("", "timeout", "Wait Timeout in ns or \"max\" (repeatable, default max, 0, 10000)");
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        for (size_t t = 0; t < threadsOption->count(); t++) {
+            threadCounts.push_back(threadsOption->value(t));
+            printUsage = printUsage || threadCounts.back() <= 0;
+        }
+        for (size_t t = 0; t < timeoutOption->count(); t++) {
+            const std::string value = timeoutOption->value(t);
+            timeouts.push_back(value == "max" ?
+                UINT64_MAX :
+                strtoull(value.c_str(), nullptr, 0));
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0) {
+            fprintf(stderr,
+                "Usage: syncbench [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    if (threadCounts.empty()) {
+        threadCounts = { 1, 2, 4 };
+    }
+    if (timeouts.empty()) {
+        timeouts = { UINT64_MAX, 0, 10000 };
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+
+            ze_group_count_t groupCount = { 1, 1, 1 };
+
+            const int maxThreads = *std::max_element(threadCounts.begin(), threadCounts.end());
+
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = maxThreads;
+
+            ze_event_pool_handle_t eventPool = nullptr;
+            CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &eventPool) );
+
+            // The workload is an optional memory fill followed by an empty
+            // kernel, so the waits block for a realistic amount of time.
+            std::vector<Worker> workers(maxThreads);
+            for (int t = 0; t < maxThreads; t++) {
+                Worker& w = workers[t];
+
+                ze_command_queue_desc_t queueDesc = {};
+                queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+                queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+                w.queue = nullptr;
+                CHECK_CALL( zeCommandQueueCreate(context, device, &queueDesc, &w.queue) );
+
+                ze_fence_desc_t fenceDesc = {};
+                fenceDesc.stype = ZE_STRUCTURE_TYPE_FENCE_DESC;
+
+                w.fence = nullptr;
+                CHECK_CALL( zeFenceCreate(w.queue, &fenceDesc, &w.fence) );
+
+                ze_event_desc_t eventDesc = {};
+                eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+                eventDesc.index = t;
+                eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+                eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+                w.event = nullptr;
+                CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &w.event) );
+
+                ze_device_mem_alloc_desc_t deviceDesc = {};
+                deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+                w.buf = nullptr;
+                if (size != 0) {
+                    CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &w.buf) );
+                }
+
+                ze_command_list_desc_t cmdListDesc = {};
+                cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+                ze_command_list_handle_t* cmdLists[] = { &w.cmdList, &w.cmdListEvent };
+                for (auto cmdList : cmdLists) {
+                    *cmdList = nullptr;
+                    CHECK_CALL( zeCommandListCreate(context, device, &cmdListDesc, cmdList) );
+                    if (w.buf != nullptr) {
+                        const uint8_t pattern = 0;
+                        CHECK_CALL( zeCommandListAppendMemoryFill(*cmdList, w.buf, &pattern, sizeof(pattern), size, nullptr, 0, nullptr) );
+                        CHECK_CALL( zeCommandListAppendBarrier(*cmdList, nullptr, 0, nullptr) );
+                    }
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(*cmdList, kernel, &groupCount,
+                        cmdList == &w.cmdListEvent ? w.event : nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListClose(*cmdList) );
+                }
+            }
+
+            printf("\tLatency is from submission to wait return.  CPU is the waiting thread's\n");
+            printf("\tCPU time per iteration, including submission.\n");
+            printf("\t%-28s %10s %8s %12s %12s %12s %12s %8s\n",
+                "method", "timeout", "threads",
+                "median us", "p99 us", "max us", "CPU us", "CPU %");
+
+            for (int m = WAIT_QUEUE_SYNCHRONIZE; m <= WAIT_EVENT_QUERY_STATUS; m++) {
+                const WaitMethod method = static_cast<WaitMethod>(m);
+
+                // Polling has no timeout.
+                const std::vector<uint64_t> methodTimeouts = method == WAIT_EVENT_QUERY_STATUS ?
+                    std::vector<uint64_t>(1, 0) :
+                    timeouts;
+
+                for (auto timeout : methodTimeouts) {
+                    for (auto threadCount : threadCounts) {
+                        std::atomic<bool> go(false);
+                        std::vector<std::thread> threads;
+                        for (int t = 0; t < threadCount; t++) {
+                            threads.emplace_back(RunWorker, std::ref(workers[t]),
+                                method, timeout, iterations, std::cref(go));
+                        }
+                        go.store(true);
+                        for (auto& thread : threads) {
+                            thread.join();
+                        }
+
+                        std::vector<double> latencies;
+                        double wallUs = 0.0;
+                        double cpuUs = 0.0;
+                        for (int t = 0; t < threadCount; t++) {
+                            latencies.insert(latencies.end(),
+                                workers[t].latencies.begin(), workers[t].latencies.end());
+                            wallUs += workers[t].wallUs;
+                            cpuUs += workers[t].cpuUs;
+                        }
+                        std::sort(latencies.begin(), latencies.end());
+
+                        const size_t count = latencies.size();
+                        printf("\t%-28s %10s %8d %12.2f %12.2f %12.2f %12.2f %8.1f\n",
+                            methodNames[m],
+                            method == WAIT_EVENT_QUERY_STATUS ? "-" : TimeoutToString(timeout).c_str(),
+                            threadCount,
+                            latencies[count / 2],
+                            latencies[std::min(count - 1, count * 99 / 100)],
+                            latencies.back(),
+                            cpuUs / count,
+                            wallUs > 0.0 ? 100.0 * cpuUs / wallUs : 0.0);
+                    }
+                }
+            }
+
+            for (auto& w : workers) {
+                CHECK_CALL( zeCommandListDestroy(w.cmdListEvent) );
+                CHECK_CALL( zeCommandListDestroy(w.cmdList) );
+                if (w.buf) CHECK_CALL( zeMemFree(context, w.buf) );
+                CHECK_CALL( zeEventDestroy(w.event) );
+                CHECK_CALL( zeFenceDestroy(w.fence) );
+                CHECK_CALL( zeCommandQueueDestroy(w.queue) );
+            }
+            CHECK_CALL( zeEventPoolDestroy(eventPool) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,394 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <popl/popl.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+#include "lzutil/event_waiter.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+enum WaitMode {
+    MODE_BLOCKING_THREADS,
+    MODE_HYBRID_THREADS,
+    MODE_SHARED_WAITER,
+};
+
+static const char* modeNames[] = {
+    "thread/stream, block",
+    "thread/stream, hybrid",
+    "one shared waiter",
+};
+
+// A request stream: an immediate command list that runs an optional memory
+// fill and then an empty kernel that signals the stream's event.
+struct Stream {
+    ze_command_list_handle_t    cmdList;
+    ze_event_handle_t           event;
+    void*                       buf;
+
+    clk::time_point             submitTime;
+    int                         remaining;
+    std::vector<double>         latencies;  // microseconds
+};
+
+// Returns the CPU time consumed by the whole process, in microseconds.
+static double ProcessCpuMicroseconds()
+{
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernelTime.dwLowDateTime;
+    k.HighPart = kernelTime.dwHighDateTime;
+    u.LowPart = userTime.dwLowDateTime;
+    u.HighPart = userTime.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10.0;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#endif
+}
+
+static double ElapsedMicroseconds(
+    clk::time_point start,
+    clk::time_point end )
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static void Submit(
+    Stream& s,
+    ze_kernel_handle_t kernel,
+    size_t size )
+{
+    ze_group_count_t groupCount = { 1, 1, 1 };
+
+    s.submitTime = clk::now();
+    if (s.buf != nullptr) {
+        const uint8_t pattern = 0;
+        CHECK_CALL( zeCommandListAppendMemoryFill(s.cmdList, s.buf, &pattern, sizeof(pattern), size, nullptr, 0, nullptr) );
+        CHECK_CALL( zeCommandListAppendBarrier(s.cmdList, nullptr, 0, nullptr) );
+    }
+    CHECK_CALL( zeCommandListAppendLaunchKernel(s.cmdList, kernel, &groupCount, s.event, 0, nullptr) );
+}
+
+static void Complete(
+    Stream& s )
+{
+    s.latencies.push_back(ElapsedMicroseconds(s.submitTime, clk::now()));
+    s.remaining--;
+    CHECK_CALL( zeEventHostReset(s.event) );
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 500;
+    size_t size = 4 * 1024 * 1024;
+    std::vector<int> streamCounts;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Stream", iterations, &iterations);
+        op.add<popl::Value<size_t>>("s", "size", "Memory Fill Size per Submission (bytes)", size, &size);
+        auto streamsOption = op.add<popl::Value<int>>("n", "streams", "Stream Count (repeatable, default 1, 4, 16)");
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        for (size_t n = 0; n < streamsOption->count(); n++) {
+            streamCounts.push_back(streamsOption->value(n));
+            printUsage = printUsage || streamCounts.back() <= 0;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0) {
+            fprintf(stderr,
+                "Usage: hybridwait [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    if (streamCounts.empty()) {
+        streamCounts = { 1, 4, 16 };
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+
+            const int maxStreams = *std::max_element(streamCounts.begin(), streamCounts.end());
+
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = maxStreams;
+
+            ze_event_pool_handle_t eventPool = nullptr;
+            CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &eventPool) );
+
+            std::vector<Stream> streams(maxStreams);
+            for (int s = 0; s < maxStreams; s++) {
+                ze_command_queue_desc_t queueDesc = {};
+                queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+                queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+                streams[s].cmdList = nullptr;
+                CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &streams[s].cmdList) );
+
+                ze_event_desc_t eventDesc = {};
+                eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+                eventDesc.index = s;
+                eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+                eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+                streams[s].event = nullptr;
+                CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &streams[s].event) );
+
+                ze_device_mem_alloc_desc_t deviceDesc = {};
+                deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+                streams[s].buf = nullptr;
+                if (size != 0) {
+                    CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &streams[s].buf) );
+                }
+            }
+
+            printf("\tLatency is from submission to completion.  CPU is process CPU time\n");
+            printf("\tdivided by wall time, in cores.\n");
+            printf("\t%-24s %8s %12s %12s %12s %8s %10s %10s\n",
+                "mode", "streams", "median us", "p99 us", "max us", "cores",
+                "spin hits", "spin us");
+
+            for (int m = MODE_BLOCKING_THREADS; m <= MODE_SHARED_WAITER; m++) {
+                for (auto streamCount : streamCounts) {
+                    // The shared waiter's state is declared before the waiter,
+                    // so it outlives the waiter thread and its last callback.
+                    std::mutex mutex;
+                    std::condition_variable cv;
+                    int active = streamCount;
+                    std::function<void(Stream&, ze_result_t)> onComplete;
+
+                    lzutil::EventWaiter waiter;
+
+                    // warmup
+                    for (int s = 0; s < streamCount; s++) {
+                        Submit(streams[s], kernel, size);
+                        CHECK_CALL( zeEventHostSynchronize(streams[s].event, UINT64_MAX) );
+                        CHECK_CALL( zeEventHostReset(streams[s].event) );
+                        streams[s].latencies.clear();
+                        streams[s].remaining = iterations;
+                    }
+
+                    const double cpuStart = ProcessCpuMicroseconds();
+                    auto start = clk::now();
+
+                    if (m == MODE_SHARED_WAITER) {
+                        // Each completion resubmits its stream from the
+                        // waiter thread until the stream is done.  A failed
+                        // wait ends the stream.
+                        onComplete = [&](Stream& s, ze_result_t r) {
+                            if (r != ZE_RESULT_SUCCESS) {
+                                printf("EventWaiter callback returned %u!\n", r);
+                                s.remaining = 0;
+                            } else {
+                                Complete(s);
+                            }
+                            if (s.remaining > 0) {
+                                Submit(s, kernel, size);
+                                waiter.notify(s.event, [&](ze_result_t r) { onComplete(s, r); });
+                            } else {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                if (--active == 0) {
+                                    cv.notify_one();
+                                }
+                            }
+                        };
+
+                        for (int s = 0; s < streamCount; s++) {
+                            Stream& stream = streams[s];
+                            Submit(stream, kernel, size);
+                            waiter.notify(stream.event, [&](ze_result_t r) { onComplete(stream, r); });
+                        }
+
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv.wait(lock, [&] { return active == 0; });
+                    } else {
+                        std::vector<std::thread> threads;
+                        for (int s = 0; s < streamCount; s++) {
+                            threads.emplace_back([&, s]() {
+                                Stream& stream = streams[s];
+                                while (stream.remaining > 0) {
+                                    Submit(stream, kernel, size);
+                                    if (m == MODE_HYBRID_THREADS) {
+                                        CHECK_CALL( waiter.wait(stream.event) );
+                                    } else {
+                                        CHECK_CALL( zeEventHostSynchronize(stream.event, UINT64_MAX) );
+                                    }
+                                    Complete(stream);
+                                }
+                            });
+                        }
+                        for (auto& thread : threads) {
+                            thread.join();
+                        }
+                    }
+
+                    auto end = clk::now();
+                    const double cpuUs = ProcessCpuMicroseconds() - cpuStart;
+                    const double wallUs = ElapsedMicroseconds(start, end);
+
+                    std::vector<double> latencies;
+                    for (int s = 0; s < streamCount; s++) {
+                        latencies.insert(latencies.end(),
+                            streams[s].latencies.begin(), streams[s].latencies.end());
+                    }
+                    std::sort(latencies.begin(), latencies.end());
+
+                    const size_t count = latencies.size();
+                    printf("\t%-24s %8d %12.2f %12.2f %12.2f %8.2f",
+                        modeNames[m],
+                        streamCount,
+                        latencies[count / 2],
+                        latencies[std::min(count - 1, count * 99 / 100)],
+                        latencies.back(),
+                        wallUs > 0.0 ? cpuUs / wallUs : 0.0);
+                    if (m == MODE_BLOCKING_THREADS) {
+                        printf(" %10s %10s\n", "-", "-");
+                    } else {
+                        const uint64_t total = waiter.spinCompletions() + waiter.blockCompletions();
+                        printf(" %9.1f%% %10.2f\n",
+                            total ? 100.0 * waiter.spinCompletions() / total : 0.0,
+                            waiter.spinWindowNs() / 1e3);
+                    }
+                }
+            }
+
+            for (auto& s : streams) {
+                if (s.buf) CHECK_CALL( zeMemFree(context, s.buf) );
+                CHECK_CALL( zeEventDestroy(s.event) );
+                CHECK_CALL( zeCommandListDestroy(s.cmdList) );
+            }
+            CHECK_CALL( zeEventPoolDestroy(eventPool) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
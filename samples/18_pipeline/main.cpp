@@ -0,0 +1,349 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/pipeline_stages.hpp"
+#include "lzutil/process_kernel_spirv.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// The pipeline keeps depth chunk buffers on the device.  Chunk i uses slot
+// i % depth and flows through the upload, compute and download command
+// lists, ordered by the events described at lzutil::PipelineEvents.
+struct Pipeline {
+    ze_command_list_handle_t        upload;
+    ze_command_list_handle_t        compute;
+    ze_command_list_handle_t        download;
+
+    ze_kernel_handle_t              kernel;
+    uint32_t                        groupSizeX;
+
+    std::vector<void*>              slots;
+};
+
+// Processes chunks * chunkElements floats from src into dst using depth
+// slots.  With serialize set, the host waits for every step before issuing
+// the next one, like a simple upload / compute / download loop.  Returns the
+// elapsed time in milliseconds.
+static double RunPipeline(
+    Pipeline& p,
+    lzutil::PipelineEvents& events,
+    const float* src,
+    float* dst,
+    size_t chunks,
+    size_t chunkElements,
+    uint32_t depth,
+    uint32_t intensity,
+    bool serialize )
+{
+    const size_t chunkBytes = chunkElements * sizeof(float);
+    ze_group_count_t groupCount = { (uint32_t)(chunkElements / p.groupSizeX), 1, 1 };
+
+    auto start = clk::now();
+
+    for (size_t i = 0; i < chunks; i++) {
+        const uint32_t s = (uint32_t)(i % depth);
+        void* slot = p.slots[s];
+        ze_event_handle_t uploaded = events.uploaded(s);
+        ze_event_handle_t computed = events.computed(s);
+        ze_event_handle_t downloaded = events.downloaded(s);
+
+        // The slot is free once the chunk that last used it is downloaded.
+        if (i >= depth) {
+            CHECK_CALL( zeCommandListAppendMemoryCopy(p.upload, slot, src + i * chunkElements, chunkBytes,
+                nullptr, 1, &downloaded) );
+            CHECK_CALL( lzutil::PipelineEvents::consume(p.upload, downloaded, uploaded) );
+        } else {
+            CHECK_CALL( zeCommandListAppendMemoryCopy(p.upload, slot, src + i * chunkElements, chunkBytes,
+                uploaded, 0, nullptr) );
+        }
+        if (serialize) {
+            CHECK_CALL( zeEventHostSynchronize(uploaded, UINT64_MAX) );
+        }
+
+        CHECK_CALL( zeKernelSetArgumentValue(p.kernel, 0, sizeof(slot), &slot) );
+        CHECK_CALL( zeKernelSetArgumentValue(p.kernel, 1, sizeof(intensity), &intensity) );
+        CHECK_CALL( zeCommandListAppendLaunchKernel(p.compute, p.kernel, &groupCount,
+            nullptr, 1, &uploaded) );
+        CHECK_CALL( lzutil::PipelineEvents::consume(p.compute, uploaded, computed) );
+        if (serialize) {
+            CHECK_CALL( zeEventHostSynchronize(computed, UINT64_MAX) );
+        }
+
+        CHECK_CALL( zeCommandListAppendMemoryCopy(p.download, dst + i * chunkElements, slot, chunkBytes,
+            nullptr, 1, &computed) );
+        CHECK_CALL( lzutil::PipelineEvents::consume(p.download, computed, downloaded) );
+        if (serialize) {
+            CHECK_CALL( zeEventHostSynchronize(downloaded, UINT64_MAX) );
+        }
+    }
+
+    // Drain all three lists, including the trailing event resets.
+    CHECK_CALL( events.drain(p.upload, p.compute, p.download) );
+
+    auto end = clk::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    size_t totalSize = 256 * 1024 * 1024;
+    size_t chunkSize = 16 * 1024 * 1024;
+    uint32_t maxDepth = 3;
+    uint32_t intensity = 64;
+    int iterations = 3;
+    bool novalidate = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<size_t>>("s", "size", "Total Data Size (bytes)", totalSize, &totalSize);
+        op.add<popl::Value<size_t>>("c", "chunk", "Chunk Size (bytes)", chunkSize, &chunkSize);
+        op.add<popl::Value<uint32_t>>("d", "depth", "Maximum Pipeline Depth (device chunk buffers)", maxDepth, &maxDepth);
+        op.add<popl::Value<uint32_t>>("", "intensity", "FMAs per Element", intensity, &intensity);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Configuration", iterations, &iterations);
+        op.add<popl::Switch>("", "novalidate", "Skip Validation of the Results", &novalidate);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            chunkSize < sizeof(float) || totalSize < chunkSize || maxDepth == 0 || iterations <= 0) {
+            fprintf(stderr,
+                "Usage: pipeline [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+    bool failed = false;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            lzutil::PipelineQueues queues;
+            if (!queues.find(device)) {
+                printf("\tNo compute queue group, skipping device.\n");
+                continue;
+            }
+
+            printf("\tupload:         ordinal %u index %u\n", queues.copyOrdinal, queues.uploadIndex);
+            printf("\tcompute:        ordinal %u index %u\n", queues.computeOrdinal, 0);
+            printf("\tdownload:       ordinal %u index %u\n", queues.copyOrdinal, queues.downloadIndex);
+
+            Pipeline p = {};
+            CHECK_CALL( queues.createCommandLists(context, device, &p.upload, &p.compute, &p.download) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::processKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::processKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::processKernelName;
+
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &p.kernel) );
+
+            // Chunks are rounded down to whole work-groups.
+            const size_t chunks = totalSize / chunkSize;
+            size_t chunkElements = chunkSize / sizeof(float);
+
+            uint32_t groupSizeY = 1;
+            uint32_t groupSizeZ = 1;
+            p.groupSizeX = 1;
+            CHECK_CALL( zeKernelSuggestGroupSize(p.kernel, (uint32_t)chunkElements, 1, 1,
+                &p.groupSizeX, &groupSizeY, &groupSizeZ) );
+            CHECK_CALL( zeKernelSetGroupSize(p.kernel, p.groupSizeX, 1, 1) );
+            chunkElements = std::max<size_t>(chunkElements / p.groupSizeX, 1) * p.groupSizeX;
+
+            const size_t totalElements = chunks * chunkElements;
+            printf("\tdata:           %zu chunks of %zu bytes (%.1f MB), %u FMAs per element\n",
+                chunks, chunkElements * sizeof(float),
+                totalElements * sizeof(float) / (1024.0 * 1024.0), intensity);
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            void* src = nullptr;
+            void* dst = nullptr;
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, totalElements * sizeof(float), 0, &src) );
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, totalElements * sizeof(float), 0, &dst) );
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            p.slots.resize(maxDepth, nullptr);
+            bool allocated = src != nullptr && dst != nullptr;
+            for (auto& slot : p.slots) {
+                CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, chunkElements * sizeof(float), 0, device, &slot) );
+                allocated = allocated && slot != nullptr;
+            }
+
+            lzutil::PipelineEvents events(context, device, maxDepth);
+            allocated = allocated && events.valid();
+
+            if (!allocated) {
+                printf("\tAllocation failed, skipping device.\n");
+            } else {
+                float* hostSrc = static_cast<float*>(src);
+                float* hostDst = static_cast<float*>(dst);
+                for (size_t e = 0; e < totalElements; e++) {
+                    hostSrc[e] = (e % 1000) / 1000.0f;
+                }
+
+                printf("\t%-12s %6s %12s %12s %10s\n",
+                    "mode", "depth", "time (ms)", "GB/s", "speedup");
+
+                double serializedMs = 0.0;
+                for (uint32_t depth = 0; depth <= maxDepth; depth++) {
+                    // Depth zero is the serialized baseline, using one slot.
+                    const bool serialize = depth == 0;
+                    double bestMs = 0.0;
+                    for (int it = 0; it < iterations; it++) {
+                        const double ms = RunPipeline(p, events, hostSrc, hostDst, chunks, chunkElements,
+                            serialize ? 1 : depth, intensity, serialize);
+                        bestMs = (it == 0) ? ms : std::min(bestMs, ms);
+                    }
+                    if (serialize) {
+                        serializedMs = bestMs;
+                    }
+
+                    printf("\t%-12s %6u %12.2f %12.2f %9.2fx\n",
+                        serialize ? "serialized" : "pipelined",
+                        serialize ? 1 : depth,
+                        bestMs,
+                        totalElements * sizeof(float) / bestMs / 1e6,
+                        bestMs > 0.0 ? serializedMs / bestMs : 0.0);
+                }
+
+                // Spot check the last pipelined run.
+                if (novalidate) {
+                    printf("\tvalidation:     skipped\n");
+                } else {
+                    size_t mismatches = 0;
+                    size_t checked = 0;
+                    for (size_t e = 0; e < totalElements; e += 4093, checked++) {
+                        float x = hostSrc[e];
+                        for (uint32_t n = 0; n < intensity; n++) {
+                            x = fmaf(x, 0.999f, 0.001f);
+                        }
+                        if (hostDst[e] != x) {
+                            mismatches++;
+                        }
+                    }
+                    printf("\tvalidation:     %s (%zu of %zu checked elements mismatched)\n",
+                        mismatches ? "FAILED" : "passed", mismatches, checked);
+                    if (mismatches) {
+                        failed = true;
+                    }
+                }
+            }
+
+            for (auto slot : p.slots) {
+                if (slot) CHECK_CALL( zeMemFree(context, slot) );
+            }
+            if (dst) CHECK_CALL( zeMemFree(context, dst) );
+            if (src) CHECK_CALL( zeMemFree(context, src) );
+            CHECK_CALL( zeKernelDestroy(p.kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            CHECK_CALL( zeCommandListDestroy(p.download) );
+            CHECK_CALL( zeCommandListDestroy(p.compute) );
+            CHECK_CALL( zeCommandListDestroy(p.upload) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return failed ? 1 : 0;
+}
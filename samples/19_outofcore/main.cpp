@@ -0,0 +1,304 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "zes_api.h"
+#include "lzutil/mapped_file.hpp"
+#include "lzutil/process_kernel_spirv.hpp"
+#include "lzutil/tiled_executor.hpp"
+
+#if defined(_WIN32)
+#define SETENV( _name, _value ) _putenv_s( _name, _value )
+#else
+#define SETENV( _name, _value ) setenv( _name, _value, 1 );
+#endif
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+static void FillData(
+    float* data,
+    size_t count )
+{
+    for (size_t e = 0; e < count; e++) {
+        data[e] = (e % 1000) / 1000.0f;
+    }
+}
+
+// Spot checks the result of one pass of the kernel over data from FillData.
+static size_t Validate(
+    const float* data,
+    size_t count,
+    uint32_t intensity,
+    size_t& checked )
+{
+    size_t mismatches = 0;
+    checked = 0;
+    for (size_t e = 0; e < count; e += 4093, checked++) {
+        float x = (e % 1000) / 1000.0f;
+        for (uint32_t n = 0; n < intensity; n++) {
+            x = fmaf(x, 0.999f, 0.001f);
+        }
+        if (data[e] != x) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    std::string fileName("outofcore.bin");
+    size_t dataSize = 1024 * 1024 * 1024;
+    double residency = 0.5;
+    uint32_t depth = 3;
+    size_t minTile = 1024 * 1024;
+    size_t maxTile = 256 * 1024 * 1024;
+    uint32_t intensity = 16;
+    bool keep = false;
+    bool novalidate = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<std::string>>("f", "file", "Scratch File (created, and removed unless --keep)", fileName, &fileName);
+        op.add<popl::Value<size_t>>("s", "size", "Dataset Size (bytes)", dataSize, &dataSize);
+        op.add<popl::Value<double>>("r", "residency", "Fraction of Free Device Memory to Use", residency, &residency);
+        op.add<popl::Value<uint32_t>>("d", "depth", "Resident Tiles", depth, &depth);
+        op.add<popl::Value<size_t>>("", "mintile", "Minimum Tile Size (bytes)", minTile, &minTile);
+        op.add<popl::Value<size_t>>("", "maxtile", "Maximum Tile Size (bytes)", maxTile, &maxTile);
+        op.add<popl::Value<uint32_t>>("", "intensity", "FMAs per Element", intensity, &intensity);
+        op.add<popl::Switch>("k", "keep", "Keep the Scratch File", &keep);
+        op.add<popl::Switch>("", "novalidate", "Skip Validation of the Results", &novalidate);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            residency <= 0.0 || residency > 1.0 || depth == 0 || maxTile < minTile) {
+            fprintf(stderr,
+                "Usage: outofcore [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    lzutil::TiledExecutor::Options options;
+    options.residencyFraction = residency;
+    options.depth = depth;
+    options.minTileBytes = minTile;
+    options.maxTileBytes = maxTile;
+
+    // Whole tiles are always a multiple of the work-group size, and the
+    // dataset is a multiple of the tile alignment, so the last tile is too.
+    dataSize = std::max(dataSize / options.tileAlignment, (size_t)1) * options.tileAlignment;
+
+    lzutil::MappedFile file;
+    if (!file.create(fileName, dataSize)) {
+        fprintf(stderr, "Error: could not create and map %s.\n", fileName.c_str());
+        return -1;
+    }
+    printf("Mapped %zu bytes of %s.\n\n", file.size(), fileName.c_str());
+
+    float* data = static_cast<float*>(file.data());
+    const size_t count = file.size() / sizeof(float);
+
+    SETENV("ZES_ENABLE_SYSMAN", "1");
+
+    ze_result_t result;
+    bool failed = false;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::processKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::processKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::processKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+
+            uint32_t groupSizeX = 1;
+            uint32_t groupSizeY = 1;
+            uint32_t groupSizeZ = 1;
+            CHECK_CALL( zeKernelSuggestGroupSize(kernel, (uint32_t)(options.tileAlignment / sizeof(float)), 1, 1,
+                &groupSizeX, &groupSizeY, &groupSizeZ) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, groupSizeX, 1, 1) );
+
+            lzutil::TiledExecutor executor(context, device, options);
+
+            uint64_t freeBytes = 0;
+            uint64_t totalBytes = 0;
+            executor.queryMemory(freeBytes, totalBytes);
+
+            printf("\tdevice memory:  %.1f MB free of %.1f MB (%s)\n",
+                freeBytes / (1024.0 * 1024.0), totalBytes / (1024.0 * 1024.0),
+                executor.hasSysman() ? "sysman" : "estimated, sysman unavailable");
+            printf("\tinitial tile:   %.1f MB x %u resident\n",
+                executor.chooseTileBytes() / (1024.0 * 1024.0), depth);
+
+            printf("\t%-10s %12s %12s %8s %10s %14s\n",
+                "pass", "time (ms)", "GB/s", "tiles", "resizes", "peak res (MB)");
+
+            FillData(data, count);
+
+            // The copy pass streams the data without processing it, which
+            // bounds the throughput of the compute pass, and leaves the data
+            // unchanged.
+            for (int pass = 0; pass < 2; pass++) {
+                const bool compute = pass == 1;
+
+                auto fn = [&](
+                    ze_command_list_handle_t cmdList,
+                    void* tile,
+                    size_t /*offset*/,
+                    size_t bytes )
+                {
+                    if (!compute) {
+                        return;
+                    }
+                    ze_group_count_t groupCount = { (uint32_t)(bytes / sizeof(float) / groupSizeX), 1, 1 };
+                    CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(tile), &tile) );
+                    CHECK_CALL( zeKernelSetArgumentValue(kernel, 1, sizeof(intensity), &intensity) );
+                    CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, nullptr, 0, nullptr) );
+                };
+
+                const uint64_t tilesBefore = executor.tiles();
+                const uint32_t resizesBefore = executor.resizes();
+
+                auto start = clk::now();
+                CHECK_CALL( executor.run(data, data, file.size(), fn) );
+                auto end = clk::now();
+
+                const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                printf("\t%-10s %12.2f %12.2f %8" PRIu64 " %10u %14.1f\n",
+                    compute ? "compute" : "copy",
+                    ms,
+                    file.size() / ms / 1e6,
+                    executor.tiles() - tilesBefore,
+                    executor.resizes() - resizesBefore,
+                    executor.peakResidentBytes() / (1024.0 * 1024.0));
+            }
+
+            if (novalidate) {
+                printf("\tvalidation:     skipped\n");
+            } else {
+                size_t checked = 0;
+                const size_t mismatches = Validate(data, count, intensity, checked);
+                printf("\tvalidation:     %s (%zu of %zu checked elements mismatched)\n",
+                    mismatches ? "FAILED" : "passed", mismatches, checked);
+                if (mismatches) {
+                    failed = true;
+                }
+            }
+
+            executor.release();
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    file.flush();
+    file.close();
+    if (!keep) {
+        remove(fileName.c_str());
+    }
+
+    printf( "Done.\n" );
+
+    return failed ? 1 : 0;
+}
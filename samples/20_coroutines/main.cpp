@@ -0,0 +1,344 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+#include "lzutil/reactor.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// The buffers for one request stream.  Each iteration uploads a pattern,
+// runs a kernel, and downloads the pattern again.
+struct Stream {
+    uint32_t*   src;
+    uint32_t*   dev;
+    uint32_t*   dst;
+};
+
+struct Config {
+    ze_command_list_handle_t    cmdList;
+    ze_kernel_handle_t          kernel;
+    size_t                      count;  // uint32_t elements per copy
+    int                         iterations;
+};
+
+static void FillPattern(
+    Stream& s,
+    size_t count,
+    uint32_t seed )
+{
+    for (size_t e = 0; e < count; e++) {
+        s.src[e] = seed + (uint32_t)e;
+    }
+}
+
+static size_t CheckPattern(
+    const Stream& s,
+    size_t count,
+    uint32_t seed )
+{
+    size_t mismatches = 0;
+    for (size_t e = 0; e < count; e++) {
+        if (s.dst[e] != seed + (uint32_t)e) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Runs every stream to completion, one operation at a time, waiting on the
+// host for each operation.
+static size_t RunSynchronous(
+    const Config& c,
+    std::vector<Stream>& streams,
+    ze_event_handle_t event )
+{
+    const size_t bytes = c.count * sizeof(uint32_t);
+    ze_group_count_t groupCount = { 1, 1, 1 };
+
+    size_t mismatches = 0;
+    for (size_t id = 0; id < streams.size(); id++) {
+        Stream& s = streams[id];
+        for (int it = 0; it < c.iterations; it++) {
+            const uint32_t seed = (uint32_t)(id * c.iterations + it);
+            FillPattern(s, c.count, seed);
+
+            CHECK_CALL( zeCommandListAppendMemoryCopy(c.cmdList, s.dev, s.src, bytes, event, 0, nullptr) );
+            CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+            CHECK_CALL( zeEventHostReset(event) );
+
+            CHECK_CALL( zeCommandListAppendLaunchKernel(c.cmdList, c.kernel, &groupCount, event, 0, nullptr) );
+            CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+            CHECK_CALL( zeEventHostReset(event) );
+
+            CHECK_CALL( zeCommandListAppendMemoryCopy(c.cmdList, s.dst, s.dev, bytes, event, 0, nullptr) );
+            CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+            CHECK_CALL( zeEventHostReset(event) );
+
+            mismatches += CheckPattern(s, c.count, seed);
+        }
+    }
+    return mismatches;
+}
+
+// The same work as one stream of RunSynchronous, written as a coroutine.
+// Parameters are copied into the coroutine frame, so the referenced objects
+// must outlive the reactor's run().
+static lzutil::Task RunStream(
+    lzutil::Reactor& reactor,
+    const Config& c,
+    Stream& s,
+    uint32_t id,
+    size_t& mismatches )
+{
+    const size_t bytes = c.count * sizeof(uint32_t);
+    const ze_group_count_t groupCount = { 1, 1, 1 };
+
+    for (int it = 0; it < c.iterations; it++) {
+        const uint32_t seed = (uint32_t)(id * c.iterations + it);
+        FillPattern(s, c.count, seed);
+
+        ze_result_t result = co_await reactor.copy(c.cmdList, s.dev, s.src, bytes);
+        if (result == ZE_RESULT_SUCCESS) {
+            result = co_await reactor.launch(c.cmdList, c.kernel, groupCount);
+        }
+        if (result == ZE_RESULT_SUCCESS) {
+            result = co_await reactor.copy(c.cmdList, s.dst, s.dev, bytes);
+        }
+        if (result != ZE_RESULT_SUCCESS) {
+            printf("Stream %u: operation returned %u!\n", id, result);
+            mismatches += c.count;
+            co_return;
+        }
+
+        mismatches += CheckPattern(s, c.count, seed);
+    }
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int streamCount = 1024;
+    int iterations = 8;
+    size_t size = 4096;
+    uint64_t blockSliceNs = 0;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("n", "streams", "Concurrent Streams (coroutines)", streamCount, &streamCount);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Stream", iterations, &iterations);
+        op.add<popl::Value<size_t>>("s", "size", "Copy Size (bytes)", size, &size);
+        op.add<popl::Value<uint64_t>>("", "slice", "Reactor Block Slice (ns, 0 to spin)", blockSliceNs, &blockSliceNs);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            streamCount <= 0 || iterations <= 0 || size < sizeof(uint32_t)) {
+            fprintf(stderr,
+                "Usage: coroutines [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    const size_t count = size / sizeof(uint32_t);
+    const size_t bytes = count * sizeof(uint32_t);
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            Config c = {};
+            c.count = count;
+            c.iterations = iterations;
+            CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &c.cmdList) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &c.kernel) );
+            CHECK_CALL( zeKernelSetGroupSize(c.kernel, 1, 1, 1) );
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            void* hostMem = nullptr;
+            void* deviceMem = nullptr;
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, 2 * bytes * streamCount, 0, &hostMem) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, bytes * streamCount, 0, device, &deviceMem) );
+
+            std::vector<Stream> streams(streamCount);
+            for (int s = 0; s < streamCount; s++) {
+                streams[s].src = static_cast<uint32_t*>(hostMem) + (2 * s + 0) * count;
+                streams[s].dst = static_cast<uint32_t*>(hostMem) + (2 * s + 1) * count;
+                streams[s].dev = static_cast<uint32_t*>(deviceMem) + s * count;
+            }
+
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = 1;
+
+            ze_event_pool_handle_t eventPool = nullptr;
+            CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &eventPool) );
+
+            ze_event_desc_t eventDesc = {};
+            eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+            eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+            eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+            ze_event_handle_t event = nullptr;
+            CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &event) );
+
+            if (hostMem == nullptr || deviceMem == nullptr) {
+                printf("\tAllocation failed, skipping device.\n");
+            } else {
+                const double ops = 3.0 * streamCount * iterations;
+
+                printf("\t%-22s %10s %12s %14s %10s %8s\n",
+                    "mode", "ops", "time (ms)", "ops/s", "in flight", "result");
+
+                auto start = clk::now();
+                size_t mismatches = RunSynchronous(c, streams, event);
+                auto end = clk::now();
+
+                double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                printf("\t%-22s %10.0f %12.2f %14.0f %10d %8s\n",
+                    "synchronous, 1 thread", ops, ms, ops / ms * 1e3, 1,
+                    mismatches ? "FAILED" : "passed");
+
+                lzutil::Reactor::Options options;
+                options.blockSliceNs = blockSliceNs;
+
+                lzutil::Reactor reactor(context, device, options);
+
+                mismatches = 0;
+                start = clk::now();
+                for (int s = 0; s < streamCount; s++) {
+                    reactor.spawn(RunStream(reactor, c, streams[s], (uint32_t)s, mismatches));
+                }
+                reactor.run();
+                end = clk::now();
+
+                ms = std::chrono::duration<double, std::milli>(end - start).count();
+                printf("\t%-22s %10.0f %12.2f %14.0f %10zu %8s\n",
+                    "coroutines, 1 thread", ops, ms, ops / ms * 1e3, reactor.maxWaiting(),
+                    mismatches ? "FAILED" : "passed");
+                printf("\treactor events: %zu\n", reactor.events());
+            }
+
+            CHECK_CALL( zeEventDestroy(event) );
+            CHECK_CALL( zeEventPoolDestroy(eventPool) );
+            if (deviceMem) CHECK_CALL( zeMemFree(context, deviceMem) );
+            if (hostMem) CHECK_CALL( zeMemFree(context, hostMem) );
+            CHECK_CALL( zeKernelDestroy(c.kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            CHECK_CALL( zeCommandListDestroy(c.cmdList) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/empty_kernel_spirv.hpp"
+#include "lzutil/handles.hpp"
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// Returns the average time for one call to f, in nanoseconds, after one
+// untimed warm-up call.
+template <typename F>
+static double NsPerIteration(
+    int iterations,
+    F&& f )
+{
+    f();
+
+    auto start = clk::now();
+    for (int i = 0; i < iterations; i++) {
+        f();
+    }
+    auto end = clk::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void PrintRow(
+    const char* object,
+    double createNs,
+    double recycleNs )
+{
+    if (recycleNs > 0.0) {
+        printf("\t%-16s %14.0f %14.0f %9.1fx\n",
+            object, createNs, recycleNs, createNs / recycleNs);
+    } else {
+        printf("\t%-16s %14.0f %14s %10s\n",
+            object, createNs, "-", "-");
+    }
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 1000;
+    int moduleIterations = 10;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Iterations per Object Type", iterations, &iterations);
+        op.add<popl::Value<int>>("m", "module-iterations", "Iterations for Modules", moduleIterations, &moduleIterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0 || moduleIterations <= 0) {
+            fprintf(stderr,
+                "Usage: handlechurn [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        lzutil::Context context;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, context.put()) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            printf("\t%-16s %14s %14s %10s\n",
+                "object", "create (ns)", "recycle (ns)", "speedup");
+
+            double createNs = NsPerIteration(iterations, [&]() {
+                lzutil::Context c;
+                CHECK_CALL( zeContextCreate(driver, &contextDesc, c.put()) );
+            });
+            PrintRow("context", createNs, 0.0);
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            createNs = NsPerIteration(iterations, [&]() {
+                lzutil::CommandQueue q;
+                CHECK_CALL( zeCommandQueueCreate(context.get(), device, &queueDesc, q.put()) );
+            });
+            PrintRow("command queue", createNs, 0.0);
+
+            // Command lists record a barrier and are closed, so the recycled
+            // path includes resetting a used command list.
+            ze_command_list_desc_t cmdListDesc = {};
+            cmdListDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+
+            createNs = NsPerIteration(iterations, [&]() {
+                lzutil::CommandList l;
+                CHECK_CALL( zeCommandListCreate(context.get(), device, &cmdListDesc, l.put()) );
+                CHECK_CALL( zeCommandListAppendBarrier(l.get(), nullptr, 0, nullptr) );
+                CHECK_CALL( zeCommandListClose(l.get()) );
+            });
+            double recycleNs = 0.0;
+            {
+                lzutil::CommandListRecycler recycler(context.get(), device);
+                recycleNs = NsPerIteration(iterations, [&]() {
+                    auto l = recycler.acquire();
+                    CHECK_CALL( zeCommandListAppendBarrier(l.get(), nullptr, 0, nullptr) );
+                    CHECK_CALL( zeCommandListClose(l.get()) );
+                });
+            }
+            PrintRow("command list", createNs, recycleNs);
+
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = 1;
+
+            createNs = NsPerIteration(iterations, [&]() {
+                lzutil::EventPool p;
+                CHECK_CALL( zeEventPoolCreate(context.get(), &eventPoolDesc, 1, &device, p.put()) );
+            });
+            PrintRow("event pool", createNs, 0.0);
+
+            // Events are signaled, so the recycled path includes resetting a
+            // used event.
+            ze_event_desc_t eventDesc = {};
+            eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+            eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+            eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+            lzutil::EventPool eventPool;
+            CHECK_CALL( zeEventPoolCreate(context.get(), &eventPoolDesc, 1, &device, eventPool.put()) );
+
+            createNs = NsPerIteration(iterations, [&]() {
+                lzutil::Event e;
+                CHECK_CALL( zeEventCreate(eventPool.get(), &eventDesc, e.put()) );
+                CHECK_CALL( zeEventHostSignal(e.get()) );
+            });
+            {
+                lzutil::EventRecycler recycler(context.get(), device);
+                recycleNs = NsPerIteration(iterations, [&]() {
+                    auto e = recycler.acquire();
+                    CHECK_CALL( zeEventHostSignal(e.get()) );
+                });
+            }
+            PrintRow("event", createNs, recycleNs);
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            createNs = NsPerIteration(moduleIterations, [&]() {
+                lzutil::Module m;
+                CHECK_CALL( zeModuleCreate(context.get(), device, &moduleDesc, m.put(), nullptr) );
+            });
+            PrintRow("module", createNs, 0.0);
+
+            lzutil::Module module;
+            CHECK_CALL( zeModuleCreate(context.get(), device, &moduleDesc, module.put(), nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+            createNs = NsPerIteration(iterations, [&]() {
+                lzutil::Kernel k;
+                CHECK_CALL( zeKernelCreate(module.get(), &kernelDesc, k.put()) );
+            });
+            PrintRow("kernel", createNs, 0.0);
+        }
+
+        printf("\n");
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}
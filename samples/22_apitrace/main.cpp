@@ -0,0 +1,264 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/api_tracer.hpp"
+#include "lzutil/empty_kernel_spirv.hpp"
+
+#if defined(_WIN32)
+#define SETENV( _name, _value ) _putenv_s( _name, _value )
+#else
+#define SETENV( _name, _value ) setenv( _name, _value, 1 )
+#endif
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+// Launches an empty kernel and waits for it iterations times, using objects
+// owned by the calling thread.
+static void RunWorkload(
+    ze_context_handle_t context,
+    ze_device_handle_t device,
+    ze_module_handle_t module,
+    int iterations )
+{
+    ze_kernel_desc_t kernelDesc = {};
+    kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+    kernelDesc.pKernelName = lzutil::emptyKernelName;
+
+    ze_kernel_handle_t kernel = nullptr;
+    CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+    CHECK_CALL( zeKernelSetGroupSize(kernel, 1, 1, 1) );
+
+    ze_command_queue_desc_t queueDesc = {};
+    queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+    queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+    ze_command_list_handle_t cmdList = nullptr;
+    CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &cmdList) );
+
+    ze_event_pool_desc_t eventPoolDesc = {};
+    eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+    eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+    eventPoolDesc.count = 1;
+
+    ze_event_pool_handle_t eventPool = nullptr;
+    CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &device, &eventPool) );
+
+    ze_event_desc_t eventDesc = {};
+    eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+    eventDesc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+    eventDesc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+
+    ze_event_handle_t event = nullptr;
+    CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &event) );
+
+    ze_group_count_t groupCount = { 1, 1, 1 };
+    for (int i = 0; i < iterations; i++) {
+        CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, event, 0, nullptr) );
+        CHECK_CALL( zeEventHostSynchronize(event, UINT64_MAX) );
+        CHECK_CALL( zeEventHostReset(event) );
+    }
+
+    CHECK_CALL( zeEventDestroy(event) );
+    CHECK_CALL( zeEventPoolDestroy(eventPool) );
+    CHECK_CALL( zeCommandListDestroy(cmdList) );
+    CHECK_CALL( zeKernelDestroy(kernel) );
+}
+
+// Returns the average time for one zeEventQueryStatus call, in nanoseconds.
+static double QueryStatusNs(
+    ze_event_handle_t event,
+    int iterations )
+{
+    auto start = clk::now();
+    for (int i = 0; i < iterations; i++) {
+        zeEventQueryStatus(event);
+    }
+    auto end = clk::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    int iterations = 1000;
+    int threadCount = 2;
+    int overheadIterations = 100000;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("i", "iterations", "Kernel Launches per Thread", iterations, &iterations);
+        op.add<popl::Value<int>>("t", "threads", "Threads per Device", threadCount, &threadCount);
+        op.add<popl::Value<int>>("o", "overhead-iterations", "Calls Used to Measure Tracer Callback Overhead", overheadIterations, &overheadIterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0 || threadCount <= 0 || overheadIterations <= 0) {
+            fprintf(stderr,
+                "Usage: apitrace [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    // The loader only installs its tracing layer if it is requested before
+    // zeInit.
+    SETENV("ZE_ENABLE_TRACING_LAYER", "1");
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    lzutil::ApiTracer tracer(nullptr);
+    if (tracer.result() != ZE_RESULT_SUCCESS) {
+        printf("Creating the API tracer failed (%u), calls will not be traced.\n\n", tracer.result());
+    }
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::emptyKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::emptyKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; t++) {
+                threads.emplace_back(RunWorkload, context, device, module, iterations);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            printf("\tlaunched:       %d kernels on each of %d threads\n", iterations, threadCount);
+
+            CHECK_CALL( zeModuleDestroy(module) );
+        }
+
+        // Tracer callback overhead is the difference between a cheap call
+        // with the tracer enabled and disabled.  The loader's tracing layer
+        // stays loaded in both runs, so its own dispatch cost is not
+        // included; measuring that needs a separate run without
+        // ZE_ENABLE_TRACING_LAYER.
+        if (!devices.empty() && tracer.result() == ZE_RESULT_SUCCESS) {
+            ze_event_pool_desc_t eventPoolDesc = {};
+            eventPoolDesc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+            eventPoolDesc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+            eventPoolDesc.count = 1;
+
+            ze_event_pool_handle_t eventPool = nullptr;
+            CHECK_CALL( zeEventPoolCreate(context, &eventPoolDesc, 1, &devices[0], &eventPool) );
+
+            ze_event_desc_t eventDesc = {};
+            eventDesc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+
+            ze_event_handle_t event = nullptr;
+            CHECK_CALL( zeEventCreate(eventPool, &eventDesc, &event) );
+
+            CHECK_CALL( tracer.setEnabled(false) );
+            const double disabledNs = QueryStatusNs(event, overheadIterations);
+            CHECK_CALL( tracer.setEnabled(true) );
+            const double enabledNs = QueryStatusNs(event, overheadIterations);
+
+            printf("\tzeEventQueryStatus: %.1f ns tracer disabled, %.1f ns tracer enabled, %.1f ns tracer callback overhead\n",
+                disabledNs, enabledNs, enabledNs - disabledNs);
+
+            CHECK_CALL( zeEventDestroy(event) );
+            CHECK_CALL( zeEventPoolDestroy(eventPool) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    tracer.report(stdout);
+    printf("\n");
+
+    printf( "Done.\n" );
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+/*
+// Copyright (c) 2022 Ben Ashbaugh
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <popl/popl.hpp>
+
+#include "ze_api.h"
+#include "lzutil/api_tracer.hpp"
+#include "lzutil/chrome_trace.hpp"
+#include "lzutil/process_kernel_spirv.hpp"
+#include "lzutil/timestamp_profiler.hpp"
+
+#if defined(_WIN32)
+#define SETENV( _name, _value ) _putenv_s( _name, _value )
+#else
+#define SETENV( _name, _value ) setenv( _name, _value, 1 )
+#endif
+
+#define CHECK_CALL( _call )                                                 \
+    do {                                                                    \
+        ze_result_t result = _call;                                         \
+        if (result != ZE_RESULT_SUCCESS) {                                  \
+            printf("%s returned %u!\n", #_call, result);                    \
+        }                                                                   \
+    } while (0)
+
+using clk = std::chrono::high_resolution_clock;
+
+int main(
+    int argc,
+    char** argv )
+{
+    std::string fileName("timeline.json");
+    int iterations = 100;
+    size_t size = 16 * 1024 * 1024;
+    uint32_t intensity = 64;
+    int syncInterval = 10;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<std::string>>("o", "output", "Chrome Trace Output File", fileName, &fileName);
+        op.add<popl::Value<int>>("i", "iterations", "Iterations", iterations, &iterations);
+        op.add<popl::Value<size_t>>("s", "size", "Buffer Size (bytes)", size, &size);
+        op.add<popl::Value<uint32_t>>("", "intensity", "FMAs per Element", intensity, &intensity);
+        op.add<popl::Value<int>>("", "sync", "Iterations Between Clock Syncs", syncInterval, &syncInterval);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty() ||
+            iterations <= 0 || size < sizeof(float) || syncInterval <= 0) {
+            fprintf(stderr,
+                "Usage: timeline [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    lzutil::ChromeTrace trace;
+    trace.setThreadName(lzutil::ChromeTrace::hostPid, lzutil::ChromeTrace::hostThreadId(), "main");
+
+    // Every Level Zero call is recorded on the host lanes through the
+    // loader's tracing layer, which must be requested before zeInit.
+    SETENV("ZE_ENABLE_TRACING_LAYER", "1");
+
+    ze_result_t result;
+
+    result = zeInit(0);
+    if (result != ZE_RESULT_SUCCESS) {
+        printf("zeInit failed (%u)!\n", result);
+    }
+
+    lzutil::ApiTracer tracer(nullptr);
+    if (tracer.result() != ZE_RESULT_SUCCESS) {
+        printf("Creating the API tracer failed (%u), API calls will not be traced.\n\n", tracer.result());
+    }
+    tracer.setSpanCallback(
+        [&](uint32_t api,
+            std::chrono::steady_clock::time_point start,
+            std::chrono::steady_clock::time_point end) {
+            trace.addHostSpan(lzutil::ApiTracer::name(api), "api", start, end);
+        });
+
+    uint32_t driverCount = 0;
+    result = zeDriverGet(&driverCount, nullptr);
+    printf("Enumerated %u drivers.\n\n", driverCount);
+
+    std::vector<ze_driver_handle_t> drivers(driverCount);
+    result = zeDriverGet(&driverCount, drivers.data());
+
+    uint32_t devicePid = lzutil::ChromeTrace::hostPid;
+
+    for (auto& driver : drivers) {
+        printf("Driver:\n");
+
+        ze_driver_properties_t driverProps = {};
+        driverProps.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+        zeDriverGetProperties(driver, &driverProps);
+
+        printf("\tDriver Version: %u\n", driverProps.driverVersion );
+
+        uint32_t deviceCount = 0;
+        zeDeviceGet(driver, &deviceCount, nullptr);
+
+        std::vector<ze_device_handle_t> devices(deviceCount);
+        zeDeviceGet(driver, &deviceCount, devices.data());
+
+        ze_context_desc_t contextDesc = {};
+        contextDesc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+
+        ze_context_handle_t context = nullptr;
+        CHECK_CALL( zeContextCreate(driver, &contextDesc, &context) );
+
+        for (uint32_t i = 0; i < deviceCount; i++) {
+            printf("Device[%u]:\n", i);
+
+            ze_device_handle_t device = devices[i];
+
+            ze_device_properties_t deviceProps = {};
+            deviceProps.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+            zeDeviceGetProperties(device, &deviceProps);
+
+            printf("\tname:           %s\n", deviceProps.name);
+
+            // Each device gets its own process in the trace, with one lane
+            // for copies and one for kernels.
+            devicePid++;
+            trace.setProcessName(devicePid, "Device " + std::to_string(devicePid - 1) + ": " + deviceProps.name);
+            trace.setThreadName(devicePid, 0, "copy");
+            trace.setThreadName(devicePid, 1, "compute");
+
+            ze_command_queue_desc_t queueDesc = {};
+            queueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+            queueDesc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+            ze_command_list_handle_t cmdList = nullptr;
+            CHECK_CALL( zeCommandListCreateImmediate(context, device, &queueDesc, &cmdList) );
+
+            ze_module_desc_t moduleDesc = {};
+            moduleDesc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+            moduleDesc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+            moduleDesc.inputSize = sizeof(lzutil::processKernelSPIRV);
+            moduleDesc.pInputModule = reinterpret_cast<const uint8_t*>(lzutil::processKernelSPIRV);
+
+            ze_module_handle_t module = nullptr;
+            CHECK_CALL( zeModuleCreate(context, device, &moduleDesc, &module, nullptr) );
+
+            ze_kernel_desc_t kernelDesc = {};
+            kernelDesc.stype = ZE_STRUCTURE_TYPE_KERNEL_DESC;
+            kernelDesc.pKernelName = lzutil::processKernelName;
+
+            ze_kernel_handle_t kernel = nullptr;
+            CHECK_CALL( zeKernelCreate(module, &kernelDesc, &kernel) );
+
+            const size_t count = size / sizeof(float);
+
+            uint32_t groupSizeX = 1;
+            uint32_t groupSizeY = 1;
+            uint32_t groupSizeZ = 1;
+            CHECK_CALL( zeKernelSuggestGroupSize(kernel, (uint32_t)count, 1, 1,
+                &groupSizeX, &groupSizeY, &groupSizeZ) );
+            CHECK_CALL( zeKernelSetGroupSize(kernel, groupSizeX, 1, 1) );
+            ze_group_count_t groupCount = { (uint32_t)(count / groupSizeX), 1, 1 };
+
+            ze_host_mem_alloc_desc_t hostDesc = {};
+            hostDesc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+            ze_device_mem_alloc_desc_t deviceDesc = {};
+            deviceDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+            void* hostBuf = nullptr;
+            void* deviceBuf = nullptr;
+            CHECK_CALL( zeMemAllocHost(context, &hostDesc, size, 0, &hostBuf) );
+            CHECK_CALL( zeMemAllocDevice(context, &deviceDesc, size, 0, device, &deviceBuf) );
+
+            if (hostBuf == nullptr || deviceBuf == nullptr) {
+                printf("\tAllocation failed, skipping device.\n");
+            } else {
+                lzutil::DeviceClock clock(device);
+                lzutil::TimestampProfiler copyProfiler(context, device);
+                lzutil::TimestampProfiler computeProfiler(context, device);
+
+                // Timestamps are converted right after each clock sync, well
+                // within one wrap of the kernel timestamp counter.
+                auto flush = [&]() {
+                    CHECK_CALL( clock.sync() );
+                    copyProfiler.collect();
+                    computeProfiler.collect();
+                    trace.addDeviceRecords(clock, devicePid, 0, copyProfiler.records());
+                    trace.addDeviceRecords(clock, devicePid, 1, computeProfiler.records());
+                    copyProfiler.clear();
+                    computeProfiler.clear();
+                };
+
+                // Each iteration prepares data on the host, then uploads,
+                // processes and downloads it, and waits.  The host work and
+                // the waits show up as gaps on the device lanes.  The phase
+                // scopes enclose the spans of the API calls they make.
+                auto start = clk::now();
+                for (int it = 0; it < iterations; it++) {
+                    {
+                        lzutil::ChromeTrace::Scope scope(trace, "prepare");
+                        float* data = static_cast<float*>(hostBuf);
+                        for (size_t e = 0; e < count; e++) {
+                            data[e] = (float)((e + it) % 1000) / 1000.0f;
+                        }
+                    }
+
+                    ze_event_handle_t downloaded = nullptr;
+                    {
+                        lzutil::ChromeTrace::Scope scope(trace, "submit");
+                        ze_event_handle_t uploaded = copyProfiler.signal("upload");
+                        ze_event_handle_t computed = computeProfiler.signal("process");
+                        downloaded = copyProfiler.signal("download");
+
+                        CHECK_CALL( zeKernelSetArgumentValue(kernel, 0, sizeof(deviceBuf), &deviceBuf) );
+                        CHECK_CALL( zeKernelSetArgumentValue(kernel, 1, sizeof(intensity), &intensity) );
+
+                        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, deviceBuf, hostBuf, size, uploaded, 0, nullptr) );
+                        CHECK_CALL( zeCommandListAppendLaunchKernel(cmdList, kernel, &groupCount, computed, 1, &uploaded) );
+                        CHECK_CALL( zeCommandListAppendMemoryCopy(cmdList, hostBuf, deviceBuf, size, downloaded, 1, &computed) );
+                    }
+
+                    {
+                        lzutil::ChromeTrace::Scope scope(trace, "wait");
+                        CHECK_CALL( zeEventHostSynchronize(downloaded, UINT64_MAX) );
+                    }
+
+                    if ((it + 1) % syncInterval == 0) {
+                        lzutil::ChromeTrace::Scope scope(trace, "collect");
+                        flush();
+                    }
+                }
+                flush();
+                auto end = clk::now();
+
+                printf("\titerations:     %d in %.2f ms\n", iterations,
+                    std::chrono::duration<double, std::milli>(end - start).count());
+                printf("\tclock syncs:    %zu, device timer drift %.2f ppm\n",
+                    clock.syncPoints(), clock.driftPpm());
+            }
+
+            if (deviceBuf) CHECK_CALL( zeMemFree(context, deviceBuf) );
+            if (hostBuf) CHECK_CALL( zeMemFree(context, hostBuf) );
+            CHECK_CALL( zeKernelDestroy(kernel) );
+            CHECK_CALL( zeModuleDestroy(module) );
+            CHECK_CALL( zeCommandListDestroy(cmdList) );
+        }
+
+        CHECK_CALL( zeContextDestroy(context) );
+        printf("\n");
+    }
+
+    if (trace.write(fileName)) {
+        printf("Wrote %zu spans to %s.\n\n", trace.size(), fileName.c_str());
+    } else {
+        printf("Could not write %s!\n\n", fileName.c_str());
+    }
+
+    printf( "Done.\n" );
+
+    return 0;
+}